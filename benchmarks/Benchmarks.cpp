@@ -0,0 +1,639 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "GainMix.h"
+#include "InferenceEngine.h"
+#include "NativeModel.h"
+#include "ModelVariants.h"
+
+#include <iostream>
+
+// Performance harness for the audio path. Measures:
+//   - processBlock     per-call cost across block sizes and channel counts,
+//                      for ONNX Runtime (and any fp16/int8 variants of the
+//                      model) and the native in-place backend
+//   - submitInput      audio-thread cost of handing a block to the engine
+//   - roundTrip        wall time from submitInput() until that hop's result
+//                      is readable, i.e. the inference thread's turnaround
+//   - loadModel        per-instance load time as more instances open the same
+//                      model (the first pays for the session, the rest share it)
+//   - gainMix          processBlock's gain staging alone at small blocks:
+//                      "threePass" is the old applyGain / scalar copy from
+//                      the result ring / applyGain, "fused" the smoothed
+//                      GainMix sweep (fully wet), "fusedMix" the same at a
+//                      50% mix with the latency-aligned dry signal
+//   - startup          constructing an engine and loading the model with no
+//                      other instance around, as when a project opens:
+//                      "startup" optimises the graph every time,
+//                      "startupCached" reads the optimised graph SessionCache
+//                      wrote on an earlier (untimed) load
+//   - spectral         the STFT pipeline on the bundled spectral model,
+//                      offline, per hop, with 1..16 hops stacked into each
+//                      Run (the row's block size): analysis, one Run and
+//                      resynthesis, showing what batching saves in ORT's
+//                      per-Run overhead
+//
+// Calls are paced faster than realtime but slower than flat out, so the
+// engine sees the same FIFO levels it would in a host. Every measurement is
+// kept, and the summary reports tail latency (p99, max) alongside the mean.
+//
+//   MojoInsectsBenchmarks [--json results.json] [--csv results.csv]
+//                         [--label <commit>] [--model <file.onnx>] [--quick]
+//                         [--priority background|low|normal|high|highest|realtime]
+//                         [--affinity <hex cpu mask>] [--intra-op n] [--inter-op n]
+//                         [--no-spin] [--parallel]
+//
+// The scheduling options (see EngineThreading) apply to every engine the
+// harness creates and are recorded in the JSON, so settings can be compared
+// per machine.
+
+namespace
+{
+    constexpr double kSampleRate     = 48000.0;
+    constexpr double kPacingSpeedup  = 4.0;   // run the "host" 4x faster than realtime
+    constexpr int    kBlockSizes[]   = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    constexpr int    kChannelCounts[] = { 1, 2 };
+
+    struct Result
+    {
+        juce::String benchmark;
+        juce::String mode;        // "passthrough", the model's name, "<model>-native" or "<model>-int8"
+        int          blockSize   = 0;
+        int          numChannels = 0;
+        int          iterations  = 0;
+        double       meanUs = 0.0, p50Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+    };
+
+    double ticksToMicros (juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6;
+    }
+
+    /** Fills in the summary statistics from raw per-iteration timings. */
+    Result summarise (Result result, std::vector<double>& micros)
+    {
+        jassert (! micros.empty());
+        std::sort (micros.begin(), micros.end());
+
+        const auto percentile = [&micros] (double p)
+        {
+            return micros[(size_t) juce::jlimit (0.0, (double) micros.size() - 1.0,
+                                                 std::ceil (p * (double) micros.size()) - 1.0)];
+        };
+
+        double total = 0.0;
+        for (auto us : micros)
+            total += us;
+
+        result.iterations = (int) micros.size();
+        result.meanUs     = total / (double) micros.size();
+        result.p50Us      = percentile (0.50);
+        result.p99Us      = percentile (0.99);
+        result.maxUs      = micros.back();
+        return result;
+    }
+
+    /** Spins until the high-resolution clock reaches `deadline`. */
+    void waitUntil (juce::int64 deadline)
+    {
+        while (juce::Time::getHighResolutionTicks() < deadline)
+            juce::Thread::yield();
+    }
+
+    juce::int64 pacingTicks (int blockSize)
+    {
+        const double seconds = (double) blockSize / kSampleRate / kPacingSpeedup;
+        return juce::Time::secondsToHighResolutionTicks (seconds);
+    }
+
+    /** Enough blocks to cover `audioSeconds` of audio, within sane bounds. */
+    int iterationsFor (int blockSize, double audioSeconds)
+    {
+        return juce::jlimit (64, 4000, (int) (audioSeconds * kSampleRate / blockSize));
+    }
+
+    void fillWithNoise (juce::AudioBuffer<float>& buffer, juce::Random& random)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    //==============================================================================
+    /** Scheduling every engine and processor below is run with. */
+    EngineThreading threading;
+
+    EngineThreading parseThreading (const juce::ArgumentList& args)
+    {
+        EngineThreading t;
+
+        if (args.containsOption ("--priority"))
+            t.priority = EngineThreading::getPriority (args.getValueForOption ("--priority"), t.priority);
+        if (args.containsOption ("--affinity"))
+            t.affinityMask = (uint32_t) args.getValueForOption ("--affinity").getHexValue32();
+        if (args.containsOption ("--intra-op"))
+            t.intraOpThreads = juce::jmax (0, args.getValueForOption ("--intra-op").getIntValue());
+        if (args.containsOption ("--inter-op"))
+            t.interOpThreads = juce::jmax (0, args.getValueForOption ("--inter-op").getIntValue());
+
+        t.allowSpinning     = ! args.containsOption ("--no-spin");
+        t.parallelExecution = args.containsOption ("--parallel");
+        return t;
+    }
+
+    //==============================================================================
+    /** What the engine runs: nothing, or a model on a given backend. */
+    struct Mode
+    {
+        juce::String             name;
+        juce::File               model;
+        InferenceEngine::Backend backend = InferenceEngine::Backend::onnxRuntime;
+    };
+
+    Result benchProcessBlock (const Mode& mode, int numChannels, int blockSize, double audioSeconds)
+    {
+        MojoInsectsAudioProcessor processor;
+        processor.setThreading (threading);
+        processor.setInferenceBackend (mode.backend);
+        if (mode.model != juce::File())
+            processor.loadModel (mode.model);
+
+        processor.setPlayConfigDetails (numChannels, numChannels, kSampleRate, blockSize);
+        processor.prepareToPlay (kSampleRate, blockSize);
+
+        juce::AudioBuffer<float> source (numChannels, blockSize), buffer (numChannels, blockSize);
+        juce::Random random (42);
+        fillWithNoise (source, random);
+        juce::MidiBuffer midi;
+
+        const int iterations = iterationsFor (blockSize, audioSeconds);
+        const auto pace = pacingTicks (blockSize);
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+
+        auto next = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            buffer.makeCopyOf (source, true);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+
+            waitUntil (next += pace);
+        }
+
+        processor.releaseResources();
+        return summarise ({ "processBlock", mode.name, blockSize, numChannels }, micros);
+    }
+
+    Result benchSubmitInput (int numChannels, int blockSize, double audioSeconds)
+    {
+        InferenceEngine engine;
+        engine.setThreading (threading);
+        engine.prepare (numChannels, blockSize);
+
+        SpscFifo outputFifo (engine.getRequiredOutputFifoSize());
+        juce::AudioBuffer<float> outputBuffer (numChannels, engine.getRequiredOutputFifoSize());
+        engine.setOutputFifo (&outputFifo, &outputBuffer);
+
+        juce::AudioBuffer<float> source (numChannels, blockSize);
+        juce::Random random (7);
+        fillWithNoise (source, random);
+
+        const int iterations = iterationsFor (blockSize, audioSeconds);
+        const auto pace = pacingTicks (blockSize);
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+
+        auto next = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine.submitInput (source.getArrayOfReadPointers(), numChannels, blockSize);
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+
+            // Stand in for processBlock's read so the output FIFO never fills.
+            outputFifo.finishedRead (outputFifo.getNumReady());
+
+            waitUntil (next += pace);
+        }
+
+        return summarise ({ "submitInput", "passthrough", blockSize, numChannels }, micros);
+    }
+
+    /** Submits exactly one hop and times how long the inference thread takes
+        to make it readable: wakeup + framing + Run + FIFO write. */
+    Result benchRoundTrip (const Mode& mode, int numChannels, int iterations)
+    {
+        InferenceEngine engine;
+        engine.setThreading (threading);
+        engine.setBackend (mode.backend);
+        if (mode.model != juce::File())
+            engine.loadModel (mode.model);
+
+        engine.prepare (numChannels, InferenceEngine::kDefaultWindowSize);
+        const int hop = engine.getHopSize();
+
+        SpscFifo outputFifo (engine.getRequiredOutputFifoSize());
+        juce::AudioBuffer<float> outputBuffer (numChannels, engine.getRequiredOutputFifoSize());
+        engine.setOutputFifo (&outputFifo, &outputBuffer);
+
+        juce::AudioBuffer<float> source (numChannels, hop);
+        juce::Random random (3);
+        fillWithNoise (source, random);
+
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            const auto timeout = start + juce::Time::secondsToHighResolutionTicks (1.0);
+
+            engine.submitInput (source.getArrayOfReadPointers(), numChannels, hop);
+
+            while (outputFifo.getNumReady() < hop && juce::Time::getHighResolutionTicks() < timeout)
+                juce::Thread::yield();
+
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+            outputFifo.finishedRead (outputFifo.getNumReady());
+
+            // Let the thread go back to sleep, as it would between host blocks.
+            juce::Thread::sleep (1);
+        }
+
+        return summarise ({ "roundTrip", mode.name, hop, numChannels }, micros);
+    }
+
+    /** Opens `numInstances` engines on the same model, one after another,
+        keeping them all alive, and times each load. */
+    Result benchLoadModel (const Mode& mode, int numInstances)
+    {
+        std::vector<std::unique_ptr<InferenceEngine>> engines;
+        std::vector<double> micros;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto engine = std::make_unique<InferenceEngine>();
+            engine->setThreading (threading);
+            engine->setBackend (mode.backend);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine->loadModel (mode.model);
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+
+            engines.push_back (std::move (engine));
+        }
+
+        return summarise ({ "loadModel", mode.name, 0, 1 }, micros);
+    }
+
+    /** Per-hop cost of the spectral pipeline when framesPerRun hops are
+        batched into each Run. */
+    Result benchSpectral (const juce::File& spectralModel, int framesPerRun, double audioSeconds)
+    {
+        InferenceEngine engine;
+        engine.setThreading (threading);
+        engine.setOfflineMode (true);
+        engine.loadModel (spectralModel);
+
+        // Prepared for blocks of exactly framesPerRun hops, which is then
+        // the batch every processPendingInput() runs.
+        engine.prepare (1, InferenceEngine::kDefaultWindowSize);
+        const int hop = engine.getHopSize();
+        const int blockSize = framesPerRun * hop;
+        engine.prepare (1, blockSize);
+
+        const int fifoSize = engine.getRequiredOutputFifoSize();
+        SpscFifo outputFifo (fifoSize);
+        juce::AudioBuffer<float> outputBuffer (1, fifoSize);
+        engine.setOutputFifo (&outputFifo, &outputBuffer);
+
+        juce::AudioBuffer<float> source (1, blockSize);
+        juce::Random random (11);
+        fillWithNoise (source, random);
+
+        const int iterations = iterationsFor (blockSize, audioSeconds);
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine.submitInput (source.getArrayOfReadPointers(), 1, blockSize);
+            engine.processPendingInput();
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start) / framesPerRun);
+
+            outputFifo.finishedRead (outputFifo.getNumReady());
+        }
+
+        return summarise ({ "spectral", spectralModel.getFileNameWithoutExtension(), framesPerRun, 1 }, micros);
+    }
+
+    /** Offline inference of 10 ms of stereo per iteration at sessionRate, so
+        rows at different rates compare the cost of the same stretch of
+        audio. A model that declares its rate (mojo.sample_rate) runs
+        resampled to it, and should cost about the same at every rate; one
+        that does not infers every session sample. */
+    Result benchSessionRate (const juce::File& modelFile, int sessionRate, double audioSeconds)
+    {
+        InferenceEngine engine;
+        engine.setThreading (threading);
+        engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+        engine.setOfflineMode (true);
+        engine.loadModel (modelFile);
+
+        const int blockSize = sessionRate / 100;
+        engine.prepare (2, blockSize, (double) sessionRate);
+
+        const int fifoSize = engine.getRequiredOutputFifoSize();
+        SpscFifo outputFifo (fifoSize);
+        juce::AudioBuffer<float> outputBuffer (2, fifoSize);
+        engine.setOutputFifo (&outputFifo, &outputBuffer);
+
+        juce::AudioBuffer<float> source (2, blockSize);
+        juce::Random random (11);
+        fillWithNoise (source, random);
+
+        const int iterations = iterationsFor ((int) kSampleRate / 100, audioSeconds);   // as many at every rate
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine.submitInput (source.getArrayOfReadPointers(), 2, blockSize);
+            engine.processPendingInput();
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+
+            outputFifo.finishedRead (outputFifo.getNumReady());
+        }
+
+        const auto mode = modelFile.getFileNameWithoutExtension() + (engine.isResampling() ? "-resampled" : "")
+                            + "@" + juce::String (sessionRate);
+        return summarise ({ "sessionRate", mode, blockSize, 2 }, micros);
+    }
+
+    Result benchGainMix (const juce::String& variant, int numChannels, int blockSize, double audioSeconds)
+    {
+        // A result ring like the processor's, read at an offset that wraps.
+        constexpr int kLatency = 512;
+        const int ringSize = kLatency + 2 * blockSize + 1;
+
+        juce::AudioBuffer<float> source (numChannels, blockSize), buffer (numChannels, blockSize),
+                                 ring (numChannels, ringSize);
+        juce::Random random (11);
+        fillWithNoise (source, random);
+        fillWithNoise (ring, random);
+
+        const float inputGain = 0.8f, outputGain = 1.2f;
+        GainMix gainMix;
+        gainMix.prepare (kSampleRate, numChannels, blockSize, kLatency, inputGain,
+                         variant == "fusedMix" ? 0.5f : 1.0f, outputGain);
+
+        const int iterations = iterationsFor (blockSize, audioSeconds) * 8;
+        std::vector<double> micros;
+        micros.reserve ((size_t) iterations);
+        int readPos = 0;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            buffer.makeCopyOf (source, true);
+
+            const int size1 = juce::jmin (blockSize, ringSize - readPos);
+            const int size2 = blockSize - size1;
+
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            if (variant == "threePass")
+            {
+                buffer.applyGain (inputGain);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* dst = buffer.getWritePointer (ch);
+                    const auto* src = ring.getReadPointer (ch);
+                    for (int s = 0; s < size1; ++s)
+                        dst[s] = src[readPos + s];
+                    for (int s = 0; s < size2; ++s)
+                        dst[size1 + s] = src[s];
+                }
+
+                buffer.applyGain (outputGain);
+            }
+            else
+            {
+                gainMix.setTargets (inputGain, variant == "fusedMix" ? 0.5f : 1.0f, outputGain);
+                gainMix.processInput (buffer.getArrayOfWritePointers(), numChannels, blockSize);
+                gainMix.processOutput (buffer.getArrayOfWritePointers(), numChannels, ring, readPos, size1, 0, size2);
+            }
+
+            micros.push_back (ticksToMicros (juce::Time::getHighResolutionTicks() - start));
+            readPos = (readPos + blockSize) % ringSize;
+        }
+
+        return summarise ({ "gainMix", variant, blockSize, numChannels }, micros);
+    }
+
+   #if MOJO_ONNX_ENABLED
+    Result benchStartup (const Mode& mode, bool useGraphCache, int repetitions)
+    {
+        const auto previousDirectory = SessionCache::getGraphCacheDirectory();
+        const auto cacheDirectory = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                        .getNonexistentChildFile ("MojoInsectsGraphCache", {});
+        SessionCache::setGraphCacheDirectory (useGraphCache ? cacheDirectory : juce::File());
+
+        // Each engine is the only one, so the SessionCache (and the session)
+        // goes away with it and the next load starts from nothing.
+        const auto startOnce = [&mode]
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            InferenceEngine engine;
+            engine.setThreading (threading);
+            engine.setBackend (mode.backend);
+            engine.loadModel (mode.model);
+
+            return ticksToMicros (juce::Time::getHighResolutionTicks() - start);
+        };
+
+        if (useGraphCache)
+            startOnce();   // writes the optimised graph
+
+        std::vector<double> micros;
+        for (int i = 0; i < repetitions; ++i)
+            micros.push_back (startOnce());
+
+        SessionCache::setGraphCacheDirectory (previousDirectory);
+        cacheDirectory.deleteRecursively();
+
+        return summarise ({ useGraphCache ? "startupCached" : "startup", mode.name, 0, 1 }, micros);
+    }
+   #endif
+
+    //==============================================================================
+    juce::String toJson (const std::vector<Result>& results, const juce::String& label)
+    {
+        juce::Array<juce::var> rows;
+
+        for (const auto& r : results)
+        {
+            auto* row = new juce::DynamicObject();
+            row->setProperty ("benchmark",   r.benchmark);
+            row->setProperty ("mode",        r.mode);
+            row->setProperty ("blockSize",   r.blockSize);
+            row->setProperty ("numChannels", r.numChannels);
+            row->setProperty ("iterations",  r.iterations);
+            row->setProperty ("meanUs",      r.meanUs);
+            row->setProperty ("p50Us",       r.p50Us);
+            row->setProperty ("p99Us",       r.p99Us);
+            row->setProperty ("maxUs",       r.maxUs);
+            rows.add (juce::var (row));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("label",     label);
+        root->setProperty ("timestamp", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("cpu",       juce::SystemStats::getCpuModel());
+
+        auto* scheduling = new juce::DynamicObject();
+        const auto threadingState = threading.toValueTree();
+        for (int i = 0; i < threadingState.getNumProperties(); ++i)
+            scheduling->setProperty (threadingState.getPropertyName (i),
+                                     threadingState.getProperty (threadingState.getPropertyName (i)));
+
+        root->setProperty ("threading", juce::var (scheduling));
+        root->setProperty ("results",   rows);
+        return juce::JSON::toString (juce::var (root));
+    }
+
+    juce::String toCsv (const std::vector<Result>& results, const juce::String& label)
+    {
+        juce::String csv ("label,benchmark,mode,blockSize,numChannels,iterations,meanUs,p50Us,p99Us,maxUs\n");
+
+        for (const auto& r : results)
+            csv << label << "," << r.benchmark << "," << r.mode << "," << r.blockSize << ","
+                << r.numChannels << "," << r.iterations << "," << juce::String (r.meanUs, 3) << ","
+                << juce::String (r.p50Us, 3) << "," << juce::String (r.p99Us, 3) << ","
+                << juce::String (r.maxUs, 3) << "\n";
+
+        return csv;
+    }
+
+    void print (const Result& r)
+    {
+        std::cout << r.benchmark.paddedRight (' ', 14) << r.mode.paddedRight (' ', 14)
+                  << juce::String (r.numChannels) << "ch  "
+                  << juce::String (r.blockSize).paddedLeft (' ', 5) << "  "
+                  << "mean " << juce::String (r.meanUs, 2).paddedLeft (' ', 9) << " us  "
+                  << "p50 "  << juce::String (r.p50Us, 2).paddedLeft (' ', 9)  << " us  "
+                  << "p99 "  << juce::String (r.p99Us, 2).paddedLeft (' ', 9)  << " us  "
+                  << "max "  << juce::String (r.maxUs, 2).paddedLeft (' ', 9)  << " us" << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS starts a timer, which needs a MessageManager to exist.
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const juce::ArgumentList args (argc, argv);
+
+    const bool quick = args.containsOption ("--quick");
+    const double audioSeconds = quick ? 0.25 : 2.0;
+    const int roundTrips = quick ? 100 : 1000;
+    const auto label = args.containsOption ("--label") ? args.getValueForOption ("--label")
+                                                       : juce::String ("unlabelled");
+
+    threading = parseThreading (args);
+    std::cout << "Inference thread " << EngineThreading::getName (threading.priority)
+              << ", affinity 0x" << juce::String::toHexString ((int) threading.affinityMask)
+              << ", ORT " << threading.getSessionKey() << std::endl;
+
+    // Modes to run the engine in: always passthrough, plus the bundled model
+    // (or --model) on ONNX Runtime when it is compiled in, and natively when
+    // the graph is one NativeModel can run.
+    std::vector<Mode> modes { { "passthrough", juce::File() } };
+
+    auto model = args.containsOption ("--model") ? args.getFileForOption ("--model")
+                                                 : juce::File (MOJO_BENCH_MODEL_PATH);
+    if (model.existsAsFile())
+    {
+       #if MOJO_ONNX_ENABLED
+        modes.push_back ({ model.getFileNameWithoutExtension(), model, InferenceEngine::Backend::onnxRuntime });
+
+        // Quantized variants next to it (see ModelVariants), as "<model>-int8" etc.
+        for (auto precision : { ModelVariants::Precision::fp16, ModelVariants::Precision::int8 })
+        {
+            const auto variant = ModelVariants::getFile (model, precision);
+            if (variant.existsAsFile())
+                modes.push_back ({ model.getFileNameWithoutExtension() + "-" + ModelVariants::getName (precision),
+                                   variant, InferenceEngine::Backend::onnxRuntime });
+        }
+       #endif
+
+        juce::String nativeError;
+        if (NativeModel::fromFile (model, nativeError) != nullptr)
+            modes.push_back ({ model.getFileNameWithoutExtension() + "-native", model, InferenceEngine::Backend::native });
+        else
+            std::cerr << "Not running " << model.getFileName() << " natively: " << nativeError << std::endl;
+    }
+    else
+    {
+        std::cerr << "Model " << model.getFullPathName() << " not found, passthrough only" << std::endl;
+    }
+
+    std::vector<Result> results;
+    const auto record = [&results] (Result r) { print (r); results.push_back (std::move (r)); };
+
+    for (const auto& mode : modes)
+        for (auto numChannels : kChannelCounts)
+            for (auto blockSize : kBlockSizes)
+                record (benchProcessBlock (mode, numChannels, blockSize, audioSeconds));
+
+    for (auto numChannels : kChannelCounts)
+        for (auto blockSize : kBlockSizes)
+            record (benchSubmitInput (numChannels, blockSize, audioSeconds));
+
+    for (auto variant : { "threePass", "fused", "fusedMix" })
+        for (auto blockSize : { 16, 32, 64, 128, 256 })
+            record (benchGainMix (variant, 2, blockSize, audioSeconds));
+
+    // Native models never go through the inference thread.
+    for (const auto& mode : modes)
+        if (mode.backend != InferenceEngine::Backend::native)
+            for (auto numChannels : kChannelCounts)
+                record (benchRoundTrip (mode, numChannels, roundTrips));
+
+    for (const auto& mode : modes)
+        if (mode.model != juce::File())
+            record (benchLoadModel (mode, quick ? 4 : 32));
+
+   #if MOJO_ONNX_ENABLED
+    for (const auto& mode : modes)
+        if (mode.backend == InferenceEngine::Backend::onnxRuntime)
+            for (auto useGraphCache : { false, true })
+                record (benchStartup (mode, useGraphCache, quick ? 4 : 16));
+
+    if (const juce::File spectralModel (MOJO_BENCH_SPECTRAL_MODEL_PATH); spectralModel.existsAsFile())
+        for (auto framesPerRun : { 1, 2, 4, 8, 16 })
+            record (benchSpectral (spectralModel, framesPerRun, audioSeconds));
+
+    // The bundled model at every rate, against one trained at 48 kHz.
+    for (const juce::File rateModel : { model, juce::File (MOJO_BENCH_RATE_MODEL_PATH) })
+        if (rateModel.existsAsFile())
+            for (auto sessionRate : { 48000, 96000, 192000 })
+                record (benchSessionRate (rateModel, sessionRate, audioSeconds));
+   #endif
+
+    if (args.containsOption ("--json"))
+        args.getFileForOption ("--json").replaceWithText (toJson (results, label));
+
+    if (args.containsOption ("--csv"))
+        args.getFileForOption ("--csv").replaceWithText (toCsv (results, label));
+
+    return 0;
+}
@@ -0,0 +1,589 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <iostream>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <sys/resource.h>
+#endif
+
+#if JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+ #include <tlhelp32.h>
+#endif
+
+// Soak harness: many plugin instances inside a simulated DAW session.
+//
+// A realtime "host" thread calls processBlock on every instance once per
+// audio callback, paced like a sound card: each callback's block size is
+// drawn at random between --block min and max, and the next one starts a
+// block period later. A callback whose processing overruns its period (times
+// --budget) is a deadline miss. Meanwhile the host now and then changes the
+// sample rate (stopping, re-preparing every instance and carrying on, as
+// DAWs do), the main thread hot-swaps the model on random instances, and
+// optional --load threads keep other cores busy.
+//
+// Every --report seconds, and after each segment, it prints:
+//   - misses       callbacks over budget, and the worst callback
+//   - dry          blocks the processors served dry because no wet samples
+//                  were ready, plus samples the engines dropped
+//   - RSS          the process's peak resident memory
+//   - threads      threads the process is running (inference threads, ORT
+//                  pools, loaders and the harness's own)
+//
+// With --ramp n, each segment of --seconds adds n more instances until a
+// segment misses more than --max-miss of its callbacks or serves any dry
+// block; the last clean instance count is where this machine tips over.
+//
+//   MojoInsectsSoak [--model <file.onnx>] [--instances N] [--seconds S]
+//                   [--ramp N] [--max-instances N] [--max-miss fraction]
+//                   [--block min:max] [--rates 44100,48000,96000]
+//                   [--rate-change seconds] [--reload seconds] [--load threads]
+//                   [--budget fraction] [--report seconds] [--json soak.json]
+
+namespace
+{
+    struct SoakSettings
+    {
+        juce::File          model;
+        int                 instances         = 8;
+        int                 rampStep          = 0;      // instances added per segment; 0 runs one segment
+        int                 maxInstances      = 256;
+        double              segmentSeconds    = 60.0;
+        double              maxMissRate       = 0.001;
+        int                 minBlock          = 32;
+        int                 maxBlock          = 512;
+        juce::Array<double> sampleRates       { 44100.0, 48000.0, 96000.0 };
+        double              rateChangeSeconds = 20.0;   // 0 keeps the first rate
+        double              reloadSeconds     = 5.0;    // 0 never reloads
+        int                 loadThreads       = 0;
+        double              budget            = 1.0;    // share of the block period processBlock may take
+        double              reportSeconds     = 10.0;
+    };
+
+    struct SegmentResult
+    {
+        int         instances       = 0;
+        double      seconds         = 0.0;
+        uint64_t    callbacks       = 0;
+        uint64_t    misses          = 0;
+        double      worstMicros     = 0.0;
+        uint64_t    blocks          = 0;
+        uint64_t    dryBlocks       = 0;
+        uint64_t    droppedSamples  = 0;
+        int         rateChanges     = 0;
+        int         reloads         = 0;
+        juce::int64 peakRssBytes    = 0;
+        int         threads         = 0;
+
+        double getMissRate() const noexcept { return callbacks > 0 ? (double) misses / (double) callbacks : 0.0; }
+
+        bool isClean (double maxMissRate) const noexcept { return getMissRate() <= maxMissRate && dryBlocks == 0; }
+    };
+
+    //==============================================================================
+    /** Peak resident set size of this process so far, in bytes; 0 where the
+        platform does not say. */
+    juce::int64 getPeakResidentBytes()
+    {
+       #if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+        rusage usage {};
+        if (getrusage (RUSAGE_SELF, &usage) != 0)
+            return 0;
+
+        #if JUCE_MAC
+         return (juce::int64) usage.ru_maxrss;           // bytes
+        #else
+         return (juce::int64) usage.ru_maxrss * 1024;    // kilobytes
+        #endif
+       #elif JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters {};
+        return GetProcessMemoryInfo (GetCurrentProcess(), &counters, sizeof (counters))
+                   ? (juce::int64) counters.PeakWorkingSetSize : 0;
+       #else
+        return 0;
+       #endif
+    }
+
+    /** Threads this process is running right now; 0 where the platform does
+        not say. */
+    int getNumProcessThreads()
+    {
+       #if JUCE_LINUX
+        const auto status = juce::File ("/proc/self/status").loadFileAsString();
+        return status.fromFirstOccurrenceOf ("Threads:", false, false).trim().getIntValue();
+       #elif JUCE_MAC
+        thread_act_array_t threads = nullptr;
+        mach_msg_type_number_t count = 0;
+
+        if (task_threads (mach_task_self(), &threads, &count) != KERN_SUCCESS)
+            return 0;
+
+        for (mach_msg_type_number_t i = 0; i < count; ++i)
+            mach_port_deallocate (mach_task_self(), threads[i]);
+
+        vm_deallocate (mach_task_self(), (vm_address_t) threads, count * sizeof (thread_act_t));
+        return (int) count;
+       #elif JUCE_WINDOWS
+        const auto snapshot = CreateToolhelp32Snapshot (TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE)
+            return 0;
+
+        PROCESSENTRY32 entry {};
+        entry.dwSize = sizeof (entry);
+        int count = 0;
+
+        for (auto found = Process32First (snapshot, &entry); found; found = Process32Next (snapshot, &entry))
+            if (entry.th32ProcessID == GetCurrentProcessId())
+                count = (int) entry.cntThreads;
+
+        CloseHandle (snapshot);
+        return count;
+       #else
+        return 0;
+       #endif
+    }
+
+    //==============================================================================
+    /** Stands in for the rest of a busy session: spins on arithmetic at
+        normal priority until stopped. */
+    class LoadThread : public juce::Thread
+    {
+    public:
+        explicit LoadThread (int index) : juce::Thread ("Soak load " + juce::String (index)) {}
+
+        void run() override
+        {
+            volatile float sink = 0.0f;
+            float x = 1.0f;
+
+            while (! threadShouldExit())
+            {
+                for (int i = 0; i < 100000; ++i)
+                    x = x * 1.0000001f + 0.0000001f;
+
+                sink = x;
+            }
+        }
+    };
+
+    //==============================================================================
+    /** The plugin instances and the simulated audio callback that drives them. */
+    class Host : public juce::Thread
+    {
+    public:
+        explicit Host (const SoakSettings& s)
+            : juce::Thread ("Soak host callback"), settings (s), random (1234)
+        {
+            source.setSize (2, 1 << 16);
+            for (int ch = 0; ch < source.getNumChannels(); ++ch)
+                for (int i = 0; i < source.getNumSamples(); ++i)
+                    source.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            scratch.setSize (2, settings.maxBlock);
+        }
+
+        /** Adds instances up to numInstances, prepared at the current rate.
+            Only while the callback is stopped. */
+        bool addInstances (int numInstances)
+        {
+            jassert (! isThreadRunning());
+
+            while ((int) processors.size() < numInstances)
+            {
+                auto processor = std::make_unique<MojoInsectsAudioProcessor>();
+
+                if (settings.model != juce::File() && ! processor->loadModel (settings.model))
+                {
+                    std::cerr << "Cannot load " << settings.model.getFullPathName() << ": "
+                              << processor->getModelLoadStatus().message << std::endl;
+                    return false;
+                }
+
+                processor->setPlayConfigDetails (2, 2, getSampleRate(), settings.maxBlock);
+                processor->prepareToPlay (getSampleRate(), settings.maxBlock);
+                processors.push_back (std::move (processor));
+            }
+
+            return true;
+        }
+
+        int getNumInstances() const noexcept { return (int) processors.size(); }
+
+        /** Hot-swaps the model on a random instance, as a user loading a
+            model during playback would. Message thread. */
+        void reloadRandomInstance()
+        {
+            if (! processors.empty() && settings.model != juce::File())
+                processors[(size_t) reloadRandom.nextInt ((int) processors.size())]->loadModelAsync (settings.model);
+        }
+
+        /** Sums every instance's block counters. */
+        void addTelemetry (SegmentResult& result) const
+        {
+            for (const auto& processor : processors)
+            {
+                const auto snapshot = processor->getTelemetry();
+                result.blocks         += snapshot.blocks;
+                result.dryBlocks      += snapshot.dryBlocks;
+                result.droppedSamples += snapshot.droppedInputSamples + snapshot.droppedOutputSamples;
+            }
+        }
+
+        /** Callback counters since the last call (callback stopped or not). */
+        SegmentResult takeCounters()
+        {
+            SegmentResult result;
+            result.callbacks   = callbacks.exchange (0);
+            result.misses      = misses.exchange (0);
+            result.worstMicros = (double) worstMicros.exchange (0);
+            result.rateChanges = rateChanges.exchange (0);
+            return result;
+        }
+
+        double getSampleRate() const noexcept
+        {
+            return settings.sampleRates[rateIndex.load() % settings.sampleRates.size()];
+        }
+
+        void run() override
+        {
+            juce::MidiBuffer midi;
+            int sourcePos = 0;
+
+            auto next = juce::Time::getHighResolutionTicks();
+            auto nextRateChange = next + secondsToTicks (settings.rateChangeSeconds);
+
+            while (! threadShouldExit())
+            {
+                if (settings.rateChangeSeconds > 0.0 && settings.sampleRates.size() > 1
+                    && juce::Time::getHighResolutionTicks() >= nextRateChange)
+                {
+                    changeSampleRate();
+                    next = juce::Time::getHighResolutionTicks();
+                    nextRateChange = next + secondsToTicks (settings.rateChangeSeconds);
+                }
+
+                const int blockSize = random.nextInt (juce::Range<int> (settings.minBlock, settings.maxBlock + 1));
+                const double periodSeconds = (double) blockSize / getSampleRate();
+
+                if (sourcePos + blockSize > source.getNumSamples())
+                    sourcePos = 0;
+
+                const auto start = juce::Time::getHighResolutionTicks();
+
+                for (auto& processor : processors)
+                {
+                    for (int ch = 0; ch < scratch.getNumChannels(); ++ch)
+                        scratch.copyFrom (ch, 0, source, ch, sourcePos, blockSize);
+
+                    juce::AudioBuffer<float> block (scratch.getArrayOfWritePointers(), scratch.getNumChannels(), blockSize);
+                    processor->processBlock (block, midi);
+                }
+
+                const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+                const auto elapsedMicros = (juce::int64) (elapsed * 1.0e6);
+
+                ++callbacks;
+                if (elapsed > periodSeconds * settings.budget)
+                    ++misses;
+
+                if (elapsedMicros > worstMicros.load())
+                    worstMicros.store (elapsedMicros);
+
+                sourcePos += blockSize;
+
+                // Like a sound card, the next callback comes one period after
+                // this one was due; one that overran starts right away.
+                next += secondsToTicks (periodSeconds);
+                const auto now = juce::Time::getHighResolutionTicks();
+
+                if (next < now)
+                    next = now;
+
+                while (juce::Time::getHighResolutionTicks() < next && ! threadShouldExit())
+                {
+                    const auto remaining = juce::Time::highResolutionTicksToSeconds (next - juce::Time::getHighResolutionTicks());
+                    if (remaining > 0.002)
+                        juce::Thread::sleep (1);
+                    else
+                        juce::Thread::yield();
+                }
+            }
+        }
+
+    private:
+        static juce::int64 secondsToTicks (double seconds)
+        {
+            return juce::Time::secondsToHighResolutionTicks (seconds);
+        }
+
+        /** What a host does when the project's rate changes: stop the audio,
+            re-prepare every plugin, start again. */
+        void changeSampleRate()
+        {
+            ++rateIndex;
+            ++rateChanges;
+
+            for (auto& processor : processors)
+            {
+                processor->releaseResources();
+                processor->setPlayConfigDetails (2, 2, getSampleRate(), settings.maxBlock);
+                processor->prepareToPlay (getSampleRate(), settings.maxBlock);
+            }
+        }
+
+        const SoakSettings& settings;
+        std::vector<std::unique_ptr<MojoInsectsAudioProcessor>> processors;
+
+        juce::AudioBuffer<float> source, scratch;
+        juce::Random random, reloadRandom { 99 };
+
+        std::atomic<int>         rateIndex   { 0 };
+        std::atomic<uint64_t>    callbacks   { 0 };
+        std::atomic<uint64_t>    misses      { 0 };
+        std::atomic<juce::int64> worstMicros { 0 };
+        std::atomic<int>         rateChanges { 0 };
+    };
+
+    //==============================================================================
+    void print (const SegmentResult& r, const juce::String& prefix)
+    {
+        std::cout << prefix.paddedRight (' ', 10)
+                  << juce::String (r.instances).paddedLeft (' ', 4) << " inst  "
+                  << juce::String (r.callbacks).paddedLeft (' ', 8) << " callbacks  "
+                  << "misses " << juce::String (r.misses).paddedLeft (' ', 6)
+                  << " (" << juce::String (100.0 * r.getMissRate(), 3) << "%, worst "
+                  << juce::String (r.worstMicros / 1000.0, 2) << " ms)  "
+                  << "dry " << juce::String (r.dryBlocks).paddedLeft (' ', 5) << "/" << juce::String (r.blocks)
+                  << "  dropped " << juce::String (r.droppedSamples)
+                  << "  RSS " << juce::String ((double) r.peakRssBytes / (1024.0 * 1024.0), 1) << " MB"
+                  << "  threads " << r.threads << std::endl;
+    }
+
+    /** Runs the callback over every instance for settings.segmentSeconds,
+        reloading and reporting from this (the message) thread. */
+    SegmentResult runSegment (Host& host, const SoakSettings& settings)
+    {
+        SegmentResult before;
+        host.addTelemetry (before);
+        host.takeCounters();
+
+        // Realtime scheduling can need privileges; fall back to the highest
+        // ordinary priority rather than not running at all.
+        if (! host.startRealtimeThread (juce::Thread::RealtimeOptions{}
+                                            .withApproximateAudioProcessingTime (settings.maxBlock, host.getSampleRate())))
+            host.startThread (juce::Thread::Priority::highest);
+
+        SegmentResult total;
+        int reloads = 0;
+
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        auto nextReload = start + settings.reloadSeconds * 1000.0;
+        auto nextReport = start + settings.reportSeconds * 1000.0;
+
+        for (auto now = start; now - start < settings.segmentSeconds * 1000.0; now = juce::Time::getMillisecondCounterHiRes())
+        {
+            juce::Thread::sleep (10);
+
+            if (settings.reloadSeconds > 0.0 && now >= nextReload)
+            {
+                host.reloadRandomInstance();
+                ++reloads;
+                nextReload += settings.reloadSeconds * 1000.0;
+            }
+
+            if (settings.reportSeconds > 0.0 && now >= nextReport)
+            {
+                const auto interval = host.takeCounters();
+                total.callbacks   += interval.callbacks;
+                total.misses      += interval.misses;
+                total.worstMicros  = juce::jmax (total.worstMicros, interval.worstMicros);
+                total.rateChanges += interval.rateChanges;
+
+                auto progress = total;
+                progress.instances    = host.getNumInstances();
+                progress.peakRssBytes = getPeakResidentBytes();
+                progress.threads      = getNumProcessThreads();
+                host.addTelemetry (progress);
+                progress.blocks    -= before.blocks;
+                progress.dryBlocks -= before.dryBlocks;
+                progress.droppedSamples -= before.droppedSamples;
+
+                print (progress, juce::String ((now - start) / 1000.0, 0) + " s");
+                nextReport += settings.reportSeconds * 1000.0;
+            }
+        }
+
+        host.stopThread (5000);
+
+        const auto rest = host.takeCounters();
+        total.callbacks   += rest.callbacks;
+        total.misses      += rest.misses;
+        total.worstMicros  = juce::jmax (total.worstMicros, rest.worstMicros);
+        total.rateChanges += rest.rateChanges;
+
+        total.instances    = host.getNumInstances();
+        total.seconds      = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        total.reloads      = reloads;
+        total.peakRssBytes = getPeakResidentBytes();
+        total.threads      = getNumProcessThreads();
+
+        host.addTelemetry (total);
+        total.blocks         -= before.blocks;
+        total.dryBlocks      -= before.dryBlocks;
+        total.droppedSamples -= before.droppedSamples;
+        return total;
+    }
+
+    juce::String toJson (const std::vector<SegmentResult>& segments, const SoakSettings& settings, int tippingPoint)
+    {
+        juce::Array<juce::var> rows;
+
+        for (const auto& s : segments)
+        {
+            auto* row = new juce::DynamicObject();
+            row->setProperty ("instances",      s.instances);
+            row->setProperty ("seconds",        s.seconds);
+            row->setProperty ("callbacks",      (juce::int64) s.callbacks);
+            row->setProperty ("misses",         (juce::int64) s.misses);
+            row->setProperty ("missRate",       s.getMissRate());
+            row->setProperty ("worstMs",        s.worstMicros / 1000.0);
+            row->setProperty ("blocks",         (juce::int64) s.blocks);
+            row->setProperty ("dryBlocks",      (juce::int64) s.dryBlocks);
+            row->setProperty ("droppedSamples", (juce::int64) s.droppedSamples);
+            row->setProperty ("rateChanges",    s.rateChanges);
+            row->setProperty ("reloads",        s.reloads);
+            row->setProperty ("peakRssBytes",   s.peakRssBytes);
+            row->setProperty ("threads",        s.threads);
+            rows.add (juce::var (row));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("timestamp",    juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("cpu",          juce::SystemStats::getCpuModel());
+        root->setProperty ("cores",        juce::SystemStats::getNumPhysicalCpus());
+        root->setProperty ("model",        settings.model.getFileName());
+        root->setProperty ("minBlock",     settings.minBlock);
+        root->setProperty ("maxBlock",     settings.maxBlock);
+        root->setProperty ("loadThreads",  settings.loadThreads);
+        root->setProperty ("tippingPoint", tippingPoint);
+        root->setProperty ("segments",     rows);
+        return juce::JSON::toString (juce::var (root));
+    }
+
+    SoakSettings parseSettings (const juce::ArgumentList& args)
+    {
+        SoakSettings s;
+        s.model = args.containsOption ("--model") ? args.getFileForOption ("--model")
+                                                  : juce::File (MOJO_BENCH_MODEL_PATH);
+
+        const auto intOption = [&args] (const char* option, int fallback, int minimum)
+        {
+            return args.containsOption (option) ? juce::jmax (minimum, args.getValueForOption (option).getIntValue())
+                                                : fallback;
+        };
+
+        const auto doubleOption = [&args] (const char* option, double fallback)
+        {
+            return args.containsOption (option) ? juce::jmax (0.0, args.getValueForOption (option).getDoubleValue())
+                                                : fallback;
+        };
+
+        s.instances         = intOption ("--instances", s.instances, 1);
+        s.rampStep          = intOption ("--ramp", s.rampStep, 0);
+        s.maxInstances      = intOption ("--max-instances", s.maxInstances, s.instances);
+        s.loadThreads       = intOption ("--load", s.loadThreads, 0);
+        s.segmentSeconds    = doubleOption ("--seconds", s.segmentSeconds);
+        s.maxMissRate       = doubleOption ("--max-miss", s.maxMissRate);
+        s.rateChangeSeconds = doubleOption ("--rate-change", s.rateChangeSeconds);
+        s.reloadSeconds     = doubleOption ("--reload", s.reloadSeconds);
+        s.reportSeconds     = doubleOption ("--report", s.reportSeconds);
+        s.budget            = juce::jmax (0.01, doubleOption ("--budget", s.budget));
+
+        if (args.containsOption ("--block"))
+        {
+            const auto range = args.getValueForOption ("--block");
+            s.minBlock = juce::jmax (1, range.upToFirstOccurrenceOf (":", false, false).getIntValue());
+            s.maxBlock = juce::jmax (s.minBlock, range.fromFirstOccurrenceOf (":", false, false).getIntValue());
+        }
+
+        if (args.containsOption ("--rates"))
+        {
+            s.sampleRates.clear();
+            for (const auto& rate : juce::StringArray::fromTokens (args.getValueForOption ("--rates"), ",", {}))
+                if (rate.getDoubleValue() > 0.0)
+                    s.sampleRates.add (rate.getDoubleValue());
+
+            if (s.sampleRates.isEmpty())
+                s.sampleRates.add (48000.0);
+        }
+
+        return s;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS starts a timer, which needs a MessageManager to exist.
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const juce::ArgumentList args (argc, argv);
+    auto settings = parseSettings (args);
+
+    if (! settings.model.existsAsFile())
+    {
+        std::cerr << "Model " << settings.model.getFullPathName() << " not found, soaking in passthrough" << std::endl;
+        settings.model = juce::File();
+    }
+
+    std::cout << "Soaking " << (settings.model != juce::File() ? settings.model.getFileName() : juce::String ("passthrough"))
+              << ", blocks " << settings.minBlock << ".." << settings.maxBlock
+              << ", " << settings.loadThreads << " load threads, "
+              << juce::String (settings.segmentSeconds, 0) << " s per segment" << std::endl;
+
+    std::vector<std::unique_ptr<LoadThread>> load;
+    for (int i = 0; i < settings.loadThreads; ++i)
+    {
+        load.push_back (std::make_unique<LoadThread> (i));
+        load.back()->startThread();
+    }
+
+    Host host (settings);
+    std::vector<SegmentResult> segments;
+    int tippingPoint = 0;   // most instances that ran clean
+
+    for (int instances = settings.instances; instances <= settings.maxInstances; instances += settings.rampStep)
+    {
+        if (! host.addInstances (instances))
+            return 1;
+
+        segments.push_back (runSegment (host, settings));
+        print (segments.back(), "segment");
+
+        if (! segments.back().isClean (settings.maxMissRate))
+            break;
+
+        tippingPoint = instances;
+
+        if (settings.rampStep == 0)
+            break;
+    }
+
+    for (auto& thread : load)
+        thread->stopThread (2000);
+
+    if (settings.rampStep > 0)
+        std::cout << "\nRan clean with up to " << tippingPoint << " instances" << std::endl;
+
+    if (args.containsOption ("--json"))
+        args.getFileForOption ("--json").replaceWithText (toJson (segments, settings, tippingPoint));
+
+    return 0;
+}
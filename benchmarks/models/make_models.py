@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Writes the tiny ONNX models the benchmarks use.
+
+The protobuf is encoded by hand so regenerating needs nothing beyond the
+standard library:
+
+    python3 benchmarks/models/make_models.py
+"""
+
+import os
+import struct
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def field_varint(number, value):
+    return varint(number << 3 | 0) + varint(value)
+
+
+def field_bytes(number, payload):
+    if isinstance(payload, str):
+        payload = payload.encode()
+    return varint(number << 3 | 2) + varint(len(payload)) + payload
+
+
+def float_tensor_info(name, shape=("batch", "samples")):
+    """ValueInfoProto for a float tensor; shape holds a name for each dynamic
+    dimension and a number for each static one."""
+    dims = b"".join(field_bytes(1, field_varint(1, d) if isinstance(d, int) else field_bytes(2, d))
+                    for d in shape)
+    tensor_type = field_varint(1, 1) + field_bytes(2, dims)  # elem_type FLOAT, shape
+    return field_bytes(1, name) + field_bytes(2, field_bytes(1, tensor_type))
+
+
+def scalar_initializer(name, value):
+    """TensorProto holding a single float."""
+    return (field_varint(2, 1)                          # data_type FLOAT
+            + field_bytes(8, name)
+            + field_bytes(9, struct.pack("<f", value)))  # raw_data
+
+
+def float_initializer(name, dims, values):
+    """TensorProto holding a float tensor of the given shape."""
+    return (b"".join(field_varint(1, d) for d in dims)
+            + field_varint(2, 1)                          # data_type FLOAT
+            + field_bytes(8, name)
+            + field_bytes(9, struct.pack("<%df" % len(values), *values)))
+
+
+def half_initializer(name, value):
+    """TensorProto holding a single float16."""
+    return (field_varint(2, 10)                         # data_type FLOAT16
+            + field_bytes(8, name)
+            + field_bytes(9, struct.pack("<e", value)))  # raw_data
+
+
+def int_attribute(name, value):
+    """AttributeProto of type INT."""
+    return field_bytes(1, name) + field_varint(3, value) + field_varint(20, 2)
+
+
+def node(op_type, inputs, outputs, name, attributes=()):
+    return (b"".join(field_bytes(1, i) for i in inputs)
+            + b"".join(field_bytes(2, o) for o in outputs)
+            + field_bytes(3, name)
+            + field_bytes(4, op_type)
+            + b"".join(field_bytes(5, a) for a in attributes))
+
+
+def model(graph_name, nodes, initializers, extra_inputs=(), extra_outputs=(), metadata=(),
+          shape=("batch", "samples")):
+    graph = (b"".join(field_bytes(1, n) for n in nodes)
+             + field_bytes(2, graph_name)
+             + b"".join(field_bytes(5, t) for t in initializers)
+             + field_bytes(11, float_tensor_info("input", shape))
+             + b"".join(field_bytes(11, i) for i in extra_inputs)
+             + field_bytes(12, float_tensor_info("output", shape))
+             + b"".join(field_bytes(12, o) for o in extra_outputs))
+
+    opset = field_bytes(1, "") + field_varint(2, 13)
+
+    return (field_varint(1, 8)                  # ir_version
+            + field_bytes(2, "MojoInsects")     # producer_name
+            + field_bytes(7, graph)
+            + field_bytes(8, opset)
+            + b"".join(field_bytes(14, field_bytes(1, k) + field_bytes(2, v))  # metadata_props
+                       for k, v in metadata))
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+
+    # output = tanh (drive * input): a soft clipper, small enough that the
+    # benchmark measures ORT's per-Run overhead rather than the maths.
+    softclip = model("softclip",
+                     [node("Mul", ["input", "drive"], ["driven"], "drive"),
+                      node("Tanh", ["driven"], ["output"], "clip")],
+                     [scalar_initializer("drive", 2.0)])
+
+    # The same with its weight stored as float16, the way an "fp16 weights,
+    # float I/O" export does it: a Cast back to float that ORT folds at load.
+    # Lets the variant verification run against a real model pair.
+    softclip_fp16 = model("softclip",
+                          [node("Cast", ["drive_fp16"], ["drive"], "widen", [int_attribute("to", 1)]),
+                           node("Mul", ["input", "drive"], ["driven"], "drive"),
+                           node("Tanh", ["driven"], ["output"], "clip")],
+                          [half_initializer("drive_fp16", 2.0)])
+
+    # The soft clipper with its drive as a conditioning control rather than a
+    # constant: output = tanh (controls[:, 0] * input), one drive per frame.
+    softclip_drive = model("softclip_drive",
+                           [node("Mul", ["input", "controls"], ["driven"], "drive"),
+                            node("Tanh", ["driven"], ["output"], "clip")],
+                           [],
+                           extra_inputs=[float_tensor_info("controls", ("batch", 1))],
+                           metadata=[("mojo.controls", "drive=0.5:8:2")])
+
+    # A spectral model: 256-point frames every 64 samples as [batch, 2, 129]
+    # magnitude/phase rows, with every magnitude halved. Resynthesised, that
+    # is the input at half level.
+    spectral_gain = model("spectral_gain",
+                          [node("Mul", ["input", "scale"], ["output"], "halve_magnitude")],
+                          [float_initializer("scale", [2, 1], [0.5, 1.0])],
+                          metadata=[("mojo.fft_size", "256"), ("mojo.hop", "64")],
+                          shape=("batch", 2, 129))
+
+    # A model trained at 48 kHz: output = 0.5 * input, declared to run at
+    # that rate only. In any other session the engine converts around it.
+    gain_48k = model("gain_48k",
+                     [node("Mul", ["input", "gain"], ["output"], "halve")],
+                     [scalar_initializer("gain", 0.5)],
+                     metadata=[("mojo.sample_rate", "48000")])
+
+    # output = 0.5 * input with no declared framing, so it can be swapped in
+    # for the soft clipper during playback (forced onto ONNX Runtime).
+    half_gain = model("half_gain",
+                      [node("Mul", ["input", "gain"], ["output"], "halve")],
+                      [scalar_initializer("gain", 0.5)])
+
+    # A stateful model: 64-sample hops, each output being the hop before it.
+    # The previous hop is the recurrent state, so the output shows whether
+    # the engine carried it across hops or cleared it.
+    hop_delay = model("hop_delay",
+                      [node("Identity", ["previous_in"], ["output"], "replay"),
+                       node("Identity", ["input"], ["previous_out"], "remember")],
+                      [],
+                      extra_inputs=[float_tensor_info("previous_in", ("batch", 64))],
+                      extra_outputs=[float_tensor_info("previous_out", ("batch", 64))],
+                      metadata=[("mojo.state", "previous_in:previous_out")],
+                      shape=("batch", 64))
+
+    for name, data in (("softclip.onnx", softclip), ("softclip.fp16.onnx", softclip_fp16),
+                       ("softclip_drive.onnx", softclip_drive), ("spectral_gain.onnx", spectral_gain),
+                       ("gain_48k.onnx", gain_48k), ("hop_delay.onnx", hop_delay),
+                       ("half_gain.onnx", half_gain)):
+        with open(os.path.join(here, name), "wb") as f:
+            f.write(data)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Decides, hop by hop, how much work the inference thread can afford before
+ * processBlock would run out of wet samples.
+ *
+ * In realtime every hop must be inferred within one hop period
+ * (hop / sampleRate) on average, or the output FIFO drains and the block
+ * goes dry. The scheduler counts recent Runs over kDegradeAbove of that
+ * budget and, once the pressure is sustained, switches to the lighter
+ * fallback model before the budget is actually used up. A lone slow Run is
+ * absorbed by the output FIFO's priming and changes nothing.
+ *
+ *   full     — the loaded model
+ *   reduced  — a lighter fallback model, when one is loaded
+ *   bypassed — no Run at all: the frame passes through dry, still aligned
+ *              to the reported latency, so the wet/dry seam stays in time
+ *
+ * Bypassing trades wet audio for dry, which only pays once the thread has
+ * actually fallen behind. So slow Runs alone never bypass, with or without
+ * a fallback; hops piling up in the input FIFO beyond what one host block
+ * explains do, straight away. That also catches stalls the Run timer cannot
+ * see (preemption, a slow wakeup). Even then the engine blends from the
+ * last wet output into the dry signal rather than stepping.
+ *
+ * After kRecoverAfterHops hops without pressure it probes the next level up.
+ * A probe that has to step back down doubles the wait before the next one
+ * (up to kMaxRecoverAfterHops), so an overloaded session settles on the
+ * level it can sustain instead of flapping between two.
+ *
+ * All methods except getQuality() belong to the inference thread.
+ */
+class DeadlineScheduler
+{
+public:
+    enum class Quality { full, reduced, bypassed };
+
+    /** Share of the hop period above which a Run counts as pressure. */
+    static constexpr double kDegradeAbove = 0.75;
+
+    /** Net count of slow Runs (each faster one cancels one) at which the
+        fallback model takes over. */
+    static constexpr int kDegradeAfterHops = 4;
+
+    /** A Run above this share of the hop period restarts the recovery wait. */
+    static constexpr double kRecoverBelow = 0.5;
+
+    static constexpr int kRecoverAfterHops    = 64;
+    static constexpr int kMaxRecoverAfterHops = 4096;
+
+    /** A sampleRate of 0 (rate unknown, or offline) keeps everything at full
+        quality. maxHopsPerBlock is how many hops one host block can queue. */
+    void prepare (double sampleRate, int hopSize, int maxHopsPerBlock, bool hasReducedLevel) noexcept
+    {
+        budgetMicros   = sampleRate > 0.0 ? 1.0e6 * (double) hopSize / sampleRate : 0.0;
+        maxBacklogHops = juce::jmax (1, maxHopsPerBlock) + 1;
+        canReduce      = hasReducedLevel;
+        recoverAfter   = kRecoverAfterHops;
+        setLevel (Quality::full);
+        probing = false;
+        transitions = 0;
+    }
+
+    bool isEnabled() const noexcept { return budgetMicros > 0.0; }
+    double getBudgetMicros() const noexcept { return budgetMicros; }
+
+    /** Called before each hop with the number of complete hops waiting
+        (including this one). Returns the level to run it at. */
+    Quality beginHop (int hopsWaiting) noexcept
+    {
+        if (! isEnabled())
+            return Quality::full;
+
+        if (hopsWaiting > maxBacklogHops)
+        {
+            stepDown();
+            return level;
+        }
+
+        ++calmHops;
+
+        // A probe that lasted a full recovery period was sustainable.
+        if (probing && calmHops >= kRecoverAfterHops)
+        {
+            probing = false;
+            recoverAfter = kRecoverAfterHops;
+        }
+
+        if (level != Quality::full && calmHops >= recoverAfter)
+            stepUp();
+
+        return level;
+    }
+
+    /** Called after each hop with how long its Run took. */
+    void endHop (double micros) noexcept
+    {
+        if (! isEnabled())
+            return;
+
+        // Each slow Run adds to the pressure and each fast one takes one
+        // away, so a spike fades out again instead of stepping down.
+        if (micros > kDegradeAbove * budgetMicros)
+            pressureHops = juce::jmin (pressureHops + 1, kDegradeAfterHops);
+        else
+            pressureHops = juce::jmax (pressureHops - 1, 0);
+
+        if (micros > kRecoverBelow * budgetMicros)
+            calmHops = 0;
+
+        if (pressureHops >= kDegradeAfterHops && level == Quality::full && canReduce)
+            stepDown();
+    }
+
+    /** The level the most recent hop ran at. Any thread. */
+    Quality getQuality() const noexcept { return published.load (std::memory_order_relaxed); }
+
+    /** How often the level changed since prepare(). Inference thread. */
+    int getNumTransitions() const noexcept { return transitions; }
+
+private:
+    void stepDown() noexcept
+    {
+        if (level == Quality::bypassed)
+            return;
+
+        // The level we just probed could not hold: wait longer next time.
+        if (probing)
+            recoverAfter = juce::jmin (2 * recoverAfter, kMaxRecoverAfterHops);
+
+        probing = false;
+        setLevel (level == Quality::full && canReduce ? Quality::reduced : Quality::bypassed);
+    }
+
+    void stepUp() noexcept
+    {
+        probing = true;
+        setLevel (level == Quality::bypassed && canReduce ? Quality::reduced : Quality::full);
+    }
+
+    // Each level has its own cost, so the pressure starts afresh.
+    void setLevel (Quality newLevel) noexcept
+    {
+        if (newLevel != level)
+            ++transitions;
+
+        level        = newLevel;
+        pressureHops = 0;
+        calmHops     = 0;
+        published.store (newLevel, std::memory_order_relaxed);
+    }
+
+    double  budgetMicros   { 0.0 };
+    int     pressureHops   { 0 };
+    int     maxBacklogHops { 2 };
+    int     calmHops       { 0 };
+    int     recoverAfter   { kRecoverAfterHops };
+    int     transitions    { 0 };
+    bool    canReduce      { false };
+    bool    probing        { false };
+    Quality level          { Quality::full };
+
+    std::atomic<Quality> published { Quality::full };
+};
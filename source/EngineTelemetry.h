@@ -0,0 +1,152 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Lock-free counters describing how the audio ↔ inference exchange behaves:
+ * how long each inference pass takes (as a log2-bucketed histogram), how full
+ * the FIFOs get, how many samples were dropped, how many blocks had to
+ * fall back to the dry signal, and how many hops the deadline scheduler ran
+ * below full quality.
+ *
+ * Every counter has exactly one writer thread — the audio thread or the
+ * inference thread — so updates are a relaxed load + store rather than a
+ * locked read-modify-write, and nothing on the write path allocates or blocks.
+ * The message thread reads a (slightly torn, but monotonic) snapshot at will.
+ */
+class EngineTelemetry
+{
+public:
+    /** Bucket 0 holds passes under 1 µs; bucket b holds [2^(b-1), 2^b) µs.
+        The last bucket also collects everything slower. */
+    static constexpr int kNumRunBuckets = 24;
+
+    struct Snapshot
+    {
+        std::array<uint64_t, kNumRunBuckets> runHistogram {};
+
+        uint64_t runs                 = 0;
+        uint64_t blocks               = 0;
+        uint64_t dryBlocks            = 0;
+        uint64_t droppedInputSamples  = 0;
+        uint64_t droppedOutputSamples = 0;
+        uint64_t reducedHops          = 0;   // run on the fallback model
+        uint64_t bypassedHops         = 0;   // passed through without a Run
+        int      inputFifoHighWater   = 0;   // samples
+        int      outputFifoHighWater  = 0;   // samples
+
+        /** Upper edge, in microseconds, of the bucket holding the given
+            quantile (0..1) of inference passes. 0 when nothing ran yet. */
+        double getRunQuantileMicros (double quantile) const noexcept
+        {
+            if (runs == 0)
+                return 0.0;
+
+            const auto target = (uint64_t) std::ceil (juce::jlimit (0.0, 1.0, quantile) * (double) runs);
+            uint64_t seen = 0;
+
+            for (int b = 0; b < kNumRunBuckets; ++b)
+            {
+                seen += runHistogram[(size_t) b];
+                if (seen >= juce::jmax ((uint64_t) 1, target))
+                    return getBucketUpperEdgeMicros (b);
+            }
+
+            return getBucketUpperEdgeMicros (kNumRunBuckets - 1);
+        }
+    };
+
+    static double getBucketUpperEdgeMicros (int bucket) noexcept
+    {
+        return std::ldexp (1.0, bucket);
+    }
+
+    //==============================================================================
+    // Inference thread (the audio thread instead when the model runs inline,
+    // in which case the inference thread records nothing)
+
+    void recordRun (double micros) noexcept
+    {
+        auto us = (uint64_t) juce::jmax (0.0, micros);
+        int bucket = 0;
+
+        while (us > 0 && bucket < kNumRunBuckets - 1)
+        {
+            us >>= 1;
+            ++bucket;
+        }
+
+        bump (runHistogram[(size_t) bucket]);
+        bump (runs);
+    }
+
+    void addDroppedOutput (int numSamples) noexcept    { bump (droppedOutputSamples, (uint64_t) numSamples); }
+    void addReducedHop() noexcept                      { bump (reducedHops); }
+    void addBypassedHop() noexcept                     { bump (bypassedHops); }
+    void noteOutputFifoLevel (int numSamples) noexcept { raise (outputFifoHighWater, numSamples); }
+
+    //==============================================================================
+    // Audio thread
+
+    void addBlock (bool wentDry) noexcept
+    {
+        bump (blocks);
+        if (wentDry)
+            bump (dryBlocks);
+    }
+
+    void addDroppedInput (int numSamples) noexcept     { bump (droppedInputSamples, (uint64_t) numSamples); }
+    void noteInputFifoLevel (int numSamples) noexcept  { raise (inputFifoHighWater, numSamples); }
+
+    //==============================================================================
+    // Message thread
+
+    Snapshot getSnapshot() const noexcept
+    {
+        Snapshot s;
+
+        for (size_t b = 0; b < runHistogram.size(); ++b)
+            s.runHistogram[b] = runHistogram[b].load (std::memory_order_relaxed);
+
+        s.runs                 = runs.load (std::memory_order_relaxed);
+        s.blocks               = blocks.load (std::memory_order_relaxed);
+        s.dryBlocks            = dryBlocks.load (std::memory_order_relaxed);
+        s.droppedInputSamples  = droppedInputSamples.load (std::memory_order_relaxed);
+        s.droppedOutputSamples = droppedOutputSamples.load (std::memory_order_relaxed);
+        s.reducedHops          = reducedHops.load (std::memory_order_relaxed);
+        s.bypassedHops         = bypassedHops.load (std::memory_order_relaxed);
+        s.inputFifoHighWater   = inputFifoHighWater.load (std::memory_order_relaxed);
+        s.outputFifoHighWater  = outputFifoHighWater.load (std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static_assert (std::atomic<uint64_t>::is_always_lock_free,
+                   "Telemetry must not fall back to locked atomics on the audio thread");
+
+    // Single-writer increments: no lock prefix needed.
+    static void bump (std::atomic<uint64_t>& counter, uint64_t amount = 1) noexcept
+    {
+        counter.store (counter.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void raise (std::atomic<int>& highWater, int value) noexcept
+    {
+        if (value > highWater.load (std::memory_order_relaxed))
+            highWater.store (value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kNumRunBuckets> runHistogram {};
+    std::atomic<uint64_t> runs                 { 0 };
+    std::atomic<uint64_t> droppedOutputSamples { 0 };
+    std::atomic<uint64_t> reducedHops          { 0 };
+    std::atomic<uint64_t> bypassedHops         { 0 };
+    std::atomic<int>      outputFifoHighWater  { 0 };
+
+    // Written by the audio thread. Kept apart from the inference thread's
+    // counters so the two writers don't share a cache line.
+    alignas (64) std::atomic<uint64_t> blocks              { 0 };
+    std::atomic<uint64_t>              dryBlocks           { 0 };
+    std::atomic<uint64_t>              droppedInputSamples { 0 };
+    std::atomic<int>                   inputFifoHighWater  { 0 };
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * How an InferenceEngine schedules its work: the priority, scheduling class
+ * and CPU affinity of its inference thread, and the threading of the ONNX
+ * Runtime sessions it creates.
+ *
+ * The defaults are what the engine has always done: a background-priority
+ * thread on whichever core the OS picks, and single-threaded sessions with
+ * ORT's own defaults for everything else. Raise the priority when the host
+ * is busy enough to preempt inference and blocks go dry; pin the thread to
+ * cores the host's audio threads do not use on machines with many of them.
+ *
+ * Saved with the plugin state (toValueTree()/fromValueTree()), and settable
+ * from the benchmarks' command line, so it can be tuned per machine.
+ */
+struct EngineThreading
+{
+    enum class Priority
+    {
+        background,
+        low,
+        normal,
+        high,
+        highest,
+        realtime    // realtime scheduling class: SCHED_RR on Linux (needs an
+                    // rtprio limit), a time-constraint thread on macOS
+    };
+
+    Priority priority         = Priority::background;
+    int      realtimePriority = 5;   // 0..10, as juce::Thread::RealtimeOptions; realtime only
+    uint32_t affinityMask     = 0;   // bit n allows CPU n; 0 lets the OS choose
+
+    // ONNX Runtime, for sessions created from now on. 0 threads means ORT's
+    // default. Offline renders always use every physical core for intra-op.
+    int  intraOpThreads    = 1;
+    int  interOpThreads    = 0;
+    bool allowSpinning     = true;    // pool threads spin between Runs rather than sleep
+    bool parallelExecution = false;   // ORT_PARALLEL: independent branches on inter-op threads
+
+    /** True if the inference thread itself would run differently, i.e. has
+        to be restarted to apply other. */
+    bool threadDiffers (const EngineThreading& other) const noexcept
+    {
+        return priority != other.priority || affinityMask != other.affinityMask
+            || (priority == Priority::realtime && realtimePriority != other.realtimePriority);
+    }
+
+    /** Tells apart sessions built with different ORT options. */
+    juce::String getSessionKey() const
+    {
+        return "i" + juce::String (intraOpThreads) + "x" + juce::String (interOpThreads)
+             + (allowSpinning ? "s" : "") + (parallelExecution ? "p" : "");
+    }
+
+    bool operator== (const EngineThreading& other) const noexcept
+    {
+        return ! threadDiffers (other) && realtimePriority == other.realtimePriority
+            && intraOpThreads == other.intraOpThreads && interOpThreads == other.interOpThreads
+            && allowSpinning == other.allowSpinning && parallelExecution == other.parallelExecution;
+    }
+
+    bool operator!= (const EngineThreading& other) const noexcept { return ! operator== (other); }
+
+    //==============================================================================
+    static constexpr Priority kPriorities[] = { Priority::background, Priority::low, Priority::normal,
+                                                Priority::high, Priority::highest, Priority::realtime };
+
+    /** "background", "low", "normal", "high", "highest" or "realtime". */
+    static juce::String getName (Priority p)
+    {
+        switch (p)
+        {
+            case Priority::background: return "background";
+            case Priority::low:        return "low";
+            case Priority::normal:     return "normal";
+            case Priority::high:       return "high";
+            case Priority::highest:    return "highest";
+            case Priority::realtime:   return "realtime";
+        }
+
+        return {};
+    }
+
+    /** The priority called name, or fallback if there is none. */
+    static Priority getPriority (const juce::String& name, Priority fallback)
+    {
+        for (auto p : kPriorities)
+            if (name == getName (p))
+                return p;
+
+        return fallback;
+    }
+
+    //==============================================================================
+    static inline const juce::Identifier kStateType { "Threading" };
+
+    juce::ValueTree toValueTree() const
+    {
+        juce::ValueTree tree (kStateType);
+        tree.setProperty ("priority",          getName (priority),                    nullptr);
+        tree.setProperty ("realtimePriority",  realtimePriority,                      nullptr);
+        tree.setProperty ("affinityMask",      juce::String::toHexString ((int) affinityMask), nullptr);
+        tree.setProperty ("intraOpThreads",    intraOpThreads,                        nullptr);
+        tree.setProperty ("interOpThreads",    interOpThreads,                        nullptr);
+        tree.setProperty ("allowSpinning",     allowSpinning,                         nullptr);
+        tree.setProperty ("parallelExecution", parallelExecution,                     nullptr);
+        return tree;
+    }
+
+    /** Missing or invalid properties keep their defaults. */
+    static EngineThreading fromValueTree (const juce::ValueTree& tree)
+    {
+        EngineThreading t;
+
+        if (! tree.hasType (kStateType))
+            return t;
+
+        t.priority          = getPriority (tree.getProperty ("priority").toString(), t.priority);
+        t.realtimePriority  = juce::jlimit (0, 10, (int) tree.getProperty ("realtimePriority", t.realtimePriority));
+        t.affinityMask      = (uint32_t) tree.getProperty ("affinityMask").toString().getHexValue32();
+        t.intraOpThreads    = juce::jmax (0, (int) tree.getProperty ("intraOpThreads", t.intraOpThreads));
+        t.interOpThreads    = juce::jmax (0, (int) tree.getProperty ("interOpThreads", t.interOpThreads));
+        t.allowSpinning     = tree.getProperty ("allowSpinning", t.allowSpinning);
+        t.parallelExecution = tree.getProperty ("parallelExecution", t.parallelExecution);
+        return t;
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * processBlock's gain staging: a smoothed input gain before the model, and a
+ * dry/wet mix with a smoothed output gain after it.
+ *
+ * The three controls are juce::SmoothedValue ramps, so automation glides
+ * over kRampSeconds instead of stepping (zipper noise). Each block the ramps
+ * are advanced once into per-sample gain arrays shared by every channel;
+ * the per-channel work is then a single vectorised sweep:
+ *
+ *   processInput()    x  = in * inputGain                 (in place; x is also kept as the dry signal)
+ *   processOutput()   out = wet * (outputGain * mix) + dry * (outputGain * (1 - mix))
+ *
+ * The wet samples are read straight from the engine's result ring (both
+ * regions of an SpscFifo read), so there is no separate copy pass. The dry
+ * signal is delayed by the engine's latency, so dry and wet stay in time
+ * and a partial mix does not comb-filter.
+ *
+ * prepare() allocates; everything else is audio-thread safe.
+ */
+class GainMix
+{
+public:
+    /** Time a parameter change takes to reach its new value. */
+    static constexpr double kRampSeconds = 0.02;
+
+    /** Sizes the ramps and the dry delay line and jumps to the given gains
+        (linear) and mix (0 = dry, 1 = wet). Call from prepareToPlay. */
+    void prepare (double sampleRate, int numChannels, int maxBlockSize, int dryDelaySamples,
+                  float inputGain, float mix, float outputGain)
+    {
+        for (auto* smoother : { &inputGainSmoother, &mixSmoother, &outputGainSmoother })
+            smoother->reset (sampleRate, kRampSeconds);
+
+        inputGainSmoother .setCurrentAndTargetValue (inputGain);
+        mixSmoother       .setCurrentAndTargetValue (juce::jlimit (0.0f, 1.0f, mix));
+        outputGainSmoother.setCurrentAndTargetValue (outputGain);
+
+        const auto rampSize = (size_t) juce::jmax (1, maxBlockSize);
+        inputRamp .assign (rampSize, 0.0f);
+        outputRamp.assign (rampSize, 0.0f);
+        wetRamp   .assign (rampSize, 0.0f);
+        dryRamp   .assign (rampSize, 0.0f);
+
+        dryDelay = juce::jmax (0, dryDelaySamples);
+        dryLine.setSize (juce::jmax (1, numChannels), dryDelay + (int) rampSize);
+        dryLine.clear();
+        dryWritePos = dryReadPos = 0;
+    }
+
+    /** Where the controls should glide to. Call once per block, before
+        processInput(). */
+    void setTargets (float inputGain, float mix, float outputGain) noexcept
+    {
+        inputGainSmoother .setTargetValue (inputGain);
+        mixSmoother       .setTargetValue (juce::jlimit (0.0f, 1.0f, mix));
+        outputGainSmoother.setTargetValue (outputGain);
+    }
+
+    /** Applies the input gain in place and keeps the result as this block's
+        dry signal. */
+    void processInput (float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        jassert (numSamples <= (int) inputRamp.size());
+
+        const bool ramping = inputGainSmoother.isSmoothing();
+        const float gain = ramping ? 0.0f : inputGainSmoother.getTargetValue();
+
+        if (ramping)
+            for (int i = 0; i < numSamples; ++i)
+                inputRamp[(size_t) i] = inputGainSmoother.getNextValue();
+
+        const int lineSize = dryLine.getNumSamples();
+        const int firstPart = juce::jmin (numSamples, lineSize - dryWritePos);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const x = channels[ch];
+
+            if (ramping)
+                juce::FloatVectorOperations::multiply (x, inputRamp.data(), numSamples);
+            else if (gain != 1.0f)
+                juce::FloatVectorOperations::multiply (x, gain, numSamples);
+
+            if (ch < dryLine.getNumChannels())
+            {
+                float* const line = dryLine.getWritePointer (ch);
+                juce::FloatVectorOperations::copy (line + dryWritePos, x, firstPart);
+                juce::FloatVectorOperations::copy (line, x + firstPart, numSamples - firstPart);
+            }
+        }
+
+        // This block's dry samples line up with the wet ones dryDelay later.
+        dryReadPos  = (dryWritePos - dryDelay + lineSize) % lineSize;
+        dryWritePos = (dryWritePos + numSamples) % lineSize;
+    }
+
+    /** Mixes the wet result with the delayed dry signal into channels and
+        applies the output gain. The wet samples for channel ch are
+        wet[ch][start1 .. start1 + size1) followed by wet[ch][start2 .. start2
+        + size2); wet may be channels themselves (start1 = 0, size1 = the
+        block), as when a native model processed the block in place. */
+    void processOutput (float* const* channels, int numChannels, const juce::AudioBuffer<float>& wet,
+                        int start1, int size1, int start2, int size2) noexcept
+    {
+        const bool needsDry = advanceOutputRamps (size1 + size2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* const wetData = wet.getReadPointer (juce::jmin (ch, wet.getNumChannels() - 1));
+
+            mixSegment (channels[ch],         wetData + start1, ch, 0,     size1, needsDry);
+            mixSegment (channels[ch] + size1, wetData + start2, ch, size1, size2, needsDry);
+        }
+    }
+
+    /** Only the output gain, for a block the engine had no wet samples for:
+        the input passes straight through, as before mixing existed. */
+    void processOutputGainOnly (float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        advanceOutputRamps (numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::multiply (channels[ch], outputRamp.data(), numSamples);
+    }
+
+    int getDryDelaySamples() const noexcept { return dryDelay; }
+
+private:
+    /** Fills outputRamp, wetRamp and dryRamp for the next numSamples, and
+        says whether any dry signal is mixed in at all. */
+    bool advanceOutputRamps (int numSamples) noexcept
+    {
+        jassert (numSamples <= (int) outputRamp.size());
+
+        if (! outputGainSmoother.isSmoothing() && ! mixSmoother.isSmoothing())
+        {
+            const float gain = outputGainSmoother.getTargetValue();
+            const float mix  = mixSmoother.getTargetValue();
+
+            juce::FloatVectorOperations::fill (outputRamp.data(), gain,                numSamples);
+            juce::FloatVectorOperations::fill (wetRamp.data(),    gain * mix,          numSamples);
+            juce::FloatVectorOperations::fill (dryRamp.data(),    gain * (1.0f - mix), numSamples);
+            return mix < 1.0f;
+        }
+
+        bool anyDry = false;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float gain = outputGainSmoother.getNextValue();
+            const float mix  = mixSmoother.getNextValue();
+
+            outputRamp[(size_t) i] = gain;
+            wetRamp   [(size_t) i] = gain * mix;
+            dryRamp   [(size_t) i] = gain * (1.0f - mix);
+            anyDry = anyDry || mix < 1.0f;
+        }
+
+        return anyDry;
+    }
+
+    /** out[0, n) = wet * wetRamp + dry * dryRamp, for block samples
+        [offset, offset + n). out may be wet. */
+    void mixSegment (float* out, const float* wetData, int channel, int offset, int n, bool withDry) noexcept
+    {
+        if (n <= 0)
+            return;
+
+        juce::FloatVectorOperations::multiply (out, wetData, wetRamp.data() + offset, n);
+
+        if (! withDry)
+            return;
+
+        const float* const line = dryLine.getReadPointer (juce::jmin (channel, dryLine.getNumChannels() - 1));
+        const int lineSize = dryLine.getNumSamples();
+        int readPos = (dryReadPos + offset) % lineSize;
+
+        for (int done = 0; done < n;)
+        {
+            const int chunk = juce::jmin (n - done, lineSize - readPos);
+            juce::FloatVectorOperations::addWithMultiply (out + done, line + readPos,
+                                                          dryRamp.data() + offset + done, chunk);
+            done += chunk;
+            readPos = 0;
+        }
+    }
+
+    juce::SmoothedValue<float> inputGainSmoother, mixSmoother, outputGainSmoother;
+
+    // Per-sample values for the current block, shared by every channel.
+    std::vector<float> inputRamp, outputRamp, wetRamp, dryRamp;
+
+    // The gained input, delayed by the engine's latency before it is mixed.
+    juce::AudioBuffer<float> dryLine;
+    int dryDelay    { 0 };
+    int dryWritePos { 0 };
+    int dryReadPos  { 0 };
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * A model that runs directly on the audio thread, inside processBlock, instead
+ * of on the engine's inference thread. It processes audio in place sample by
+ * sample, so it adds no latency and needs no FIFOs or framing.
+ *
+ * prepare() is called off the audio thread and may allocate; reset() and
+ * process() are called on the audio thread and must not allocate, lock or
+ * block.
+ */
+class InferenceBackend
+{
+public:
+    virtual ~InferenceBackend() = default;
+
+    /** Sets up per-channel state for up to numChannels channels. */
+    virtual void prepare (int numChannels, int maxBlockSize) = 0;
+
+    /** Clears any recurrent or convolution history. */
+    virtual void reset() noexcept = 0;
+
+    /** Processes numChannels channels of numSamples in place. */
+    virtual void process (float* const* channels, int numChannels, int numSamples) noexcept = 0;
+
+    /** A short description for the editor and logs. */
+    virtual juce::String getDescription() const = 0;
+};
@@ -1,21 +1,122 @@
 #include "InferenceEngine.h"
+#include "NativeModel.h"
 
 #if MOJO_ONNX_ENABLED
   #include <onnxruntime_cxx_api.h>
+
+namespace
+{
+    /** A state tensor's declared shape with its dynamic batch dimension, if
+        any, set to the number of rows one Run processes. */
+    std::vector<int64_t> resolveBatch (std::vector<int64_t> shape, int rows)
+    {
+        for (auto& dim : shape)
+            if (dim < 0)
+                dim = rows;
+
+        return shape;
+    }
+
+    size_t elementCount (const std::vector<int64_t>& shape)
+    {
+        size_t count = 1;
+        for (auto dim : shape)
+            count *= (size_t) dim;
+
+        return count;
+    }
+
+    /** "Loaded amp.int8.onnx (int8, verified)". */
+    juce::String describeLoaded (const juce::File& onnxFile, const juce::String& variantNote)
+    {
+        return "Loaded " + onnxFile.getFileName() + (variantNote.isEmpty() ? juce::String() : " (" + variantNote + ")");
+    }
+}
 #endif
 
 //==============================================================================
 InferenceEngine::InferenceEngine()
     : juce::Thread ("InferenceEngine")
 {
-    startThread (juce::Thread::Priority::background);
+    startWorker (threading);
 }
 
 InferenceEngine::~InferenceEngine()
 {
     shouldStop.store (true);
-    inferenceWakeup.signal();
+    ++loadGeneration;
+    loader.removeAllJobs (true, 5000);
+
+    inferenceWakeup.wakeFromControlThread();
+    stopThread (2000);
+    unlinkChain();
+
+#if MOJO_ONNX_ENABLED
+    delete pendingModel.exchange (nullptr);
+#endif
+    delete pendingInline.exchange (nullptr);
+    clearWaitingModel();
+    collectRetiredModel();
+}
+
+//==============================================================================
+bool InferenceEngine::setThreading (const EngineThreading& newThreading)
+{
+    EngineThreading previous;
+    {
+        const juce::ScopedLock sl (threadingLock);
+        previous  = threading;
+        threading = newThreading;
+    }
+
+    for (auto& stage : chainStages)
+        stage->setThreading (newThreading);
+
+    if (! newThreading.threadDiffers (previous) && isThreadRunning())
+        return true;
+
+    // Priority class and affinity are only set when a thread starts.
+    signalThreadShouldExit();
+    inferenceWakeup.wakeFromControlThread();
     stopThread (2000);
+
+    return startWorker (newThreading);
+}
+
+EngineThreading InferenceEngine::getThreading() const
+{
+    const juce::ScopedLock sl (threadingLock);
+    return threading;
+}
+
+bool InferenceEngine::startWorker (const EngineThreading& settings)
+{
+    using Priority = EngineThreading::Priority;
+
+    setAffinityMask (settings.affinityMask);
+
+    if (settings.priority == Priority::realtime)
+    {
+        auto options = juce::Thread::RealtimeOptions{}.withPriority (settings.realtimePriority);
+
+        // One hop per period; only macOS uses it, to size the time constraint.
+        if (sampleRate > 0.0)
+            options = options.withPeriodHz ((resampling ? (double) modelRate : sampleRate) / (double) hopSize);
+
+        if (startRealtimeThread (options))
+            return true;
+
+        DBG ("Realtime inference thread refused, running at normal priority");
+        startThread (juce::Thread::Priority::normal);
+        return false;
+    }
+
+    const auto priority = settings.priority == Priority::highest ? juce::Thread::Priority::highest
+                        : settings.priority == Priority::high    ? juce::Thread::Priority::high
+                        : settings.priority == Priority::normal  ? juce::Thread::Priority::normal
+                        : settings.priority == Priority::low     ? juce::Thread::Priority::low
+                                                                 : juce::Thread::Priority::background;
+    return startThread (priority);
 }
 
 //==============================================================================
@@ -25,144 +126,2079 @@ bool InferenceEngine::loadModel (const juce::File& modelFile)
     jassert (! juce::MessageManager::getInstance()->isThisTheMessageThread() ||
                juce::MessageManager::existsAndIsCurrentThread());
 
+    // Supersedes any background load still in flight.
+    ++loadGeneration;
+
     if (! modelFile.existsAsFile())
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Model not found: " + modelFile.getFullPathName());
+        return false;
+    }
+
+    juce::String nativeError;
+    if (auto backend = createInlineBackend (modelFile, nativeError))
+    {
+        const juce::ScopedLock sl (frameLock);
+        adoptInlineBackend (std::move (backend));
+        setLoadStatus (LoadState::ready, 1.0f, "Loaded " + modelFile.getFileName() + " (native)");
+        return true;
+    }
+
+    if (backendChoice.load() == Backend::native)
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Cannot run natively: " + nativeError);
         return false;
+    }
 
 #if MOJO_ONNX_ENABLED
     try
     {
-        ortEnv     = std::make_unique<Ort::Env> (ORT_LOGGING_LEVEL_WARNING, "MojoInsects");
-        Ort::SessionOptions sessionOptions;
-        sessionOptions.SetIntraOpNumThreads (1);
-        sessionOptions.SetGraphOptimizationLevel (GraphOptimizationLevel::ORT_ENABLE_ALL);
+        juce::String variantNote;
+        const auto onnxFile = ModelVariants::select (modelFile, precisionChoice.load(), variantNote);
+
+        auto newModel = createModel (onnxFile);
+        if (newModel == nullptr)
+        {
+            setLoadStatus (LoadState::failed, 0.0f, "Cannot read " + onnxFile.getFullPathName());
+            return false;
+        }
 
-       #if JUCE_WINDOWS
-        ortSession = std::make_unique<Ort::Session> (
-            *ortEnv, modelFile.getFullPathName().toWideCharPointer(), sessionOptions);
-       #else
-        ortSession = std::make_unique<Ort::Session> (
-            *ortEnv, modelFile.getFullPathName().toRawUTF8(), sessionOptions);
-       #endif
+        {
+            const juce::ScopedLock sl (frameLock);
+            adoptModel (std::move (newModel));
+        }
 
-        modelLoaded.store (true);
+        setLoadStatus (LoadState::ready, 1.0f, describeLoaded (onnxFile, variantNote));
         return true;
     }
     catch (const Ort::Exception& e)
     {
         DBG ("ONNX load failed: " << e.what());
+        setLoadStatus (LoadState::failed, 0.0f, e.what());
         return false;
     }
 #else
     // ONNX not compiled in — mark as ready so the passthrough path works.
+    {
+        const juce::ScopedLock sl (frameLock);
+        dropInlineBackend();
+    }
+
     modelLoaded.store (true);
+    setLoadStatus (LoadState::ready, 1.0f, "Passthrough (ONNX Runtime not built in)");
     return true;
 #endif
 }
 
-//==============================================================================
-void InferenceEngine::submitInput (const float* data, int numSamples)
+bool InferenceEngine::loadModel (const void* modelData, size_t numBytes, const juce::String& name)
 {
-    // Audio thread: lock-free write into inputFifo.
-    const int toWrite = juce::jmin (numSamples, inputFifo.getFreeSpace());
-    if (toWrite == 0)
-        return;
+    ++loadGeneration;
 
-    const auto scope = inputFifo.write (toWrite);
-    juce::FloatVectorOperations::copy (inputBuffer.data() + scope.startIndex1,
-                                       data, scope.blockSize1);
-    if (scope.blockSize2 > 0)
-        juce::FloatVectorOperations::copy (inputBuffer.data() + scope.startIndex2,
-                                           data + scope.blockSize1, scope.blockSize2);
+    if (modelData == nullptr || numBytes == 0)
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Empty model: " + name);
+        return false;
+    }
+
+    juce::String nativeError;
+    if (auto backend = createInlineBackend (modelData, numBytes, nativeError))
+    {
+        const juce::ScopedLock sl (frameLock);
+        adoptInlineBackend (std::move (backend));
+        setLoadStatus (LoadState::ready, 1.0f, "Loaded " + name + " (native)");
+        return true;
+    }
+
+    if (backendChoice.load() == Backend::native)
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Cannot run natively: " + nativeError);
+        return false;
+    }
+
+#if MOJO_ONNX_ENABLED
+    try
+    {
+        auto newModel = createModel (modelData, numBytes);
+
+        {
+            const juce::ScopedLock sl (frameLock);
+            adoptModel (std::move (newModel));
+        }
+
+        setLoadStatus (LoadState::ready, 1.0f, "Loaded " + name);
+        return true;
+    }
+    catch (const Ort::Exception& e)
+    {
+        DBG ("ONNX load failed: " << e.what());
+        setLoadStatus (LoadState::failed, 0.0f, e.what());
+        return false;
+    }
+#else
+    {
+        const juce::ScopedLock sl (frameLock);
+        dropInlineBackend();
+    }
 
-    inferenceWakeup.signal();
+    modelLoaded.store (true);
+    setLoadStatus (LoadState::ready, 1.0f, "Passthrough (ONNX Runtime not built in)");
+    return true;
+#endif
 }
 
-void InferenceEngine::setOutputFifo (juce::AbstractFifo* fifo, float* buffer) noexcept
+bool InferenceEngine::loadFallbackModel (const juce::File& modelFile)
 {
-    outputFifo = fifo;
-    outputBuf  = buffer;
+#if MOJO_ONNX_ENABLED
+    std::unique_ptr<Model> fallback;
+
+    if (modelFile != juce::File())
+    {
+        try
+        {
+            juce::String variantNote;
+            fallback = createModel (ModelVariants::select (modelFile, precisionChoice.load(), variantNote));
+        }
+        catch (const Ort::Exception& e)
+        {
+            DBG ("ONNX fallback load failed: " << e.what());
+        }
+
+        if (fallback == nullptr)
+            return false;
+    }
+
+    const juce::ScopedLock sl (frameLock);
+
+    if (fallback != nullptr && ! fitsFraming (*fallback))
+        return false;
+
+    fallbackModel = std::move (fallback);
+    configureFrames();   // binds it and tells the scheduler it can reduce
+    return true;
+#else
+    juce::ignoreUnused (modelFile);
+    return false;
+#endif
 }
 
-//==============================================================================
-// Inference thread body — never runs on the audio thread.
-void InferenceEngine::run()
+bool InferenceEngine::loadModelChain (const juce::Array<juce::File>& modelFiles)
 {
-    while (! threadShouldExit())
+    if (modelFiles.isEmpty())
+        return false;
+
+    if (modelFiles.size() > 1 && backendChoice.load() == Backend::native)
     {
-        inferenceWakeup.wait (100);
+        setLoadStatus (LoadState::failed, 0.0f, "A model chain cannot run on the native backend");
+        return false;
+    }
 
-        if (threadShouldExit())
-            break;
+    // Every model after the first gets a stage engine, set up like this one.
+    std::vector<std::unique_ptr<InferenceEngine>> stages;
 
-        const int available = inputFifo.getNumReady();
-        if (available == 0 || outputFifo == nullptr)
-            continue;
+    for (int i = 1; i < modelFiles.size(); ++i)
+    {
+        auto stage = std::make_unique<InferenceEngine>();
+        stage->setThreading (getThreading());
+        stage->setPrecision (getPrecision());
+        stage->setBackend (Backend::onnxRuntime);
+        stage->setOfflineMode (isOfflineMode());
 
-        // Read from input FIFO.
-        std::vector<float> inputData ((size_t) available);
+        if (! stage->loadModel (modelFiles[i]))
         {
-            const auto scope = inputFifo.read (available);
-            juce::FloatVectorOperations::copy (inputData.data(),
-                                               inputBuffer.data() + scope.startIndex1,
-                                               scope.blockSize1);
-            if (scope.blockSize2 > 0)
-                juce::FloatVectorOperations::copy (inputData.data() + scope.blockSize1,
-                                                   inputBuffer.data() + scope.startIndex2,
-                                                   scope.blockSize2);
+            setLoadStatus (LoadState::failed, 0.0f, "Chain stage " + juce::String (i + 1) + ": "
+                                                        + stage->getLoadStatus().message);
+            return false;
         }
 
-        // Run inference (or passthrough if not loaded).
-        std::vector<float> outputData (inputData.size());
+        stages.push_back (std::move (stage));
+    }
+
+    // The first model runs here, on ORT too when it feeds a stage: the
+    // native backend would process blocks in place and never reach it.
+    const auto chosenBackend = backendChoice.load();
+    if (! stages.empty())
+        backendChoice.store (Backend::onnxRuntime);
 
-#if MOJO_ONNX_ENABLED
-        if (modelLoaded.load() && ortSession)
-        {
-            try
-            {
-                Ort::AllocatorWithDefaultOptions allocator;
-                auto memInfo = Ort::MemoryInfo::CreateCpu (
-                    OrtArenaAllocator, OrtMemTypeDefault);
+    const bool loaded = loadModel (modelFiles[0]);
+    backendChoice.store (chosenBackend);
+
+    if (! loaded)
+        return false;
+
+    // The old stages are torn down once unlinked, outside the lock.
+    unlinkChain();
+    auto previousStages = std::move (chainStages);
+
+    {
+        const juce::ScopedLock sl (frameLock);
+        chainStages = std::move (stages);
+
+        for (size_t i = 0; i + 1 < chainStages.size(); ++i)
+            chainStages[i]->setDownstream (chainStages[i + 1].get());
+
+        if (! chainStages.empty())
+            chainStages.back()->setOutputFifo (outputFifo, outputBuf);
+
+        downstream = chainStages.empty() ? nullptr : chainStages.front().get();
+
+        if (maxBlockSize > 0)
+            prepare (numChannels, maxBlockSize, sampleRate);
+    }
+
+    if (! chainStages.empty())
+    {
+        juce::StringArray names;
+        for (const auto& file : modelFiles)
+            names.add (file.getFileName());
+
+        setLoadStatus (LoadState::ready, 1.0f, "Loaded chain " + names.joinIntoString (" -> "));
+    }
+
+    return true;
+}
+
+// Points this engine's finished hops at next's input, or back at the output
+// FIFO when next is null. Waits for a hop in flight to finish first.
+void InferenceEngine::setDownstream (InferenceEngine* next)
+{
+    const juce::ScopedLock sl (frameLock);
+    downstream = next;
+}
 
-                const int64_t inputShape[] = { 1, (int64_t) inputData.size() };
-                auto inputTensor = Ort::Value::CreateTensor<float> (
-                    memInfo, inputData.data(), inputData.size(),
-                    inputShape, 2);
+// Cuts every link of the chain, so its stages can be destroyed in any order.
+void InferenceEngine::unlinkChain()
+{
+    setDownstream (nullptr);
+
+    for (auto& stage : chainStages)
+        stage->setDownstream (nullptr);
+}
+
+void InferenceEngine::loadModelAsync (const juce::File& modelFile)
+{
+    const int generation = ++loadGeneration;
+
+    setLoadStatus (LoadState::loading, 0.0f, "Queued " + modelFile.getFileName());
+    loader.addJob ([this, modelFile, generation] { loadInBackground (modelFile, generation); });
+}
+
+InferenceEngine::LoadStatus InferenceEngine::getLoadStatus() const
+{
+    const juce::ScopedLock sl (statusLock);
+    return loadStatus;
+}
+
+void InferenceEngine::setLoadStatus (LoadState state, float progress, const juce::String& message)
+{
+    const juce::ScopedLock sl (statusLock);
+    loadStatus = { state, progress, message };
+}
+
+// Loader thread. Everything slow — reading the file, building the session,
+// the first Run — happens here with no locks held.
+void InferenceEngine::loadInBackground (juce::File modelFile, int generation)
+{
+    const auto superseded = [this, generation]
+    {
+        return shouldStop.load() || generation != loadGeneration.load();
+    };
 
-                const char* inputNames[]  = { "input"  };
-                const char* outputNames[] = { "output" };
+    const auto refuseBackendChange = [&modelFile, this]
+    {
+        setLoadStatus (LoadState::failed, 0.0f,
+                       modelFile.getFileName() + " runs on a different backend with a different latency"
+                                                 "; load it while stopped");
+    };
+
+    collectRetiredModel();
+
+    if (superseded())
+        return;
+
+    // An older load still waiting for the next prepare() is superseded too.
+    clearWaitingModel();
+
+    if (! modelFile.existsAsFile())
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Model not found: " + modelFile.getFullPathName());
+        return;
+    }
+
+    setLoadStatus (LoadState::loading, 0.1f, "Loading " + modelFile.getFileName());
+
+    juce::String nativeError;
+    if (auto backend = createInlineBackend (modelFile, nativeError))
+    {
+        {
+            const juce::ScopedLock sl (frameLock);
 
-                auto outputTensors = ortSession->Run (
-                    Ort::RunOptions { nullptr },
-                    inputNames,  &inputTensor,  1,
-                    outputNames, 1);
+            if (superseded())
+                return;
+
+            if (! isPlaying())
+            {
+                adoptInlineBackend (std::move (backend));
+                setLoadStatus (LoadState::ready, 1.0f, "Loaded " + modelFile.getFileName() + " (native)");
+                return;
+            }
 
-                const float* result = outputTensors[0].GetTensorData<float>();
-                std::copy (result, result + outputData.size(), outputData.begin());
+            if (! runsInline() && onReprepareNeeded != nullptr)
+            {
+                // It takes over at the next prepare(), which the owner
+                // arranges now, or at release().
+                clearWaitingModel();
+                waitingInline.store (backend.release());
+            }
+            else if (! runsInline())
+            {
+                return refuseBackendChange();
             }
-            catch (const Ort::Exception& e)
+            else
             {
-                DBG ("Inference error: " << e.what());
-                outputData = inputData; // passthrough on error
+                backend->prepare (numChannels, maxBlockSize);
             }
         }
-        else
-#endif
+
+        if (backend == nullptr)
         {
-            outputData = inputData; // passthrough
+            setLoadStatus (LoadState::ready, 1.0f, "Loaded " + modelFile.getFileName() + " (native), restarting playback");
+            onReprepareNeeded();
+            return;
         }
 
-        // Write results to output FIFO (read by processBlock).
-        const int toWrite = juce::jmin ((int) outputData.size(),
-                                        outputFifo->getFreeSpace());
-        if (toWrite > 0)
+        setLoadStatus (LoadState::swapping, 0.9f, "Swapping in " + modelFile.getFileName());
+
+        auto* const published = backend.release();
+        delete pendingInline.exchange (published);
+
+        // processInline() picks it up at the start of the next block.
+        while (pendingInline.load() == published && ! superseded())
+            juce::Thread::sleep (5);
+
+        if (superseded())
+            return;
+
+        setLoadStatus (LoadState::ready, 1.0f, "Loaded " + modelFile.getFileName() + " (native)");
+
+        for (int waited = 0; waited < 1000 && ! superseded() && ! collectRetiredModel(); waited += 10)
+            juce::Thread::sleep (10);
+
+        return;
+    }
+
+    if (backendChoice.load() == Backend::native)
+    {
+        setLoadStatus (LoadState::failed, 0.0f, "Cannot run natively: " + nativeError);
+        return;
+    }
+
+#if MOJO_ONNX_ENABLED
+    std::unique_ptr<Model> newModel;
+    juce::File onnxFile;
+    juce::String variantNote;
+
+    try
+    {
+        // Picking a variant automatically verifies it first, which takes a
+        // couple of offline renders.
+        if (precisionChoice.load() == ModelVariants::Precision::automatic)
+            setLoadStatus (LoadState::loading, 0.2f, "Verifying variants of " + modelFile.getFileName());
+
+        onnxFile = ModelVariants::select (modelFile, precisionChoice.load(), variantNote);
+
+        if (superseded())
+            return;
+
+        newModel = createModel (onnxFile);
+        if (newModel == nullptr)
         {
-            const auto scope = outputFifo->write (toWrite);
-            juce::FloatVectorOperations::copy (outputBuf + scope.startIndex1,
-                                               outputData.data(), scope.blockSize1);
-            if (scope.blockSize2 > 0)
-                juce::FloatVectorOperations::copy (outputBuf + scope.startIndex2,
-                                                   outputData.data() + scope.blockSize1,
-                                                   scope.blockSize2);
+            setLoadStatus (LoadState::failed, 0.0f, "Cannot read " + onnxFile.getFullPathName());
+            return;
         }
+
+        if (superseded())
+            return;
+
+        setLoadStatus (LoadState::warmingUp, 0.6f, "Warming up " + modelFile.getFileName());
+
+        int currentWindow;
+        {
+            const juce::ScopedLock sl (frameLock);
+            currentWindow = windowSize;
+        }
+
+        // ORT does much of its lazy setup on the first Run; pay for it here.
+        warmUp (*newModel, newModel->window > 0 ? newModel->window : currentWindow);
     }
-}
+    catch (const Ort::Exception& e)
+    {
+        DBG ("ONNX load failed: " << e.what());
+        setLoadStatus (LoadState::failed, 0.0f, e.what());
+        return;
+    }
+
+    if (superseded())
+        return;
+
+    {
+        const juce::ScopedLock sl (frameLock);
+
+        if (! isPlaying())
+        {
+            // Not playing: nothing to crossfade, take it over directly.
+            adoptModel (std::move (newModel));
+            setLoadStatus (LoadState::ready, 1.0f, describeLoaded (onnxFile, variantNote));
+            return;
+        }
+
+        if ((runsInline() || ! fitsFraming (*newModel)) && onReprepareNeeded != nullptr)
+        {
+            // It takes over at the next prepare(), which the owner arranges
+            // now, or at release().
+            delete pendingModel.exchange (nullptr);
+            clearWaitingModel();
+            waitingModel.store (newModel.release());
+        }
+        else if (runsInline())
+        {
+            return refuseBackendChange();
+        }
+        else if (! fitsFraming (*newModel))
+        {
+            const auto needs = newModel->spectral != modelSpectral ? juce::String ("the other signal domain")
+                             : newModel->sampleRate != modelRate
+                                 ? (newModel->sampleRate > 0 ? "to run at " + juce::String (newModel->sampleRate) + " Hz"
+                                                             : juce::String ("to run at the session's rate"))
+                             : newModel->window > 0 && newModel->window != windowSize
+                                 ? "a " + juce::String (newModel->window) + "-sample window"
+                                 : "a " + juce::String (newModel->hop) + "-sample hop";
+
+            setLoadStatus (LoadState::failed, 0.0f,
+                           modelFile.getFileName() + " needs " + needs + " but playback runs at a "
+                             + juce::String (windowSize) + "-sample window and " + juce::String (hopSize)
+                             + "-sample hop; load it while stopped");
+            return;
+        }
+        else
+        {
+            bindModel (*newModel);
+        }
+    }
+
+    if (newModel == nullptr)
+    {
+        setLoadStatus (LoadState::ready, 1.0f, describeLoaded (onnxFile, variantNote) + ", restarting playback");
+        onReprepareNeeded();
+        return;
+    }
+
+    setLoadStatus (LoadState::swapping, 0.9f, "Swapping in " + modelFile.getFileName());
+
+    const auto newControls = newModel->controls;
+    auto* const published = newModel.release();
+    delete pendingModel.exchange (published); // an older one that never went live
+
+    // Wait for the inference thread to pick it up between two frames (or
+    // prepare() to adopt it), then free whatever it faded out.
+    while (pendingModel.load() == published && ! superseded())
+        juce::Thread::sleep (5);
+
+    if (superseded())
+        return;
+
+    {
+        // The playing control values carry over; only their meaning changes.
+        const juce::ScopedLock sl (statusLock);
+        activeControls = newControls;
+    }
+
+    setLoadStatus (LoadState::ready, 1.0f, describeLoaded (onnxFile, variantNote));
+
+    for (int waited = 0; waited < 1000 && ! superseded() && ! collectRetiredModel(); waited += 10)
+        juce::Thread::sleep (10);
+#else
+    {
+        const juce::ScopedLock sl (frameLock);
+
+        if (isPlaying() && runsInline())
+            return refuseBackendChange();
+
+        dropInlineBackend();
+    }
+
+    modelLoaded.store (true);
+    setLoadStatus (LoadState::ready, 1.0f, "Passthrough (ONNX Runtime not built in)");
+#endif
+}
+
+// The native backend for modelFile, or nullptr (with the reason) when the
+// backend choice or the graph rules it out.
+std::unique_ptr<InferenceBackend> InferenceEngine::createInlineBackend (const juce::File& modelFile,
+                                                                        juce::String& error) const
+{
+    if (backendChoice.load() == Backend::onnxRuntime)
+    {
+        error = "ONNX Runtime backend selected";
+        return nullptr;
+    }
+
+    if (! chainStages.empty())
+    {
+        error = "the model heads a chain";
+        return nullptr;
+    }
+
+    const juce::MemoryMappedFile bytes (modelFile, juce::MemoryMappedFile::readOnly);
+    if (bytes.getData() == nullptr || bytes.getSize() == 0)
+    {
+        error = "cannot read " + modelFile.getFileName();
+        return nullptr;
+    }
+
+    return createInlineBackend (bytes.getData(), bytes.getSize(), error);
+}
+
+std::unique_ptr<InferenceBackend> InferenceEngine::createInlineBackend (const void* modelData, size_t numBytes,
+                                                                        juce::String& error) const
+{
+    if (backendChoice.load() == Backend::onnxRuntime)
+    {
+        error = "ONNX Runtime backend selected";
+        return nullptr;
+    }
+
+    if (! chainStages.empty())
+    {
+        error = "the model heads a chain";
+        return nullptr;
+    }
+
+    if (auto nativeModel = NativeModel::fromMemory (modelData, numBytes, error))
+        return std::make_unique<NativeBackend> (std::move (nativeModel));
+
+    return nullptr;
+}
+
+// Makes backend the active model outright, replacing any ORT model, and
+// prepares it if the engine already is. Called with frameLock held, from
+// outside processInline().
+void InferenceEngine::adoptInlineBackend (std::unique_ptr<InferenceBackend> backend)
+{
+    clearWaitingModel();
+
+#if MOJO_ONNX_ENABLED
+    delete pendingModel.exchange (nullptr);
+    fadingModel.reset();
+    model.reset();
+    modelWindow   = 0;
+    modelHop      = 0;
+    modelSpectral = false;
+    modelRate     = 0;
+#endif
+    crossfadeFrame = crossfadeFrames = 0;
+
+    delete pendingInline.exchange (nullptr);
+    fadingInline.reset();
+    inlineBackend = std::move (backend);
+    resetControls ({});
+
+    if (maxBlockSize > 0)
+        inlineBackend->prepare (numChannels, maxBlockSize);
+
+    inlineActive.store (true);
+    modelLoaded.store (true);
+    configureFrames();
+    updateLatency();
+}
+
+// Back to the framed pipeline. Called with frameLock held.
+void InferenceEngine::dropInlineBackend()
+{
+    delete pendingInline.exchange (nullptr);
+    fadingInline.reset();
+    inlineBackend.reset();
+    inlineActive.store (false);
+    updateLatency();
+}
+
+// Frees the models the inference thread or processInline() last faded out,
+// if any. Never called on either of those threads. Returns true if there was one.
+bool InferenceEngine::collectRetiredModel()
+{
+    std::unique_ptr<InferenceBackend> retiredBackend (retiredInline.exchange (nullptr));
+    bool collected = retiredBackend != nullptr;
+
+#if MOJO_ONNX_ENABLED
+    std::unique_ptr<Model> retired (retiredModel.exchange (nullptr));
+    collected = collected || retired != nullptr;
+#endif
+
+    return collected;
+}
+
+#if MOJO_ONNX_ENABLED
+// Builds a model's session and reads its declared shape. Throws
+// Ort::Exception; returns nullptr if the file cannot be read.
+std::unique_ptr<InferenceEngine::Model> InferenceEngine::createModel (const juce::File& modelFile)
+{
+    // Shared with every other instance that has the same model loaded.
+    auto session = sessionCache->acquire (modelFile, getThreading());
+    if (session == nullptr)
+        return nullptr;
+
+    auto newModel = createModel (std::move (session));
+    newModel->file = modelFile;
+
+    // Loaded during a render: build its offline session now, off the audio
+    // and inference threads and outside frameLock.
+    if (offlineMode.load())
+        newModel->offlineSession = acquireOfflineSession (modelFile, nullptr, 0);
+
+    return newModel;
+}
+
+std::unique_ptr<InferenceEngine::Model> InferenceEngine::createModel (const void* modelData, size_t numBytes)
+{
+    auto newModel = createModel (sessionCache->acquire (modelData, numBytes, getThreading()));
+    newModel->data     = modelData;
+    newModel->numBytes = numBytes;
+
+    if (offlineMode.load())
+        newModel->offlineSession = acquireOfflineSession ({}, modelData, numBytes);
+
+    return newModel;
+}
+
+// The render session for a model: the same graph with every physical core
+// for intra-op work. Instances bouncing the same model share it. Runs the
+// optimiser if no other instance has it, so never call it under frameLock.
+// Returns nullptr if ORT refuses, and the render then runs single-threaded.
+std::shared_ptr<Ort::Session> InferenceEngine::acquireOfflineSession (const juce::File& modelFile, const void* modelData,
+                                                                     size_t numBytes) const
+{
+    try
+    {
+        auto threads = getThreading();
+        threads.intraOpThreads = juce::SystemStats::getNumPhysicalCpus();
+
+        return modelData != nullptr ? sessionCache->acquire (modelData, numBytes, threads)
+                                    : sessionCache->acquire (modelFile, threads);
+    }
+    catch (const Ort::Exception& e)
+    {
+        DBG ("ONNX offline session failed, rendering single-threaded: " << e.what());
+        return nullptr;
+    }
+}
+
+// Reads the declared shape and state tensors of a model's session.
+std::unique_ptr<InferenceEngine::Model> InferenceEngine::createModel (std::shared_ptr<Ort::Session> session)
+{
+    jassert (session != nullptr);
+
+    Ort::AllocatorWithDefaultOptions allocator;
+
+    std::vector<std::string> inputNames, outputNames;
+    for (size_t i = 0; i < session->GetInputCount(); ++i)
+        inputNames.emplace_back (session->GetInputNameAllocated (i, allocator).get());
+    for (size_t i = 0; i < session->GetOutputCount(); ++i)
+        outputNames.emplace_back (session->GetOutputNameAllocated (i, allocator).get());
+
+    const auto indexOf = [] (const std::vector<std::string>& names, const std::string& name)
+    {
+        return (size_t) std::distance (names.begin(), std::find (names.begin(), names.end(), name));
+    };
+
+    const auto audioInput = indexOf (inputNames, "input");
+    if (audioInput == inputNames.size() || indexOf (outputNames, "output") == outputNames.size())
+        throw Ort::Exception ("model needs an \"input\" and an \"output\" tensor", ORT_INVALID_ARGUMENT);
+
+    const auto metadata = session->GetModelMetadata();
+
+    const auto lookup = [&metadata, &allocator] (const char* key)
+    {
+        auto value = metadata.LookupCustomMetadataMapAllocated (key, allocator);
+        return value != nullptr ? juce::String (value.get()) : juce::String();
+    };
+
+    // Run on the model's own window length (and batch size) when it declares
+    // static ones. Dynamic dimensions are reported as -1.
+    const auto inputShape = session->GetInputTypeInfo (audioInput)
+                                   .GetTensorTypeAndShapeInfo().GetShape();
+    auto declaredWindow      = inputShape.empty()    ? int64_t { -1 } : inputShape.back();
+    const auto declaredBatch = inputShape.size() < 2 ? int64_t { -1 } : inputShape.front();
+
+    // A spectral model's window is its FFT size; its tensors hold
+    // [batch, 2, bins] magnitude/phase rows.
+    const int fftSize = lookup ("mojo.fft_size").getIntValue();
+    const bool spectral = fftSize > 0;
+
+    if (spectral)
+    {
+        const auto bins = (int64_t) (fftSize / 2 + 1);
+
+        if (! juce::isPowerOfTwo (fftSize) || fftSize < 4 || inputShape.size() != 3
+             || inputShape[1] != 2 || (inputShape[2] > 0 && inputShape[2] != bins))
+            throw Ort::Exception ("a spectral model needs a power-of-two mojo.fft_size and a [batch, 2, "
+                                    + std::to_string (bins) + "] input", ORT_INVALID_ARGUMENT);
+
+        declaredWindow = fftSize;
+    }
+
+    const int declaredHop = lookup ("mojo.hop").getIntValue();
+
+    if (declaredHop < 0 || (declaredHop > 0 && declaredWindow > 0 && declaredWindow % declaredHop != 0)
+         || (spectral && declaredHop > fftSize / 2))
+        throw Ort::Exception (spectral ? "mojo.hop must divide mojo.fft_size at least twice"
+                                       : "mojo.hop must divide the window",
+                              ORT_INVALID_ARGUMENT);
+
+    // A model trained at one rate runs at it, whatever the session's; see
+    // configureFrames().
+    const int declaredRate = lookup ("mojo.sample_rate").getIntValue();
+
+    if (declaredRate < 0)
+        throw Ort::Exception ("mojo.sample_rate must be a rate in Hz", ORT_INVALID_ARGUMENT);
+
+    // A "controls" input conditions the model (see ModelControls): float
+    // [batch, controls] or [batch, controls, window], with a static number
+    // of controls.
+    ModelControls controls;
+
+    if (const auto controlsInput = indexOf (inputNames, "controls"); controlsInput < inputNames.size())
+    {
+        const auto info  = session->GetInputTypeInfo (controlsInput).GetTensorTypeAndShapeInfo();
+        const auto shape = info.GetShape();
+        const bool perSample = shape.size() == 3;
+
+        if (info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT
+             || (shape.size() != 2 && ! perSample)
+             || shape[1] < 1 || shape[1] > ModelControls::kMaxControls
+             || (shape[0] > 0 && shape[0] != declaredBatch)
+             || (perSample && shape[2] > 0 && shape[2] != declaredWindow))
+            throw Ort::Exception ("\"controls\" must be float [batch, 1.." + std::to_string (ModelControls::kMaxControls)
+                                    + "] or [batch, controls, window] with the input's batch and window",
+                                  ORT_INVALID_ARGUMENT);
+
+        controls = ModelControls::parse (lookup ("mojo.controls"), (int) shape[1], perSample);
+    }
+
+    // Everything else is recurrent state, paired explicitly through metadata
+    // or else in declaration order.
+    std::vector<std::pair<std::string, std::string>> statePairs;
+
+    if (auto declared = metadata.LookupCustomMetadataMapAllocated ("mojo.state", allocator))
+    {
+        for (const auto& pair : juce::StringArray::fromTokens (declared.get(), ",", {}))
+            if (pair.contains (":"))
+                statePairs.emplace_back (pair.upToFirstOccurrenceOf (":", false, false).trim().toStdString(),
+                                         pair.fromFirstOccurrenceOf (":", false, false).trim().toStdString());
+    }
+    else
+    {
+        std::vector<std::string> stateInputs, stateOutputs;
+        std::copy_if (inputNames.begin(),  inputNames.end(),  std::back_inserter (stateInputs),
+                      [] (const std::string& n) { return n != "input" && n != "controls"; });
+        std::copy_if (outputNames.begin(), outputNames.end(), std::back_inserter (stateOutputs),
+                      [] (const std::string& n) { return n != "output"; });
+
+        if (stateInputs.size() != stateOutputs.size())
+            throw Ort::Exception ("model has " + std::to_string (stateInputs.size()) + " state inputs but "
+                                    + std::to_string (stateOutputs.size()) + " state outputs",
+                                  ORT_INVALID_ARGUMENT);
+
+        for (size_t i = 0; i < stateInputs.size(); ++i)
+            statePairs.emplace_back (stateInputs[i], stateOutputs[i]);
+    }
+
+    std::vector<StateTensor> states;
+
+    for (const auto& [stateIn, stateOut] : statePairs)
+    {
+        const auto index = indexOf (inputNames, stateIn);
+        if (index == inputNames.size() || indexOf (outputNames, stateOut) == outputNames.size())
+            throw Ort::Exception ("unknown state tensor pair " + stateIn + ":" + stateOut, ORT_INVALID_ARGUMENT);
+
+        const auto info = session->GetInputTypeInfo (index).GetTensorTypeAndShapeInfo();
+        auto shape = info.GetShape();
+
+        if (info.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT
+             || std::count (shape.begin(), shape.end(), int64_t { -1 }) > 1)
+            throw Ort::Exception ("state " + stateIn + " must be float with at most one dynamic (batch) dimension",
+                                  ORT_INVALID_ARGUMENT);
+
+        states.push_back ({ stateIn, stateOut, std::move (shape) });
+    }
+
+    auto newModel = std::make_unique<Model>();
+    newModel->session  = std::move (session);
+    newModel->window   = declaredWindow > 0 ? (int) declaredWindow : 0;
+    newModel->batch    = declaredBatch  > 0 ? (int) declaredBatch  : 0;
+    newModel->hop      = declaredHop;
+    newModel->sampleRate = declaredRate;
+    newModel->spectral = spectral;
+    newModel->states   = std::move (states);
+    newModel->controls = std::move (controls);
+    return newModel;
+}
+
+// Makes newModel the active one outright, with no crossfade, and reframes
+// around it. Called with frameLock held, from outside the inference loop.
+void InferenceEngine::adoptModel (std::unique_ptr<Model> newModel)
+{
+    delete pendingModel.exchange (nullptr);
+    clearWaitingModel();
+    fadingModel.reset();
+    crossfadeFrame = crossfadeFrames = 0;
+
+    dropInlineBackend();
+
+    model         = std::move (newModel);
+    modelWindow   = model->window;
+    modelHop      = model->hop;
+    modelSpectral = model->spectral;
+    modelRate     = model->sampleRate;
+    resetControls (model->controls);
+
+    configureFrames();
+    updateLatency();
+    modelLoaded.store (true);
+}
+
+void InferenceEngine::warmUp (Model& target, int window)
+{
+    const int rows = target.batch > 0 ? target.batch : 1;
+    const int bins = window / 2 + 1;
+    const int64_t timeShape[]     = { (int64_t) rows, (int64_t) window };
+    const int64_t spectralShape[] = { (int64_t) rows, 2, (int64_t) bins };
+    const auto* shape = target.spectral ? spectralShape : timeShape;
+    const size_t shapeRank = target.spectral ? 3 : 2;
+
+    std::vector<float> input ((size_t) (rows * (target.spectral ? 2 * bins : window)), 0.0f), output (input.size());
+
+    auto memInfo = Ort::MemoryInfo::CreateCpu (OrtArenaAllocator, OrtMemTypeDefault);
+    auto in  = Ort::Value::CreateTensor<float> (memInfo, input.data(),  input.size(),  shape, shapeRank);
+    auto out = Ort::Value::CreateTensor<float> (memInfo, output.data(), output.size(), shape, shapeRank);
+
+    Ort::IoBinding binding (*target.session);
+    binding.BindInput  ("input",  in);
+    binding.BindOutput ("output", out);
+
+    // Controls at their defaults.
+    std::vector<float> controlDefaults;
+    std::optional<Ort::Value> controlsTensor;
+
+    if (! target.controls.isEmpty())
+    {
+        const int count = target.controls.size();
+        const int perControl = target.controls.perSample ? window : 1;
+        const int64_t controlShape[] = { (int64_t) rows, (int64_t) count, (int64_t) window };
+
+        for (int row = 0; row < rows; ++row)
+            for (const auto& control : target.controls.controls)
+                controlDefaults.insert (controlDefaults.end(), (size_t) perControl, control.defaultValue);
+
+        controlsTensor = Ort::Value::CreateTensor<float> (memInfo, controlDefaults.data(), controlDefaults.size(),
+                                                          controlShape, target.controls.perSample ? 3 : 2);
+        binding.BindInput ("controls", *controlsTensor);
+    }
+
+    // Zero state in, scratch state out.
+    std::vector<std::vector<float>> stateScratch;
+    std::vector<Ort::Value> stateTensors;
+
+    for (const auto& state : target.states)
+    {
+        const auto stateShape = resolveBatch (state.shape, rows);
+        stateScratch.emplace_back (elementCount (stateShape), 0.0f);
+        stateTensors.push_back (Ort::Value::CreateTensor<float> (memInfo, stateScratch.back().data(),
+                                                                 stateScratch.back().size(),
+                                                                 stateShape.data(), stateShape.size()));
+        binding.BindInput (state.inputName.c_str(), stateTensors.back());
+
+        stateScratch.emplace_back (elementCount (stateShape), 0.0f);
+        stateTensors.push_back (Ort::Value::CreateTensor<float> (memInfo, stateScratch.back().data(),
+                                                                 stateScratch.back().size(),
+                                                                 stateShape.data(), stateShape.size()));
+        binding.BindOutput (state.outputName.c_str(), stateTensors.back());
+    }
+
+    target.session->Run (Ort::RunOptions { nullptr }, binding);
+}
+
+// Inference thread (or processPendingInput offline), between two frames.
+void InferenceEngine::swapInPendingModel()
+{
+    // One swap at a time: the previous model must be fully faded out and
+    // handed back before the next one can start.
+    if (fadingModel != nullptr || pendingModel.load() == nullptr)
+        return;
+
+    std::unique_ptr<Model> incoming (pendingModel.exchange (nullptr));
+    if (incoming == nullptr)
+        return;
+
+    // prepare() ran between binding and now. Rebinding allocates, but only
+    // in this rare case.
+    if (incoming->boundGeneration != frameGeneration)
+        bindModel (*incoming);
+
+    fadingModel   = std::move (model);
+    model         = std::move (incoming);
+    modelWindow   = model->window;
+    modelHop      = model->hop;
+    modelSpectral = model->spectral;
+    modelRate     = model->sampleRate;
+    modelLoaded.store (true);
+
+    crossfadeFrame  = 0;
+    crossfadeFrames = (kCrossfadeSamples + hopSize - 1) / hopSize;
+}
+
+#endif
+
+void InferenceEngine::setFraming (int newHopSize, int newWindowSize)
+{
+    const juce::ScopedLock sl (frameLock);
+    requestedHop    = juce::jmax (0, newHopSize);
+    requestedWindow = juce::jmax (0, newWindowSize);
+}
+
+void InferenceEngine::setOfflineMode (bool shouldRenderOffline)
+{
+    // Each stage builds its own session, outside this engine's lock.
+    for (auto& stage : chainStages)
+        stage->setOfflineMode (shouldRenderOffline);
+
+#if MOJO_ONNX_ENABLED
+    // The render gets its own session so ORT can spread each Run across every
+    // core; playback goes back to the single-threaded one and releases it.
+    // Building it may optimise the model, so that happens before frameLock
+    // is taken, with the inference thread still running; only the pointer is
+    // installed under the lock.
+    juce::File offlineFile;
+    const void* offlineData = nullptr;
+    std::shared_ptr<Ort::Session> offlineSession;
+
+    if (shouldRenderOffline)
+    {
+        size_t numBytes = 0;
+        bool needed = false;
+
+        {
+            const juce::ScopedLock sl (frameLock);
+
+            if (model != nullptr && model->offlineSession == nullptr)
+            {
+                offlineFile = model->file;
+                offlineData = model->data;
+                numBytes    = model->numBytes;
+                needed      = true;
+            }
+        }
+
+        if (needed)
+            offlineSession = acquireOfflineSession (offlineFile, offlineData, numBytes);
+    }
+#endif
+
+    const juce::ScopedLock sl (frameLock);
+    offlineMode.store (shouldRenderOffline);
+
+#if MOJO_ONNX_ENABLED
+    if (model == nullptr)
+        return;
+
+    if (! shouldRenderOffline)
+    {
+        model->frameBindings.clear();
+        model->offlineSession.reset();
+    }
+    else if (model->offlineSession == nullptr && model->file == offlineFile && model->data == offlineData)
+    {
+        // Unless another model was swapped in meanwhile.
+        model->offlineSession = std::move (offlineSession);
+    }
+#endif
+}
+
+void InferenceEngine::prepare (int newNumChannels, int newMaxBlockSize, double newSampleRate)
+{
+    const juce::ScopedLock sl (frameLock);
+
+#if MOJO_ONNX_ENABLED
+    // A swap still waiting for the next frame can simply happen now, and a
+    // crossfade in progress is cut short: everything restarts from silence.
+    if (std::unique_ptr<Model> incoming { pendingModel.exchange (nullptr) })
+        adoptModel (std::move (incoming));
+
+    fadingModel.reset();
+#endif
+    adoptWaitingModel();
+
+    if (std::unique_ptr<InferenceBackend> incoming { pendingInline.exchange (nullptr) })
+        inlineBackend = std::move (incoming);
+
+    fadingInline.reset();
+    collectRetiredModel();
+    crossfadeFrame = crossfadeFrames = 0;
+
+    numChannels  = juce::jmax (1, newNumChannels);
+    maxBlockSize = juce::jmax (1, newMaxBlockSize);
+    sampleRate   = juce::jmax (0.0, newSampleRate);
+    configureFrames();
+
+    if (inlineBackend != nullptr)
+        inlineBackend->prepare (numChannels, maxBlockSize);
+
+    inlineScratch.setSize (numChannels, maxBlockSize);
+    inlineFadePosition = 0;
+
+    const int inputFifoSize = getInputFifoSize();
+    inputBuffer.setSize (numChannels, inputFifoSize);
+    inputBuffer.clear();
+    inputFifo.setTotalSize (inputFifoSize);
+
+    // Each stage of a chain frames what the one before hands it, with its
+    // own latency on top.
+    chainLatencySamples = chainPrimingSamples = chainMaxHop = 0;
+
+    for (auto& stage : chainStages)
+    {
+        stage->prepare (numChannels, maxBlockSize, sampleRate);
+        chainLatencySamples += stage->getLatencySamples();
+        chainPrimingSamples += stage->getPrimingSamples();
+        chainMaxHop = juce::jmax (chainMaxHop, stage->sessionHop);
+    }
+
+    updateLatency();
+}
+
+void InferenceEngine::release()
+{
+    const juce::ScopedLock sl (frameLock);
+
+    for (auto& stage : chainStages)
+        stage->release();
+
+    maxBlockSize = 0;
+    outputFifo   = nullptr;
+    outputBuf    = nullptr;
+
+    // Nothing is playing now, so a model waiting for other framing or the
+    // other backend can have it.
+    adoptWaitingModel();
+}
+
+// Takes over the model loadModelAsync() left waiting for other framing or
+// the other backend, if any. Called with frameLock held, while the engine is
+// being (un)prepared.
+void InferenceEngine::adoptWaitingModel()
+{
+    if (std::unique_ptr<InferenceBackend> incoming { waitingInline.exchange (nullptr) })
+        adoptInlineBackend (std::move (incoming));
+
+#if MOJO_ONNX_ENABLED
+    if (std::unique_ptr<Model> incoming { waitingModel.exchange (nullptr) })
+        adoptModel (std::move (incoming));
+#endif
+}
+
+void InferenceEngine::clearWaitingModel()
+{
+    delete waitingInline.exchange (nullptr);
+
+#if MOJO_ONNX_ENABLED
+    delete waitingModel.exchange (nullptr);
+#endif
+}
+
+// Called with frameLock held whenever the backend or the framing changes.
+void InferenceEngine::updateLatency()
+{
+    // A sample submitted in one block is only guaranteed to have been framed
+    // by the next one, and up to (hop - 1) samples can be waiting for the hop
+    // to fill. Overlap-add then holds back another (window - hop). The native
+    // backend processes each block in place and adds nothing. The stages of
+    // a chain add theirs.
+    primingSamples = maxBlockSize + sessionHop - 1;
+    double delay = windowSize - hopSize;
+
+    // Resampling, the hop is as long as it takes to come back at the session
+    // rate, and the overlap-add and both conversion filters delay the signal
+    // by a fraction of a sample more or less than a whole number; it lands
+    // within half a sample of the latency reported.
+    if (resampling)
+    {
+        const double sessionPerModel = (double) outputResampler.getUpFactor() / (double) outputResampler.getDownFactor();
+        delay = (delay + outputResampler.getLatencyInInputSamples()) * sessionPerModel
+              + inputResampler.getLatencyInInputSamples();
+    }
+
+    latencySamples = runsInline() ? 0 : primingSamples + juce::roundToInt (delay) + chainLatencySamples;
+}
+
+int InferenceEngine::getRequiredOutputFifoSize() const noexcept
+{
+    return latencySamples + 2 * maxBlockSize + juce::jmax (sessionHop, chainMaxHop) + 1;
+}
+
+// The input ring must hold a full host block on top of a partially filled
+// hop. Sized for the window (not the hop) so a later model load cannot
+// outgrow it.
+int InferenceEngine::getInputFifoSize() const noexcept
+{
+    const int sessionWindow = resampling ? outputResampler.getMaxOutputSamples (windowSize) : windowSize;
+    return 2 * (maxBlockSize + sessionWindow) + 1;
+}
+
+// Derives the effective hop/window and (re)allocates everything the frame
+// loop touches. Called with frameLock held.
+void InferenceEngine::configureFrames()
+{
+    jassert (requestedWindow == 0 || modelWindow == 0 || requestedWindow == modelWindow);
+
+    windowSize = modelWindow     > 0 ? modelWindow
+               : requestedWindow > 0 ? requestedWindow
+                                     : kDefaultWindowSize;
+
+    // A hop the model declares wins over the one asked for. Spectral frames
+    // must overlap, or the analysis windows cannot add back up to one.
+    const int hop = modelHop > 0 ? modelHop : requestedHop;
+    hopSize = hop > 0 ? juce::jmin (hop, windowSize) : windowSize;
+
+    if (modelSpectral)
+        hopSize = juce::jmin (hopSize, windowSize / 2);
+
+    // Overlap-add needs a whole number of hops per window.
+    jassert (windowSize % hopSize == 0);
+    while (windowSize % hopSize != 0)
+        --hopSize;
+
+    // Offline, batch as many hops as one host block can complete.
+    const int hopsPerBlock = (juce::jmax (1, maxBlockSize) + hopSize - 1) / hopSize + 1;
+    maxBatchFrames = offlineMode.load() ? juce::jlimit (1, kMaxOfflineBatchFrames, hopsPerBlock) : 1;
+
+    const auto channelFrame = (size_t) (numChannels * windowSize);
+    analysisWindows.assign (channelFrame, 0.0f);
+    overlapAdd     .assign (channelFrame, 0.0f);
+    frameInput     .assign (channelFrame * (size_t) maxBatchFrames, 0.0f);
+    frameOutput    .assign (channelFrame * (size_t) maxBatchFrames, 0.0f);
+    synthesisWindow.clear();
+    spectralWindow .clear();
+    frameSpectra   .clear();
+    lastOutput     .assign ((size_t) numChannels, 0.0f);
+    hopChannels    .assign ((size_t) numChannels, nullptr);
+    lastQuality = DeadlineScheduler::Quality::full;
+
+    // The control windows start out flat at the current values.
+    controlWindows.resize ((size_t) (ModelControls::kMaxControls * windowSize));
+    for (int c = 0; c < ModelControls::kMaxControls; ++c)
+        std::fill_n (controlWindows.begin() + c * windowSize, windowSize, controlValues[(size_t) c]);
+
+    frameControls     .assign (controlWindows.size() * (size_t) maxBatchFrames, 0.0f);
+    frameControlStamps.assign ((size_t) maxBatchFrames, kUnstagedControls);
+    controlHopsUnsettled = 0;
+
+    if (modelSpectral)
+    {
+        // Hann analysis, and a synthesis window that undoes it in the
+        // overlap-add.
+        spectralFrames.prepare (windowSize);
+        SpectralFrames::makeWindows (windowSize, hopSize, spectralWindow, synthesisWindow);
+        frameSpectra.assign ((size_t) (maxBatchFrames * numChannels * spectralFrames.getRowLength()), 0.0f);
+    }
+    else if (hopSize < windowSize)
+    {
+        // Periodic Hann, normalised per hop phase so the overlapped windows
+        // sum to exactly one.
+        synthesisWindow.resize ((size_t) windowSize);
+
+        for (int i = 0; i < windowSize; ++i)
+            synthesisWindow[(size_t) i] = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi
+                                                                * (float) i / (float) windowSize);
+
+        for (int phase = 0; phase < hopSize; ++phase)
+        {
+            float sum = 0.0f;
+            for (int i = phase; i < windowSize; i += hopSize)
+                sum += synthesisWindow[(size_t) i];
+
+            for (int i = phase; i < windowSize; i += hopSize)
+                synthesisWindow[(size_t) i] /= sum;
+        }
+    }
+
+    // A model that declares its rate runs at it: the session's audio is
+    // converted on the way in, and each hop back on the way out.
+    const int sessionRate = juce::roundToInt (sampleRate);
+    const bool rateDiffers = modelRate > 0 && sessionRate > 0 && sessionRate != modelRate && ! runsInline();
+
+    resampling = rateDiffers
+              && inputResampler .prepare (sessionRate, modelRate, numChannels, juce::jmax (1, maxBlockSize))
+              && outputResampler.prepare (modelRate, sessionRate, numChannels, hopSize);
+
+    if (rateDiffers && ! resampling)
+        DBG ("No conversion from " << sessionRate << " to " << modelRate << " Hz; the model runs at the session rate");
+
+    sessionHop        = resampling ? outputResampler.getMaxOutputSamples (hopSize) : hopSize;
+    resampledCapacity = resampling ? inputResampler.getMaxOutputSamples (getInputFifoSize()) + hopSize : 0;
+    resampledReady    = 0;
+    resampledInput .assign ((size_t) (numChannels * resampledCapacity), 0.0f);
+    resampledOutput.assign (resampling ? (size_t) (numChannels * sessionHop) : 0, 0.0f);
+    resampleSources.assign ((size_t) numChannels, nullptr);
+    resampleTargets.assign ((size_t) numChannels, nullptr);
+
+    ++frameGeneration;
+
+#if MOJO_ONNX_ENABLED
+    if (model != nullptr)
+        bindModel (*model);
+
+    if (fallbackModel != nullptr)
+    {
+        if (! fitsFraming (*fallbackModel))
+        {
+            DBG ("Fallback model needs a different window, hop, domain or sample rate; dropped");
+            fallbackModel.reset();
+        }
+        else
+        {
+            bindModel (*fallbackModel);
+        }
+    }
+
+    const bool hasFallback = fallbackModel != nullptr;
+#else
+    const bool hasFallback = false;
+#endif
+
+    // Bounces never degrade: they wait for every Run instead. Resampling,
+    // a hop lasts as long as it does at the model's rate.
+    scheduler.prepare (offlineMode.load() ? 0.0 : resampling ? (double) modelRate : sampleRate, hopSize,
+                       (juce::jmax (1, maxBlockSize) + sessionHop - 1) / sessionHop, hasFallback);
+}
+
+#if MOJO_ONNX_ENABLED
+// Allocates the model's output (and state) buffers and binds them, together
+// with frameInput, for every batch size up to maxBatchFrames — or just single
+// frames for a stateful model. Called with frameLock held.
+void InferenceEngine::bindModel (Model& target)
+{
+    target.frameBindings.clear();
+    target.stateBuffers.clear();
+    target.output.assign (frameOutput.size(), 0.0f);
+    target.boundGeneration = frameGeneration;
+
+    // The controls tensor has the batch's rows too: [rows, controls] or
+    // [rows, controls, window].
+    const int numControls   = target.controls.size();
+    const int controlLength = target.controls.perSample ? numControls * windowSize : numControls;
+    target.controlInput.assign ((size_t) (maxBatchFrames * numChannels * controlLength), 0.0f);
+    target.controlStamps.assign ((size_t) maxBatchFrames, kUnstagedControls);
+    target.stateParity = 0;
+
+    // A spectral model reads the analysed rows in frameSpectra and writes
+    // rows that inferWith() resynthesises into output.
+    jassert (target.spectral == ! frameSpectra.empty());
+    const int rowLength = target.spectral ? spectralFrames.getRowLength() : windowSize;
+    target.spectralOutput.assign (target.spectral ? frameSpectra.size() : 0, 0.0f);
+    float* const inputRows  = target.spectral ? frameSpectra.data()          : frameInput.data();
+    float* const outputRows = target.spectral ? target.spectralOutput.data() : target.output.data();
+
+    auto* session = (offlineMode.load() && target.offlineSession != nullptr) ? target.offlineSession.get()
+                                                                             : target.session.get();
+    target.boundSession = session;
+
+    const int boundFrames = target.isStateful() ? 1 : maxBatchFrames;
+    const int numParities = target.isStateful() ? 2 : 1;
+    const auto numStates  = target.states.size();
+
+    try
+    {
+        auto memInfo = Ort::MemoryInfo::CreateCpu (OrtArenaAllocator, OrtMemTypeDefault);
+
+        for (int frames = 1; frames <= boundFrames; ++frames)
+        {
+            // Every row in one Run when the batch is dynamic; otherwise as
+            // many Runs as it takes in groups of the model's static batch.
+            const int totalRows  = frames * numChannels;
+            const int rowsPerRun = target.batch > 0 ? target.batch : totalRows;
+            const int numRuns    = totalRows / rowsPerRun;
+            const int64_t timeShape[]     = { (int64_t) rowsPerRun, (int64_t) windowSize };
+            const int64_t spectralShape[] = { (int64_t) rowsPerRun, 2, (int64_t) spectralFrames.getNumBins() };
+            const int64_t controlShape[]  = { (int64_t) rowsPerRun, (int64_t) numControls, (int64_t) windowSize };
+            const auto* shape = target.spectral ? spectralShape : timeShape;
+            const size_t shapeRank = target.spectral ? 3 : 2;
+            const auto tensorLength = (size_t) (rowsPerRun * rowLength);
+
+            jassert (totalRows % rowsPerRun == 0);
+
+            auto& entry = target.frameBindings.emplace_back();
+
+            // Each Run carries its own rows' state, in a ping and a pong
+            // buffer per state tensor.
+            for (int run = 0; run < numRuns; ++run)
+                for (const auto& state : target.states)
+                    for (int parity = 0; parity < numParities; ++parity)
+                        target.stateBuffers.emplace_back (elementCount (resolveBatch (state.shape, rowsPerRun)), 0.0f);
+
+            const auto makeTensor = [&] (float* data, size_t length, const int64_t* dims, size_t numDims) -> Ort::Value&
+            {
+                entry.tensors.push_back (std::make_unique<Ort::Value> (
+                    Ort::Value::CreateTensor<float> (memInfo, data, length, dims, numDims)));
+                return *entry.tensors.back();
+            };
+
+            for (int run = 0; run < numRuns; ++run)
+            {
+                const auto offset = (size_t) (run * rowsPerRun * rowLength);
+
+                auto& in  = makeTensor (inputRows  + offset, tensorLength, shape, shapeRank);
+                auto& out = makeTensor (outputRows + offset, tensorLength, shape, shapeRank);
+
+                Ort::Value* controls = nullptr;
+                if (numControls > 0)
+                    controls = &makeTensor (target.controlInput.data() + run * rowsPerRun * controlLength,
+                                            (size_t) (rowsPerRun * controlLength), controlShape,
+                                            target.controls.perSample ? 3 : 2);
+
+                for (int parity = 0; parity < numParities; ++parity)
+                {
+                    auto binding = std::make_unique<Ort::IoBinding> (*session);
+                    binding->BindInput  ("input",  in);
+                    binding->BindOutput ("output", out);
+
+                    if (controls != nullptr)
+                        binding->BindInput ("controls", *controls);
+
+                    // On even hops state flows ping → pong, on odd ones back.
+                    for (size_t s = 0; s < numStates; ++s)
+                    {
+                        const auto& state = target.states[s];
+                        const auto stateShape = resolveBatch (state.shape, rowsPerRun);
+                        auto& ping = target.stateBuffers[((size_t) run * numStates + s) * 2 + (size_t) parity];
+                        auto& pong = target.stateBuffers[((size_t) run * numStates + s) * 2 + (size_t) (parity ^ 1)];
+
+                        binding->BindInput  (state.inputName.c_str(),
+                                             makeTensor (ping.data(), ping.size(), stateShape.data(), stateShape.size()));
+                        binding->BindOutput (state.outputName.c_str(),
+                                             makeTensor (pong.data(), pong.size(), stateShape.data(), stateShape.size()));
+                    }
+
+                    entry.bindings[(size_t) parity].push_back (std::move (binding));
+                }
+            }
+        }
+    }
+    catch (const Ort::Exception& e)
+    {
+        DBG ("ONNX I/O binding failed: " << e.what());
+        target.frameBindings.clear();
+    }
+}
+
+void InferenceEngine::resetState()
+{
+    const juce::ScopedLock sl (frameLock);
+
+    for (auto& stage : chainStages)
+        stage->resetState();
+
+    for (auto* backend : { inlineBackend.get(), fadingInline.get() })
+        if (backend != nullptr)
+            backend->reset();
+
+    for (auto* m : { model.get(), fadingModel.get(), fallbackModel.get() })
+    {
+        if (m == nullptr)
+            continue;
+
+        for (auto& buffer : m->stateBuffers)
+            std::fill (buffer.begin(), buffer.end(), 0.0f);
+
+        m->stateParity = 0;
+    }
+}
+#else
+void InferenceEngine::resetState()
+{
+    const juce::ScopedLock sl (frameLock);
+
+    for (auto& stage : chainStages)
+        stage->resetState();
+
+    for (auto* backend : { inlineBackend.get(), fadingInline.get() })
+        if (backend != nullptr)
+            backend->reset();
+}
+#endif
+
+//==============================================================================
+void InferenceEngine::submitInput (const float* const* channelData, int numInputChannels,
+                                   int numSamples)
+{
+    // Audio thread: lock-free write into inputFifo.
+    const int toWrite = juce::jmin (numSamples, inputFifo.getFreeSpace());
+    if (toWrite < numSamples)
+        telemetry.addDroppedInput (numSamples - toWrite);
+
+    if (toWrite == 0)
+        return;
+
+    const auto scope = inputFifo.write (toWrite);
+
+    for (int ch = 0; ch < inputBuffer.getNumChannels(); ++ch)
+    {
+        if (ch >= numInputChannels)
+        {
+            inputBuffer.clear (ch, scope.startIndex1, scope.blockSize1);
+            inputBuffer.clear (ch, scope.startIndex2, scope.blockSize2);
+            continue;
+        }
+
+        const float* data = channelData[ch];
+        inputBuffer.copyFrom (ch, scope.startIndex1, data, scope.blockSize1);
+        if (scope.blockSize2 > 0)
+            inputBuffer.copyFrom (ch, scope.startIndex2, data + scope.blockSize1, scope.blockSize2);
+    }
+
+    telemetry.noteInputFifoLevel (inputFifo.getNumReady());
+
+    // Offline, the caller runs the frames itself via processPendingInput().
+    if (! offlineMode.load())
+        inferenceWakeup.notify();
+}
+
+// Audio thread. Owns inlineBackend and fadingInline for as long as the
+// engine stays prepared.
+void InferenceEngine::processInline (float* const* channels, int numInputChannels, int numSamples) noexcept
+{
+    jassert (runsInline());
+
+    if (fadingInline == nullptr)
+    {
+        if (auto* incoming = pendingInline.exchange (nullptr))
+        {
+            fadingInline = std::move (inlineBackend);
+            inlineBackend.reset (incoming);
+            inlineFadePosition = 0;
+        }
+    }
+
+    if (inlineBackend == nullptr)
+        return;
+
+    const auto runStart = juce::Time::getHighResolutionTicks();
+
+    // While a new model fades in, the old one runs on a copy of the input.
+    const int fadeChannels = juce::jmin (numInputChannels, inlineScratch.getNumChannels());
+    const int fadeSamples  = juce::jmin (numSamples, inlineScratch.getNumSamples());
+
+    if (fadingInline != nullptr)
+    {
+        for (int ch = 0; ch < fadeChannels; ++ch)
+            inlineScratch.copyFrom (ch, 0, channels[ch], fadeSamples);
+
+        fadingInline->process (inlineScratch.getArrayOfWritePointers(), fadeChannels, fadeSamples);
+    }
+
+    inlineBackend->process (channels, numInputChannels, numSamples);
+
+    if (fadingInline != nullptr)
+    {
+        for (int ch = 0; ch < fadeChannels; ++ch)
+        {
+            float* const out = channels[ch];
+            const float* const old = inlineScratch.getReadPointer (ch);
+
+            for (int i = 0; i < fadeSamples; ++i)
+            {
+                const auto gain = juce::jmin (1.0f, (float) (inlineFadePosition + i) / (float) kCrossfadeSamples);
+                out[i] = old[i] + gain * (out[i] - old[i]);
+            }
+        }
+
+        inlineFadePosition += fadeSamples;
+
+        // Hand the faded-out model to the loader to free, once it has room.
+        if (inlineFadePosition >= kCrossfadeSamples && retiredInline.load() == nullptr)
+            retiredInline.store (fadingInline.release());
+    }
+
+    telemetry.recordRun (juce::Time::highResolutionTicksToSeconds (
+                             juce::Time::getHighResolutionTicks() - runStart) * 1.0e6);
+}
+
+void InferenceEngine::setControls (const float* normalisedValues, int numValues) noexcept
+{
+    // Audio thread. A knob that has not moved costs one relaxed load.
+    for (int i = 0; i < juce::jmin (numValues, ModelControls::kMaxControls); ++i)
+    {
+        const float value = juce::jlimit (0.0f, 1.0f, normalisedValues[i]);
+        auto& target = controlTargets[(size_t) i];
+
+        if (target.load (std::memory_order_relaxed) != value)
+            target.store (value, std::memory_order_relaxed);
+    }
+}
+
+ModelControls InferenceEngine::getControls() const
+{
+    const juce::ScopedLock sl (statusLock);
+    return activeControls;
+}
+
+// A model was adopted outright: its controls start at their defaults, with
+// no ramp. Called with frameLock held, before configureFrames().
+void InferenceEngine::resetControls (const ModelControls& declared)
+{
+    for (int c = 0; c < ModelControls::kMaxControls; ++c)
+    {
+        float value = 0.0f;
+        if (c < declared.size())
+            value = declared.controls[(size_t) c].toNormalised (declared.controls[(size_t) c].defaultValue);
+
+        controlTargets[(size_t) c].store (value, std::memory_order_relaxed);
+        controlValues[(size_t) c] = value;
+    }
+
+    const juce::ScopedLock sl (statusLock);
+    activeControls = declared;
+}
+
+int InferenceEngine::getNumActiveControls() const noexcept
+{
+    int count = 0;
+
+#if MOJO_ONNX_ENABLED
+    for (auto* m : { model.get(), fadingModel.get(), fallbackModel.get() })
+        if (m != nullptr)
+            count = juce::jmax (count, m->controls.size());
+#endif
+
+    return count;
+}
+
+// Inference thread: slides the first count control windows on by one hop,
+// ramping linearly from where they were to the latest targets, and stages
+// them for one frame of the batch.
+void InferenceEngine::stageControls (int frame, int count)
+{
+    bool retargeted = false;
+    for (int c = 0; c < count; ++c)
+        retargeted = retargeted || controlTargets[(size_t) c].load (std::memory_order_relaxed) != controlValues[(size_t) c];
+
+    // A ramp takes window / hop more hops to slide out of the window; after
+    // that the windows are flat at the targets and sliding changes nothing.
+    if (retargeted)
+        controlHopsUnsettled = windowSize / hopSize + 1;
+
+    if (controlHopsUnsettled > 0)
+    {
+        --controlHopsUnsettled;
+
+        for (int c = 0; c < count; ++c)
+        {
+            float* const window    = controlWindows.data() + c * windowSize;
+            float* const newValues = window + (windowSize - hopSize);
+            const float from = controlValues[(size_t) c];
+            const float to   = controlTargets[(size_t) c].load (std::memory_order_relaxed);
+
+            std::copy (window + hopSize, window + windowSize, window);
+
+            for (int i = 0; i < hopSize; ++i)
+                newValues[i] = from + (to - from) * (float) (i + 1) / (float) hopSize;
+
+            controlValues[(size_t) c] = to;
+        }
+
+        if (++controlStamp == kUnstagedControls)
+            controlStamp = 0;
+    }
+
+    if (frameControlStamps[(size_t) frame] != controlStamp)
+    {
+        std::copy (controlWindows.begin(), controlWindows.end(),
+                   frameControls.begin() + (std::ptrdiff_t) ((size_t) frame * controlWindows.size()));
+        frameControlStamps[(size_t) frame] = controlStamp;
+    }
+}
+
+void InferenceEngine::processPendingInput()
+{
+    jassert (offlineMode.load());
+
+    const juce::ScopedLock sl (frameLock);
+
+    if (! hasOutput() || maxBlockSize == 0)
+        return; // not prepared yet
+
+    for (int hops = getHopsReady(); hops > 0;)
+    {
+        const int frames = beginFrames (hops);
+        processFrames (frames);
+        hops -= frames;
+    }
+
+    // Then each stage of a chain takes what the one before handed it.
+    for (auto& stage : chainStages)
+        stage->processPendingInput();
+}
+
+void InferenceEngine::setOutputFifo (SpscFifo* fifo,
+                                     juce::AudioBuffer<float>* buffer) noexcept
+{
+    const juce::ScopedLock sl (frameLock);
+    outputFifo = fifo;
+    outputBuf  = buffer;
+
+    // In a chain the last stage writes the results.
+    if (! chainStages.empty())
+        chainStages.back()->setOutputFifo (fifo, buffer);
+}
+
+//==============================================================================
+// Inference thread body — never runs on the audio thread.
+void InferenceEngine::run()
+{
+    while (! threadShouldExit())
+    {
+        inferenceWakeup.wait (100);
+
+        if (threadShouldExit())
+            break;
+
+        if (offlineMode.load())
+            continue; // processBlock drives inference itself
+
+        const juce::ScopedLock sl (frameLock);
+
+        if (! hasOutput() || maxBlockSize == 0)
+            continue; // not prepared yet
+
+        jassert (downstream != nullptr || outputBuf->getNumChannels() >= numChannels);
+
+        while (getHopsReady() > 0 && ! threadShouldExit())
+            processFrames (beginFrames (1));
+    }
+}
+
+// Whole hops waiting to be framed. Resampling, more input is converted to
+// the model's rate only once less than a hop of it is left, which keeps
+// resampledInput within a hop of one conversion of the input ring.
+int InferenceEngine::getHopsReady()
+{
+    if (! resampling)
+        return inputFifo.getNumReady() / hopSize;
+
+    if (resampledReady < hopSize)
+        convertInput();
+
+    return resampledReady / hopSize;
+}
+
+// Hops still queued, converted or not, for the scheduler's backlog.
+int InferenceEngine::getHopsQueued() const noexcept
+{
+    if (! resampling)
+        return inputFifo.getNumReady() / hopSize;
+
+    const auto unconverted = (int64_t) inputFifo.getNumReady() * inputResampler.getUpFactor()
+                                 / inputResampler.getDownFactor();
+    return (resampledReady + (int) unconverted) / hopSize;
+}
+
+// Inference thread: takes everything the audio thread has submitted, as far
+// as resampledInput has room for it, and converts it to the model's rate.
+void InferenceEngine::convertInput()
+{
+    const auto room = (int64_t) (resampledCapacity - resampledReady - 1);
+    const int toRead = juce::jmin (inputFifo.getNumReady(),
+                                   (int) juce::jmax (int64_t { 0 }, room * inputResampler.getDownFactor()
+                                                                        / inputResampler.getUpFactor()));
+    if (toRead == 0)
+        return;
+
+    const auto scope = inputFifo.read (toRead);
+
+    for (const auto& [start, length] : { std::make_pair (scope.startIndex1, scope.blockSize1),
+                                         std::make_pair (scope.startIndex2, scope.blockSize2) })
+    {
+        if (length == 0)
+            continue;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            resampleSources[(size_t) ch] = inputBuffer.getReadPointer (ch, start);
+            resampleTargets[(size_t) ch] = resampledInput.data() + ch * resampledCapacity + resampledReady;
+        }
+
+        resampledReady += inputResampler.process (resampleSources.data(), length, resampleTargets.data());
+    }
+}
+
+// Advances every channel's window by numFrames hops and runs the model once
+// on the whole batch. Everything it touches was allocated in
+// configureFrames()/prepare().
+void InferenceEngine::processFrames (int numFrames)
+{
+    jassert (numFrames >= 1 && numFrames <= maxBatchFrames);
+
+    const int channelFrame = numChannels * windowSize;
+    const int numControls  = getNumActiveControls();
+
+    // Slide each analysis window by one hop per frame, and stage a copy of
+    // every window position as its own row of the batch.
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        if (numControls > 0)
+            stageControls (frame, numControls);
+
+        // Resampling, the hop was converted already and waits in resampledInput.
+        const auto scope = inputFifo.read (resampling ? 0 : hopSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const window     = analysisWindows.data() + ch * windowSize;
+            float* const newSamples = window + (windowSize - hopSize);
+
+            std::copy (window + hopSize, window + windowSize, window);
+
+            if (resampling)
+            {
+                juce::FloatVectorOperations::copy (newSamples, resampledInput.data() + ch * resampledCapacity
+                                                                   + frame * hopSize, hopSize);
+                continue;
+            }
+
+            juce::FloatVectorOperations::copy (newSamples,
+                                               inputBuffer.getReadPointer (ch, scope.startIndex1),
+                                               scope.blockSize1);
+            if (scope.blockSize2 > 0)
+                juce::FloatVectorOperations::copy (newSamples + scope.blockSize1,
+                                                   inputBuffer.getReadPointer (ch, scope.startIndex2),
+                                                   scope.blockSize2);
+        }
+
+        juce::FloatVectorOperations::copy (frameInput.data() + frame * channelFrame,
+                                           analysisWindows.data(), channelFrame);
+
+        // Spectral models see Hann-windowed frames. A bypassed hop passes
+        // them on windowed too, which the synthesis window expects.
+        if (! spectralWindow.empty())
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::multiply (frameInput.data() + frame * channelFrame + ch * windowSize,
+                                                       spectralWindow.data(), windowSize);
+    }
+
+    if (resampling)
+    {
+        resampledReady -= numFrames * hopSize;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const converted = resampledInput.data() + ch * resampledCapacity;
+            std::copy (converted + numFrames * hopSize, converted + numFrames * hopSize + resampledReady, converted);
+        }
+    }
+
+    // Realtime hops come one at a time; the scheduler sees how many are
+    // still queued behind this one.
+    using Quality = DeadlineScheduler::Quality;
+    const auto quality = scheduler.beginHop (getHopsQueued() + 1);
+
+    const auto runStart = juce::Time::getHighResolutionTicks();
+    float* const output = runFrames (numFrames, quality);
+    const auto runEnd = juce::Time::getHighResolutionTicks();
+    const auto runMicros = juce::Time::highResolutionTicksToSeconds (runEnd - runStart) * 1.0e6;
+
+    scheduler.endHop (runMicros);
+
+    if (auto* trace = sessionTrace.load (std::memory_order_relaxed))
+        trace->recordRun (runStart, runEnd, numFrames, (int) quality, inputFifo.getNumReady(),
+                          outputFifo != nullptr ? outputFifo->getNumReady() : 0);
+
+    if (quality == Quality::bypassed)
+        telemetry.addBypassedHop();
+    else
+        telemetry.recordRun (runMicros);
+
+    if (quality == Quality::reduced)
+        telemetry.addReducedHop();
+
+    // Without overlap-add nothing blends a change of level: ramp out the
+    // step from the last sample emitted over this hop instead.
+    const bool rampStep = quality != lastQuality && synthesisWindow.empty();
+    lastQuality = quality;
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        float* const frameOut = output + frame * channelFrame;
+
+        // One hop of finished output per channel: the window itself, or the
+        // head of the overlap-add accumulator once this window has been added in.
+        if (! synthesisWindow.empty())
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* const out = frameOut + ch * windowSize;
+                float* const ola = overlapAdd.data() + ch * windowSize;
+
+                juce::FloatVectorOperations::addWithMultiply (ola, out, synthesisWindow.data(), windowSize);
+                juce::FloatVectorOperations::copy (out, ola, hopSize);
+                std::copy (ola + hopSize, ola + windowSize, ola);
+                std::fill (ola + windowSize - hopSize, ola + windowSize, 0.0f);
+            }
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const out = frameOut + ch * windowSize;
+
+            if (rampStep && frame == 0)
+            {
+                const float step = lastOutput[(size_t) ch] - out[0];
+
+                for (int i = 0; i < hopSize; ++i)
+                    out[i] += step * (float) (hopSize - i) / (float) hopSize;
+            }
+
+            lastOutput[(size_t) ch] = out[hopSize - 1];
+            hopChannels[(size_t) ch] = out;
+        }
+
+        // Back to the session's rate, which makes the hop a sample longer or
+        // shorter from time to time.
+        int hopLength = hopSize;
+
+        if (resampling)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                resampleTargets[(size_t) ch] = resampledOutput.data() + ch * sessionHop;
+
+            hopLength = outputResampler.process (hopChannels.data(), hopSize, resampleTargets.data());
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                hopChannels[(size_t) ch] = resampleTargets[(size_t) ch];
+        }
+
+        // Mid-chain, the hop goes on to the next stage's input instead.
+        if (downstream != nullptr)
+        {
+            downstream->submitInput (hopChannels.data(), numChannels, hopLength);
+            continue;
+        }
+
+        // Write results to output FIFO (read by processBlock).
+        const int toWrite = juce::jmin (hopLength, outputFifo->getFreeSpace());
+        if (toWrite < hopLength)
+            telemetry.addDroppedOutput (hopLength - toWrite);
+
+        if (toWrite > 0)
+        {
+            const auto scope = outputFifo->write (toWrite);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* hopOut = hopChannels[(size_t) ch];
+                outputBuf->copyFrom (ch, scope.startIndex1, hopOut, scope.blockSize1);
+                if (scope.blockSize2 > 0)
+                    outputBuf->copyFrom (ch, scope.startIndex2, hopOut + scope.blockSize1, scope.blockSize2);
+            }
+        }
+
+        telemetry.noteOutputFifoLevel (outputFifo->getNumReady());
+    }
+}
+
+// Called between frames: swaps in a model the loader has published, and
+// returns how many of the available hops the next processFrames() may stack
+// into one batch.
+int InferenceEngine::beginFrames (int hopsAvailable)
+{
+#if MOJO_ONNX_ENABLED
+    swapInPendingModel();
+
+    // Stateful models need every hop's state before the next can run.
+    const bool stateful = (model != nullptr && model->isStateful())
+                       || (fadingModel != nullptr && fadingModel->isStateful())
+                       || (fallbackModel != nullptr && fallbackModel->isStateful());
+    if (stateful)
+        return 1;
+#endif
+
+    return juce::jmin (hopsAvailable, maxBatchFrames);
+}
+
+// Runs the staged frames through the active model — and, right after a swap,
+// through the previous one as well, crossfading between the two — and
+// returns the buffer holding the [numFrames, channels, window] result.
+// Below full quality only the fallback model runs, or nothing at all; a
+// swap's crossfade waits until full quality resumes.
+float* InferenceEngine::runFrames (int numFrames, DeadlineScheduler::Quality quality)
+{
+    if (quality == DeadlineScheduler::Quality::bypassed)
+    {
+        juce::FloatVectorOperations::copy (frameOutput.data(), frameInput.data(),
+                                           numFrames * numChannels * windowSize);
+        return frameOutput.data();
+    }
+
+#if MOJO_ONNX_ENABLED
+    if (modelSpectral)
+        analyseFrames (numFrames);
+
+    if (quality == DeadlineScheduler::Quality::reduced && fallbackModel != nullptr)
+        return inferWith (fallbackModel.get(), numFrames);
+
+    float* const output = inferWith (model.get(), numFrames);
+
+    if (crossfadeFrame < crossfadeFrames)
+    {
+        const float* const previous = inferWith (fadingModel.get(), numFrames);
+
+        // A linear ramp across each window, carried on from frame to frame.
+        for (int frame = 0; frame < numFrames && crossfadeFrame < crossfadeFrames; ++frame, ++crossfadeFrame)
+        {
+            if (previous == output)
+                continue;
+
+            const float gainStart = (float) crossfadeFrame / (float) crossfadeFrames;
+            const float gainStep  = 1.0f / (float) (crossfadeFrames * windowSize);
+
+            for (int row = 0; row < numChannels; ++row)
+            {
+                const auto offset = (size_t) ((frame * numChannels + row) * windowSize);
+                float* const out = output + offset;
+                const float* const old = previous + offset;
+
+                for (int i = 0; i < windowSize; ++i)
+                    out[i] = old[i] + (gainStart + gainStep * (float) i) * (out[i] - old[i]);
+            }
+        }
+    }
+
+    // Hand the faded-out model to the loader to free, once it has room.
+    if (crossfadeFrame >= crossfadeFrames && fadingModel != nullptr && retiredModel.load() == nullptr)
+        retiredModel.store (fadingModel.release());
+
+    return output;
+#else
+    juce::FloatVectorOperations::copy (frameOutput.data(), frameInput.data(),
+                                       numFrames * numChannels * windowSize);
+    return frameOutput.data();
+#endif
+}
+
+#if MOJO_ONNX_ENABLED
+// Runs one model over the staged frames and returns its output buffer. With
+// no model, or if the Run fails, copies the input to frameOutput instead.
+float* InferenceEngine::inferWith (Model* target, int numFrames)
+{
+    if (target != nullptr && (int) target->frameBindings.size() >= numFrames)
+    {
+        try
+        {
+            auto& entry = target->frameBindings[(size_t) numFrames - 1];
+            fillControls (*target, numFrames);
+
+            for (auto& binding : entry.bindings[(size_t) target->stateParity])
+                target->boundSession->Run (Ort::RunOptions { nullptr }, *binding);
+
+            // This hop's output state is the next hop's input.
+            if (target->isStateful())
+                target->stateParity ^= 1;
+
+            // Back to samples for the overlap-add.
+            if (target->spectral)
+            {
+                const int rowLength = spectralFrames.getRowLength();
+
+                for (int row = 0; row < numFrames * numChannels; ++row)
+                    spectralFrames.synthesise (target->spectralOutput.data() + row * rowLength,
+                                               target->output.data() + row * windowSize);
+            }
+
+            return target->output.data();
+        }
+        catch (const Ort::Exception& e)
+        {
+            DBG ("Inference error: " << e.what());
+        }
+    }
+
+    juce::FloatVectorOperations::copy (frameOutput.data(), frameInput.data(),
+                                       numFrames * numChannels * windowSize);
+    return frameOutput.data();
+}
+
+// Transforms the staged, windowed frames into the magnitude/phase rows a
+// spectral model reads. Done once per batch, however many models then run
+// on it.
+void InferenceEngine::analyseFrames (int numFrames)
+{
+    const int rowLength = spectralFrames.getRowLength();
+
+    for (int row = 0; row < numFrames * numChannels; ++row)
+        spectralFrames.analyse (frameInput.data() + row * windowSize, frameSpectra.data() + row * rowLength);
+}
+
+// Whether a model can run in the current framing as it stands: the same
+// window (if it fixes one), the same hop (if it declares one), the same
+// signal domain and the same sample rate. Called with frameLock held.
+bool InferenceEngine::fitsFraming (const Model& candidate) const noexcept
+{
+    return (candidate.window == 0 || candidate.window == windowSize)
+        && (candidate.hop == 0 || candidate.hop == hopSize)
+        && candidate.spectral == modelSpectral
+        && candidate.sampleRate == modelRate;
+}
+
+// Writes the staged control windows into the model's controls tensor, in the
+// model's ranges and once per channel row — but only for frames whose windows
+// changed since the tensor last saw them, which in steady state is none.
+void InferenceEngine::fillControls (Model& target, int numFrames)
+{
+    const int count = target.controls.size();
+    if (count == 0)
+        return;
+
+    const bool perSample = target.controls.perSample;
+    const int rowLength  = perSample ? count * windowSize : count;
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        auto& filled = target.controlStamps[(size_t) frame];
+        if (filled == frameControlStamps[(size_t) frame])
+            continue;
+
+        filled = frameControlStamps[(size_t) frame];
+
+        const float* const staged = frameControls.data() + (size_t) (frame * ModelControls::kMaxControls * windowSize);
+        float* const firstRow = target.controlInput.data() + (size_t) (frame * numChannels * rowLength);
+
+        for (int c = 0; c < count; ++c)
+        {
+            const auto& control = target.controls.controls[(size_t) c];
+            const float* const values = staged + c * windowSize;
+
+            if (perSample)
+            {
+                float* const out = firstRow + c * windowSize;
+                juce::FloatVectorOperations::copyWithMultiply (out, values, control.maximum - control.minimum, windowSize);
+                juce::FloatVectorOperations::add (out, control.minimum, windowSize);
+            }
+            else
+            {
+                // One value per frame: wherever the ramp has got to by the newest sample.
+                firstRow[c] = control.fromNormalised (values[windowSize - 1]);
+            }
+        }
+
+        // Every channel of a frame is conditioned alike.
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::copy (firstRow + ch * rowLength, firstRow, rowLength);
+    }
+}
+#endif
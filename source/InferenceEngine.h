@@ -1,19 +1,148 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DeadlineScheduler.h"
+#include "EngineTelemetry.h"
+#include "EngineThreading.h"
+#include "InferenceBackend.h"
+#include "ModelControls.h"
+#include "ModelVariants.h"
+#include "PolyphaseResampler.h"
+#include "SessionCache.h"
+#include "SessionTrace.h"
+#include "SpectralFrames.h"
+#include "SpscFifo.h"
+#include "WorkerWakeup.h"
 
 // Forward-declare ORT types to avoid pulling onnxruntime_cxx_api.h into every
 // translation unit. The .cpp file includes the full header.
-namespace Ort { class Session; class Env; }
+namespace Ort { class Session; struct IoBinding; struct Value; }
 
 /**
  * Wraps an ONNX Runtime session and runs inference on a background thread.
  *
+ * Sessions are shared: every engine that loads the same model (by content)
+ * uses one Ort::Session from the process-wide SessionCache, so N instances
+ * cost one copy of the weights. Each engine keeps its own frame buffers,
+ * IoBindings and thread.
+ *
+ * Framing:
+ *   Every channel of the bus is carried through the engine. The model always
+ *   sees a fixed [channels, window] batch, one row per channel, so a stereo
+ *   frame costs a single Run. (Models whose batch dimension is fixed at 1 are
+ *   run once per channel instead.)
+ *
+ *   Each row is a fixed-size window of `getWindowSize()` samples.
+ *   Every `getHopSize()` new input samples the window slides forward by one
+ *   hop and the model runs once. When hop == window the output is emitted
+ *   as-is; when hop < window the outputs are overlap-added with a normalised
+ *   Hann synthesis window, which adds (window - hop) samples of latency.
+ *
+ *   Stateful (GRU/LSTM, causal-conv) models declare extra inputs besides
+ *   "input" for their recurrent state, and matching extra outputs besides
+ *   "output" for the state after the hop. They are paired through the
+ *   "mojo.state" metadata entry ("h_in:h_out,c_in:c_out") or, without it,
+ *   in declaration order. The state lives in preallocated ping-pong buffers
+ *   that swap roles every hop, so such a model can run on just the hop
+ *   (window == hop) instead of a long overlapping context. Frames of a
+ *   stateful model are never stacked into one Run, since each needs the
+ *   previous one's state.
+ *
+ *   Spectral models declare an FFT size in their "mojo.fft_size" metadata
+ *   (and usually a hop in "mojo.hop"), and take and return [batch, 2, bins]
+ *   magnitude/phase rows instead of samples. The window is then the FFT
+ *   size: each staged window is Hann-windowed and transformed on the
+ *   inference thread (see SpectralFrames), the model's rows are transformed
+ *   back, and the weighted overlap-add resynthesises the output. Any model
+ *   may declare "mojo.hop"; it overrides setFraming()'s hop.
+ *
+ *   Conditioned models also take a "controls" input (see ModelControls):
+ *   setControls() hands new values over from the audio thread, and the
+ *   inference thread ramps to them across the next hop, keeping a window of
+ *   per-sample control values alongside each audio window. Each model's
+ *   controls tensor is bound once, like the audio input, and only rewritten
+ *   for frames whose control values changed.
+ *
+ *   In realtime each hop has to be inferred within one hop period, or
+ *   processBlock runs out of wet samples. A DeadlineScheduler watches the
+ *   Run times against that budget and, once they stay close to it, runs
+ *   hops on a lighter fallback model (see loadFallbackModel()); a single
+ *   slow Run changes nothing. Only when hops actually back up does it pass
+ *   them through dry but latency-aligned. It steps back up once there is
+ *   headroom again. Level changes are blended by the overlap-add, or ramped
+ *   from the last output sample over one hop when hop == window.
+ *
+ *   A model trained at one sample rate declares it in "mojo.sample_rate"
+ *   (in Hz). In a session at any other rate the inference thread converts
+ *   what it takes from the input FIFO to the model's rate with a
+ *   PolyphaseResampler, frames and runs it there, and converts each
+ *   finished hop back before writing it out, so a 48 kHz model costs the
+ *   same inference time at 96 or 192 kHz. Hop, window and overlap-add are
+ *   then counted at the model's rate; the latency, the priming and the
+ *   realtime deadline are converted to the session's, and the reported
+ *   latency includes both conversion filters.
+ *
+ *   The frame buffers (and, with ONNX enabled, the input/output tensors bound
+ *   to them through an IoBinding) are allocated up front, so the steady-state
+ *   inference loop never touches the heap.
+ *
+ * Offline rendering:
+ *   In offline mode (`setOfflineMode (true)`, used while the host bounces)
+ *   the background thread stays idle and the caller drives inference
+ *   synchronously with `processPendingInput()`, so a render never depends on
+ *   thread timing. Up to kMaxOfflineBatchFrames hops are stacked into a
+ *   single [frames * channels, window] Run, on a session that may use every
+ *   core for intra-op parallelism. Latency is identical in both modes.
+ *
  * Thread safety:
- *   - `loadModel()` must be called from the message thread before playback.
+ *   - `loadModel()`, `setFraming()` and `prepare()` must be called off the
+ *     audio thread, before playback.
+ *   - `loadModelAsync()` may be called at any time from the message thread.
+ *     The model is loaded and warmed up on a background loader, handed to
+ *     the inference thread through an atomic pointer and swapped in between
+ *     two frames, with a kCrossfadeSamples crossfade from the old output.
  *   - `submitInput()` is called from processBlock (audio thread) and is
- *     lock-free (writes to an AbstractFifo).
- *   - Results are written back to a caller-supplied AbstractFifo.
+ *     wait-free: it writes to an SpscFifo shared by all channels and wakes
+ *     the inference thread without a mutex, making a non-blocking wake
+ *     syscall only when that thread is parked (see WorkerWakeup).
+ *   - Results are written back to a caller-supplied SpscFifo and
+ *     multichannel buffer.
+ *   - `getTelemetry()` is lock-free on both sides; see EngineTelemetry.
+ *
+ * Quantized variants:
+ *   With a precision other than float32 (setPrecision()), the ONNX Runtime
+ *   path loads "name.int8.onnx" or "name.fp16.onnx" from next to the model
+ *   instead, if present; see ModelVariants. The native backend always runs
+ *   the float model.
+ *
+ * Scheduling:
+ *   The inference thread starts at background priority on any core, and
+ *   sessions run single-threaded. setThreading() changes both: the
+ *   thread's priority (up to a realtime class), its CPU affinity, and ORT's
+ *   intra/inter-op threads, spinning and execution mode; see EngineThreading.
+ *
+ * Model chains:
+ *   loadModelChain() runs several models in series (denoise → enhance →
+ *   character, say) as a pipeline. This engine runs the first; every
+ *   further model gets a stage engine of its own, with its own inference
+ *   thread, and each stage hands its finished hops straight to the next
+ *   one's input ring (an SpscFifo, written wait-free like submitInput()
+ *   from processBlock). Stages work on different hops at once, so a chain
+ *   keeps up as long as its slowest stage does, rather than the sum of all
+ *   of them. In exchange every stage adds its own latency (one host block,
+ *   a partial hop and its overlap-add), all of which getLatencySamples()
+ *   reports. Offline, processPendingInput() runs the stages in order.
+ *
+ * Native backend:
+ *   Small recurrent, convolutional or dense networks can instead run as a
+ *   NativeModel, straight on the audio thread (see setBackend()). Such a
+ *   model is processed in place by `processInline()` with no framing, no
+ *   FIFOs and no latency; submitInput() and the inference thread sit idle,
+ *   and run timings are recorded from the audio thread instead. A model
+ *   loaded during playback that needs the other kind of backend would
+ *   change the latency, so it cannot be swapped in: it waits and takes over
+ *   at the next prepare() or release() (see onReprepareNeeded), or is
+ *   refused if nothing is set to re-prepare the engine.
  */
 class InferenceEngine : private juce::Thread
 {
@@ -21,40 +150,481 @@ public:
     InferenceEngine();
     ~InferenceEngine() override;
 
-    /** Load a .onnx model from disk. Must be called off the audio thread. */
+    /** Load a .onnx model from disk. Must be called off the audio thread, and
+        before prepare() since the model's input length sets the window. */
     bool loadModel (const juce::File& modelFile);
 
+    /** Loads a model that is already in memory, such as one compiled into the
+        plugin as BinaryData, without copying it first. name is what the load
+        status calls it. The bytes must stay valid for as long as the model is
+        loaded (offline mode builds a second session from them). Otherwise
+        like loadModel(); quantized variants are not looked for. */
+    bool loadModel (const void* modelData, size_t numBytes, const juce::String& name);
+
+    /** Loads an ordered list of models as a pipelined chain (see "Model
+        chains" above): the first on this engine, each further one on a stage
+        engine with its own thread, fed by the one before. Every model runs
+        on ONNX Runtime, whatever setBackend() says. Call off the audio
+        thread, before prepare(). One file is the same as loadModel(). */
+    bool loadModelChain (const juce::Array<juce::File>& modelFiles);
+
+    /** Number of models in the chain: 1 unless loadModelChain() set up more. */
+    int getNumChainStages() const noexcept { return 1 + (int) chainStages.size(); }
+
+    /** The engine running model index (1 or more) of the chain, for its
+        telemetry and load status; index 0 is this engine. */
+    InferenceEngine& getChainStage (int index) noexcept { return index == 0 ? *this : *chainStages[(size_t) index - 1]; }
+
+    /** Loads a model in the background and hot-swaps it in during playback
+        without blocking the caller or the inference thread. While prepared,
+        a model that needs another framing (window, hop, signal domain or
+        sample rate) or another backend, and so another latency, cannot be
+        swapped in: it waits for the next prepare() or release() if
+        onReprepareNeeded is set, and is refused otherwise. Progress and
+        errors are reported through getLoadStatus(). A newer call supersedes
+        an older one still in flight. */
+    void loadModelAsync (const juce::File& modelFile);
+
+    /** Called on the loader thread when loadModelAsync() has loaded a model
+        that waits for the next prepare() (see above). The owner should
+        re-prepare soon — off the audio thread, with processing suspended —
+        and report the new latency. Set it before loading anything. */
+    std::function<void()> onReprepareNeeded;
+
+    enum class LoadState { idle, loading, warmingUp, swapping, ready, failed };
+
+    struct LoadStatus
+    {
+        LoadState    state    = LoadState::idle;
+        float        progress = 0.0f;   // 0..1
+        juce::String message;
+    };
+
+    /** Where the most recent loadModel()/loadModelAsync() has got to. */
+    LoadStatus getLoadStatus() const;
+
+    enum class Backend
+    {
+        automatic,     // native when the graph allows it, ONNX Runtime otherwise
+        onnxRuntime,   // always the framed ONNX Runtime pipeline
+        native         // NativeModel only; loading anything else fails
+    };
+
+    /** Loads a lighter model to run instead of the main one while the
+        realtime deadline is at risk; an empty File removes it. It must accept
+        the same window as the main model and declare the same sample rate.
+        Call off the audio thread, before prepare(). Returns false if it
+        cannot be used (always without ONNX Runtime, since the passthrough
+        costs nothing anyway). */
+    bool loadFallbackModel (const juce::File& modelFile);
+
+    /** The quality level the inference thread ran the most recent hop at. */
+    DeadlineScheduler::Quality getQuality() const noexcept { return scheduler.getQuality(); }
+
+    /** Chooses which quantized variant of a model (see ModelVariants) the
+        ONNX Runtime backend loads from now on. float32 by default; automatic
+        verifies the variants against the float model first. */
+    void setPrecision (ModelVariants::Precision newPrecision) noexcept { precisionChoice.store (newPrecision); }
+    ModelVariants::Precision getPrecision() const noexcept { return precisionChoice.load(); }
+
+    /** Applies new scheduling settings. If the priority or affinity changed,
+        the inference thread is restarted with them, which pauses realtime
+        inference for a moment, so prefer calling this while stopped. The ORT
+        options apply to models loaded from now on. Call off the audio thread.
+        Returns false if the thread could not get the priority asked for
+        (typically realtime without permission); it then runs at normal. */
+    bool setThreading (const EngineThreading& newThreading);
+    EngineThreading getThreading() const;
+
+    /** Chooses how models loaded from now on are run. Call off the audio thread. */
+    void setBackend (Backend newBackend) noexcept { backendChoice.store (newBackend); }
+    Backend getBackend() const noexcept { return backendChoice.load(); }
+
+    /** True when the loaded model runs on the audio thread through
+        processInline() rather than through submitInput() and the output FIFO.
+        Only changes on load() or prepare(), never during playback. */
+    bool runsInline() const noexcept { return inlineActive.load(); }
+
+    /** Runs the native model over numSamples of every channel in place, on
+        the calling (audio) thread. Lock- and allocation-free; adds no latency.
+        A model hot-swapped with loadModelAsync() is faded in over
+        kCrossfadeSamples here. Only valid when runsInline(). */
+    void processInline (float* const* channels, int numChannels, int numSamples) noexcept;
+
+    /** Sets the hop and the model window in samples. A hop of 0 means one hop
+        per window; a window of 0 means the model's declared input length (or
+        kDefaultWindowSize). The window must be a multiple of the hop. A hop
+        or FFT size the model declares in its metadata takes precedence.
+        Takes effect on the next prepare(). */
+    void setFraming (int hopSize, int windowSize = 0);
+
+    /** Sizes the input FIFO and frame buffers for numChannels channels and
+        blocks of up to maxBlockSize samples, and resets all framing state.
+        The sample rate sets the realtime deadline; 0 runs every hop at full
+        quality however long it takes. Call from prepareToPlay — never from
+        the audio thread. */
+    void prepare (int numChannels, int maxBlockSize, double sampleRate = 0.0);
+
+    /** Undoes prepare(): detaches the output FIFO and stops inferring until
+        the next prepare(), so that models loaded meanwhile take over at once
+        whatever framing they need. Call from releaseResources — never from
+        the audio thread. */
+    void release();
+
+    /** True between prepare() and release(). */
+    bool isPrepared() const noexcept { return maxBlockSize > 0; }
+
+    /** Switches between the low-latency realtime configuration and the
+        synchronous, batched, multi-threaded offline one. Takes effect on the
+        next prepare(). Call from prepareToPlay — never from the audio thread.
+        The first switch to offline may build the model's render session;
+        playback keeps running meanwhile. */
+    void setOfflineMode (bool shouldRenderOffline);
+
+    /** True when prepared for offline rendering; processBlock must then call
+        processPendingInput() after every submitInput(). */
+    bool isOfflineMode() const noexcept { return offlineMode.load(); }
+
+    /** Runs every complete hop waiting in the input FIFO on the calling thread.
+        Only valid in offline mode, where the background thread is idle. */
+    void processPendingInput();
+
+    /** Control values for a conditioned model, normalised 0..1, in the order
+        getControls() lists them. Called from processBlock: wait-free, and
+        only stores the values that changed. The inference thread ramps to
+        them across the next hop. */
+    void setControls (const float* normalisedValues, int numValues) noexcept;
+
+    /** The controls the loaded model declares; empty for unconditioned
+        models and for the native backend. */
+    ModelControls getControls() const;
+
     /** Returns true if a model is loaded and ready. */
     bool isReady() const noexcept { return modelLoaded.load(); }
 
-    /** Submit a block of samples for inference (audio thread safe). */
-    void submitInput (const float* data, int numSamples);
+    int getNumChannels() const noexcept { return numChannels; }
 
-    /** Attach the output FIFO that processBlock reads from. */
-    void setOutputFifo (juce::AbstractFifo* fifo, float* buffer) noexcept;
+    /** Hop and window in samples at the model's rate, which is the session's
+        unless isResampling(). */
+    int getHopSize()    const noexcept { return hopSize; }
+    int getWindowSize() const noexcept { return windowSize; }
+
+    /** The rate the loaded model declares in "mojo.sample_rate", or 0 when
+        it runs at whatever rate the session does. */
+    int getModelSampleRate() const noexcept { return modelRate; }
+
+    /** True when prepare() found the session at another rate than the
+        model's, so every hop is converted to the model's rate and back. */
+    bool isResampling() const noexcept { return resampling; }
+
+    /** Total delay between submitInput() and the matching samples being read
+        back from the output FIFO, once it has been primed with
+        getPrimingSamples() of silence. This is what the host should be told.
+        Valid after prepare(). */
+    int getLatencySamples() const noexcept { return latencySamples; }
+
+    /** Silence to pre-fill the output FIFO with so a full block of results is
+        always waiting: one host block plus a partially filled hop, for this
+        engine and every stage of a chain. The rest of the latency is the
+        overlap-add delay of (window - hop) of each, and the delay of the
+        conversion filters when resampling. */
+    int getPrimingSamples() const noexcept
+    {
+        return runsInline() ? 0 : primingSamples + chainPrimingSamples;
+    }
+
+    /** Smallest output FIFO (in samples) that can hold the priming silence
+        plus everything produced between two processBlock calls. */
+    int getRequiredOutputFifoSize() const noexcept;
+
+    /** Submit a block of samples for inference (audio thread safe).
+        Channels beyond getNumChannels() are ignored; missing ones are silent. */
+    void submitInput (const float* const* channelData, int numChannels, int numSamples);
+
+    /** Attach the output FIFO that processBlock reads from, and the buffer it
+        indexes (getNumChannels() channels). Pass nullptr to detach it while
+        the caller resizes it. */
+    void setOutputFifo (SpscFifo* fifo, juce::AudioBuffer<float>* buffer) noexcept;
+
+    /** Run timings, FIFO high-water marks and drop counters. The engine
+        records into it; processBlock adds its dry-fallback count, and the
+        editor reads snapshots from the message thread. */
+    EngineTelemetry&       getTelemetry() noexcept       { return telemetry; }
+    const EngineTelemetry& getTelemetry() const noexcept { return telemetry; }
+
+    /** Where each inference Run is recorded while a session trace is being
+        captured (see SessionTrace), or nullptr. The trace must outlive the
+        engine. */
+    void setSessionTrace (SessionTrace* trace) noexcept { sessionTrace.store (trace); }
+
+    /** Samples submitted but not yet framed. Exact from the audio thread. */
+    int getInputFifoLevel() const noexcept { return inputFifo.getNumReady(); }
+
+    /** Clears the recurrent state of stateful models, as if playback had just
+        started. prepare() does this too. Call off the audio thread. */
+    void resetState();
+
+    /** Window length used when the model does not declare a static one. */
+    static constexpr int kDefaultWindowSize = 256;
+
+    /** Most hops stacked into one Run while rendering offline. */
+    static constexpr int kMaxOfflineBatchFrames = 16;
+
+    /** Length of the fade from the old model's output to the new one's when
+        a model is swapped in during playback (rounded up to whole hops). */
+    static constexpr int kCrossfadeSamples = 512;
 
 private:
     void run() override;
+    bool startWorker (const EngineThreading& settings);
+    void configureFrames();
+    int getInputFifoSize() const noexcept;
+    int getHopsReady();
+    int getHopsQueued() const noexcept;
+    void convertInput();
+    int beginFrames (int hopsAvailable);
+    void processFrames (int numFrames);
+    void stageControls (int frame, int count);
+    void resetControls (const ModelControls& declared);
+    int getNumActiveControls() const noexcept;
+    float* runFrames (int numFrames, DeadlineScheduler::Quality quality);
+    void setLoadStatus (LoadState, float progress, const juce::String& message);
+    void updateLatency();
+    void adoptWaitingModel();
+    void clearWaitingModel();
+    bool hasOutput() const noexcept { return outputFifo != nullptr || downstream != nullptr; }
+    bool isPlaying() const noexcept { return maxBlockSize > 0 && hasOutput(); }
+    void setDownstream (InferenceEngine* next);
+    void unlinkChain();
+
+    std::unique_ptr<InferenceBackend> createInlineBackend (const juce::File& modelFile, juce::String& error) const;
+    std::unique_ptr<InferenceBackend> createInlineBackend (const void* modelData, size_t numBytes, juce::String& error) const;
+    void adoptInlineBackend (std::unique_ptr<InferenceBackend> backend);
+    void dropInlineBackend();
+    bool collectRetiredModel();
+    void loadInBackground (juce::File modelFile, int generation);
 
     std::atomic<bool> modelLoaded { false };
     std::atomic<bool> shouldStop  { false };
+    std::atomic<bool> offlineMode { false };
+    std::atomic<int>  loadGeneration { 0 };   // bumped by every load request
+    std::atomic<bool> inlineActive { false };
+    std::atomic<Backend> backendChoice { Backend::automatic };
+    std::atomic<ModelVariants::Precision> precisionChoice { ModelVariants::Precision::float32 };
 
-    // Input ring buffer (audio thread → inference thread)
-    static constexpr int kInputFifoSize = 4096;
-    juce::AbstractFifo inputFifo { kInputFifoSize };
-    std::array<float, kInputFifoSize> inputBuffer {};
+    // Framing configuration. requested* are what setFraming() asked for;
+    // hopSize/windowSize are the effective values after configureFrames().
+    int requestedHop    { 0 };
+    int requestedWindow { 0 };
+    int modelWindow     { 0 };   // > 0 when the model has a static input length
+    int modelHop        { 0 };   // > 0 when the model declares its hop
+    bool modelSpectral  { false };
+    int numChannels     { 1 };
+    int hopSize         { kDefaultWindowSize };
+    int windowSize      { kDefaultWindowSize };
+    int maxBlockSize    { 0 };
+    int maxBatchFrames  { 1 };   // hops per Run: 1 realtime, more when offline
+    int latencySamples  { 0 };
+    int primingSamples  { 0 };
+    double sampleRate   { 0.0 };
+
+    // Planar input ring buffer (audio thread → inference thread), sized in
+    // prepare(). One SpscFifo indexes all channels.
+    SpscFifo                 inputFifo { 1 };
+    juce::AudioBuffer<float> inputBuffer;
 
     // Output FIFO (owned by PluginProcessor, pointer stored here)
-    juce::AbstractFifo* outputFifo  { nullptr };
-    float*              outputBuf   { nullptr };
+    SpscFifo*                 outputFifo  { nullptr };
+    juce::AudioBuffer<float>* outputBuf   { nullptr };
+
+    // Model chains: the stage engines after this one, in order. When there
+    // are any, this engine's hops go to downstream's input instead of the
+    // output FIFO, which the last stage writes. The chain* values are the
+    // stages' latency and priming in total, added to this engine's own.
+    std::vector<std::unique_ptr<InferenceEngine>> chainStages;
+    InferenceEngine*          downstream  { nullptr };
+    int chainLatencySamples { 0 };
+    int chainPrimingSamples { 0 };
+    int chainMaxHop         { 0 };
+
+    // Sample-rate conversion. modelRate is what the active model declares
+    // (0: any). While resampling, the inference thread converts what it takes
+    // from inputFifo into resampledInput ([numChannels, resampledCapacity],
+    // the first resampledReady of each waiting to be framed), and each
+    // finished hop back into resampledOutput ([numChannels, sessionHop]).
+    // sessionHop is the most session-rate samples one hop comes back as:
+    // hopSize when not resampling.
+    int  modelRate  { 0 };
+    bool resampling { false };
+    int  sessionHop { kDefaultWindowSize };
+    PolyphaseResampler  inputResampler, outputResampler;
+    std::vector<float>  resampledInput, resampledOutput;
+    int                 resampledCapacity { 0 };
+    int                 resampledReady    { 0 };
+    std::vector<const float*> hopChannels;       // one finished hop per channel, as written out
+    std::vector<const float*> resampleSources;   // per channel, into inputBuffer
+    std::vector<float*>       resampleTargets;   // per channel, into resampledInput/resampledOutput
+
+    // Fixed-shape frame buffers, reused for every Run. analysisWindows and
+    // overlapAdd hold [numChannels, windowSize]; frameInput/frameOutput hold
+    // [maxBatchFrames, numChannels, windowSize], row-major like the tensor.
+    std::vector<float> analysisWindows;  // sliding input window per channel
+    std::vector<float> frameInput;       // model input, one row per frame and channel
+    std::vector<float> frameOutput;      // passthrough output, same layout
+    std::vector<float> overlapAdd;       // overlap-add accumulators
+    std::vector<float> synthesisWindow;  // one window long; empty when hop == window
+
+    // Spectral models only: the Hann window each staged frame is multiplied
+    // by, and the frames transformed into [maxBatchFrames, numChannels,
+    // 2 * bins] magnitude/phase rows for the model's input tensor.
+    SpectralFrames     spectralFrames;
+    std::vector<float> spectralWindow;   // one window long; empty for time-domain models
+    std::vector<float> frameSpectra;
 
-    // ORT objects — accessed only on the inference thread after loadModel().
+    // Conditioning controls. controlTargets are written by the audio thread
+    // (setControls()); the inference thread ramps controlValues to them,
+    // sliding controlWindows ([kMaxControls, windowSize]) one hop per frame,
+    // and stages each frame's windows in frameControls ([maxBatchFrames,
+    // kMaxControls, windowSize]). controlStamp changes whenever the windows
+    // do, and frameControlStamps records which windows each frame staged, so
+    // models only rewrite the rows that changed.
+    std::array<std::atomic<float>, ModelControls::kMaxControls> controlTargets {};
+    std::array<float, ModelControls::kMaxControls>              controlValues {};
+    std::vector<float>    controlWindows;
+    std::vector<float>    frameControls;
+    std::vector<uint32_t> frameControlStamps;
+    uint32_t              controlStamp { 0 };           // never kUnstagedControls
+    int                   controlHopsUnsettled { 0 };   // hops until a ramp has slid out of the window
+    static constexpr uint32_t kUnstagedControls = 0xffffffff;
+
+    // Inference thread: picks the quality of each realtime hop. lastOutput
+    // holds each channel's last emitted sample, to ramp out the step when
+    // the level changes and there is no overlap-add to blend it.
+    DeadlineScheduler          scheduler;
+    DeadlineScheduler::Quality lastQuality { DeadlineScheduler::Quality::full };
+    std::vector<float>         lastOutput;
+
+    // ORT objects. Sessions come from the process-wide cache and are shared
+    // with other instances running the same model; the bindings and output
+    // buffers are ours.
 #if MOJO_ONNX_ENABLED
-    std::unique_ptr<Ort::Env>     ortEnv;
-    std::unique_ptr<Ort::Session> ortSession;
+    // What to Run for a batch of N frames lives at frameBindings[N - 1]: a
+    // single [N * channels, window] binding, or one binding per row group
+    // when the model's batch dimension is static. The tensors wrap frameInput
+    // and the model's own output buffer. Stateful models get a second set of
+    // bindings with their state buffers swapped, used on alternate hops.
+    struct FrameBindings
+    {
+        std::vector<std::unique_ptr<Ort::Value>>                    tensors;
+        std::array<std::vector<std::unique_ptr<Ort::IoBinding>>, 2> bindings;   // [ping/pong]
+    };
+
+    /** A recurrent state input the model reads and the matching output it
+        writes the next hop's state to. */
+    struct StateTensor
+    {
+        std::string          inputName, outputName;
+        std::vector<int64_t> shape;   // as declared; a dynamic (-1) dim is the batch
+    };
+
+    /** One loaded model: everything a swap has to replace at once. */
+    struct Model
+    {
+        juce::File                    file;            // or, for an embedded model:
+        const void*                   data { nullptr };
+        size_t                        numBytes { 0 };
+        std::shared_ptr<Ort::Session> session;         // realtime: one intra-op thread
+        std::shared_ptr<Ort::Session> offlineSession;  // offline: all cores, acquired at load or by setOfflineMode()
+        int window { 0 };                              // > 0 when static; the FFT size for spectral models
+        int batch  { 0 };                              // > 0 when static
+        int hop    { 0 };                              // > 0 when declared in metadata
+        int sampleRate { 0 };                          // > 0 when declared in metadata
+        bool spectral { false };                       // [batch, 2, bins] magnitude/phase I/O
+
+        std::vector<StateTensor> states;               // empty for stateless models
+        ModelControls            controls;             // empty for unconditioned models
+
+        std::vector<float>              output;        // [maxBatchFrames, channels, window]
+        std::vector<float>              spectralOutput; // spectral models: [maxBatchFrames, channels, 2 * bins]
+        std::vector<std::vector<float>> stateBuffers;  // [run][state][ping/pong]
+        std::vector<float>              controlInput;  // [maxBatchFrames, channels, controls (, window)]
+        std::vector<uint32_t>           controlStamps; // per frame: the staged windows controlInput holds
+        std::vector<FrameBindings>      frameBindings;
+        Ort::Session*                   boundSession    { nullptr };
+        int                             boundGeneration { -1 };
+        int                             stateParity     { 0 };
+
+        bool isStateful() const noexcept { return ! states.empty(); }
+    };
+
+    std::unique_ptr<Model> createModel (const juce::File& modelFile);
+    std::unique_ptr<Model> createModel (const void* modelData, size_t numBytes);
+    std::unique_ptr<Model> createModel (std::shared_ptr<Ort::Session> session);
+    std::shared_ptr<Ort::Session> acquireOfflineSession (const juce::File& modelFile, const void* modelData,
+                                                         size_t numBytes) const;
+    void adoptModel (std::unique_ptr<Model> newModel);
+    void bindModel (Model& target);
+    void warmUp (Model& target, int window);
+    float* inferWith (Model* target, int numFrames);
+    void analyseFrames (int numFrames);
+    bool fitsFraming (const Model& candidate) const noexcept;
+    void fillControls (Model& target, int numFrames);
+    void swapInPendingModel();
+
+    juce::SharedResourcePointer<SessionCache> sessionCache;  // outlives the sessions below
+
+    std::unique_ptr<Model> model;          // active; replaced under frameLock
+    std::unique_ptr<Model> fadingModel;    // previous model while crossfading out
+    std::unique_ptr<Model> fallbackModel;  // run instead of model when short of time
+
+    // Loader → inference thread: a warmed-up, bound model waiting to go live.
+    // Inference → loader: a faded-out model for the loader to free, so the
+    // inference thread never pays for tearing down a session.
+    std::atomic<Model*> pendingModel { nullptr };
+    std::atomic<Model*> retiredModel { nullptr };
+
+    // Loader → prepare()/release(): a model that needs other framing than
+    // playback has, or the other backend, waiting for the engine to be
+    // prepared again. At most one of waitingModel and waitingInline is set.
+    std::atomic<Model*> waitingModel { nullptr };
 #endif
+    std::atomic<InferenceBackend*> waitingInline { nullptr };
+
+    // Native backend. inlineBackend and fadingInline belong to the audio
+    // thread while playing; the loader hands replacements over through
+    // pendingInline and gets faded-out ones back through retiredInline.
+    std::unique_ptr<InferenceBackend> inlineBackend;
+    std::unique_ptr<InferenceBackend> fadingInline;
+    std::atomic<InferenceBackend*>    pendingInline { nullptr };
+    std::atomic<InferenceBackend*>    retiredInline { nullptr };
+    juce::AudioBuffer<float>          inlineScratch;   // the old model's output while fading
+    int                               inlineFadePosition { 0 };
+
+    int frameGeneration   { 0 };   // bumped whenever the frame geometry changes
+    int crossfadeFrame    { 0 };
+    int crossfadeFrames   { 0 };
+
+    mutable juce::CriticalSection statusLock;
+    LoadStatus loadStatus;
+    ModelControls activeControls;   // what getControls() reports; under statusLock
+
+    mutable juce::CriticalSection threadingLock;
+    EngineThreading threading;
+
+    juce::ThreadPool loader { juce::ThreadPoolOptions{}
+                                  .withThreadName ("ModelLoader")
+                                  .withNumberOfThreads (1)
+                                  .withDesiredThreadPriority (juce::Thread::Priority::background) };
+
+    EngineTelemetry telemetry;
+    std::atomic<SessionTrace*> sessionTrace { nullptr };
+
+    // Held by the inference thread while it processes frames, and by
+    // prepare()/loadModel()/setOutputFifo() while they swap buffers. The
+    // loader only takes it briefly to bind a model, never while loading.
+    juce::CriticalSection frameLock;
 
-    juce::WaitableEvent inferenceWakeup;
+    WorkerWakeup inferenceWakeup;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InferenceEngine)
 };
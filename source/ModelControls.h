@@ -0,0 +1,105 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * The conditioning controls a model declares: knobs such as drive or tone
+ * that the network takes as a second input tensor, "controls", next to the
+ * audio, so one model covers every setting instead of one model per setting.
+ *
+ * The tensor is either [batch, controls], one value per control per frame,
+ * or [batch, controls, window], one per sample. Names and ranges come from
+ * the model's "mojo.controls" metadata entry, in tensor order:
+ *
+ *   "drive=0.5:8:2,tone=-1:1:0"     (name=minimum:maximum:default)
+ *
+ * Controls the entry leaves out are called "Control n" and run from 0 to 1.
+ *
+ * A plugin's parameter list cannot change once the host has it, so the
+ * processor exposes kMaxControls generic, normalised (0..1) parameters and
+ * the loaded model's declaration names them and maps them to its ranges.
+ */
+struct ModelControls
+{
+    /** Most controls a model may take; the number of generic parameters. */
+    static constexpr int kMaxControls = 8;
+
+    struct Control
+    {
+        juce::String name;
+        float minimum      = 0.0f;
+        float maximum      = 1.0f;
+        float defaultValue = 0.0f;
+
+        /** The value the model sees for a normalised 0..1 parameter value. */
+        float fromNormalised (float normalised) const noexcept
+        {
+            return minimum + juce::jlimit (0.0f, 1.0f, normalised) * (maximum - minimum);
+        }
+
+        float toNormalised (float value) const noexcept
+        {
+            return maximum != minimum ? juce::jlimit (0.0f, 1.0f, (value - minimum) / (maximum - minimum)) : 0.0f;
+        }
+
+        bool operator== (const Control& other) const noexcept
+        {
+            return name == other.name && minimum == other.minimum && maximum == other.maximum
+                && defaultValue == other.defaultValue;
+        }
+    };
+
+    std::vector<Control> controls;   // in tensor order; empty for unconditioned models
+    bool perSample = false;          // [batch, controls, window] rather than [batch, controls]
+
+    int size() const noexcept        { return (int) controls.size(); }
+    bool isEmpty() const noexcept    { return controls.empty(); }
+
+    bool operator== (const ModelControls& other) const noexcept
+    {
+        return controls == other.controls && perSample == other.perSample;
+    }
+
+    bool operator!= (const ModelControls& other) const noexcept { return ! operator== (other); }
+
+    /** Builds the declaration for a model whose controls tensor has
+        numControls entries, from its "mojo.controls" metadata (which may be
+        empty). Malformed or missing entries fall back to the defaults. */
+    static ModelControls parse (const juce::String& declared, int numControls, bool perSample)
+    {
+        ModelControls result;
+        result.perSample = perSample;
+
+        const auto entries = juce::StringArray::fromTokens (declared, ",", {});
+
+        for (int i = 0; i < juce::jlimit (0, kMaxControls, numControls); ++i)
+        {
+            Control control;
+            control.name = "Control " + juce::String (i + 1);
+
+            const auto entry = entries[i].trim();
+            const auto name  = entry.upToFirstOccurrenceOf ("=", false, false).trim();
+
+            if (name.isNotEmpty())
+                control.name = name;
+
+            const auto range = juce::StringArray::fromTokens (entry.fromFirstOccurrenceOf ("=", false, false), ":", {});
+
+            if (range.size() >= 2 && range[0].trim().containsOnly ("0123456789.-+eE")
+                                  && range[1].trim().containsOnly ("0123456789.-+eE")
+                                  && range[0].getFloatValue() < range[1].getFloatValue())
+            {
+                control.minimum = range[0].getFloatValue();
+                control.maximum = range[1].getFloatValue();
+            }
+
+            control.defaultValue = range.size() >= 3 ? juce::jlimit (control.minimum, control.maximum,
+                                                                     range[2].getFloatValue())
+                                                     : control.minimum;
+
+            result.controls.push_back (control);
+        }
+
+        return result;
+    }
+};
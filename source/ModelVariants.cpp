@@ -0,0 +1,292 @@
+#include "ModelVariants.h"
+#include "InferenceEngine.h"
+
+#include <future>
+
+namespace
+{
+    struct Render
+    {
+        juce::AudioBuffer<float> output;
+        double                   microsPerRun = 0.0;
+        juce::String             error;
+    };
+
+    /** Streams reference through modelFile offline, as a bounce would, and
+        keeps the (latency-delayed) output. The first block pays for ORT's
+        lazy setup, so Runs are only timed from the second one on. */
+    Render renderOffline (const juce::File& modelFile, const juce::AudioBuffer<float>& reference)
+    {
+        constexpr int kBlockSize = ModelVariants::kVerifyBlockSize;
+
+        Render render;
+        const int numChannels = reference.getNumChannels();
+        const int length      = reference.getNumSamples();
+
+        // Quantized graphs never run natively; keep the comparison on one runtime.
+        InferenceEngine engine;
+        engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+
+        if (! engine.loadModel (modelFile))
+        {
+            render.error = engine.getLoadStatus().message;
+            return render;
+        }
+
+        engine.setOfflineMode (true);
+        engine.prepare (numChannels, kBlockSize);
+
+        const int fifoSize = engine.getRequiredOutputFifoSize();
+        SpscFifo fifo (fifoSize);
+        juce::AudioBuffer<float> storage (numChannels, fifoSize);
+        engine.setOutputFifo (&fifo, &storage);
+
+        render.output.setSize (numChannels, length);
+        render.output.clear();
+
+        std::vector<const float*> channels ((size_t) numChannels);
+        juce::int64 timedTicks = 0;
+        uint64_t runsBeforeTiming = 0;
+        int written = 0;
+
+        for (int position = 0; position < length; position += kBlockSize)
+        {
+            const int numSamples = juce::jmin (kBlockSize, length - position);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[(size_t) ch] = reference.getReadPointer (ch, position);
+
+            engine.submitInput (channels.data(), numChannels, numSamples);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            engine.processPendingInput();
+
+            if (position == 0)
+                runsBeforeTiming = engine.getTelemetry().getSnapshot().runs;
+            else
+                timedTicks += juce::Time::getHighResolutionTicks() - start;
+
+            const auto scope = fifo.read (juce::jmin (fifo.getNumReady(), length - written));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                render.output.copyFrom (ch, written, storage, ch, scope.startIndex1, scope.blockSize1);
+                render.output.copyFrom (ch, written + scope.blockSize1, storage, ch, scope.startIndex2, scope.blockSize2);
+            }
+
+            written += scope.blockSize1 + scope.blockSize2;
+        }
+
+        const auto timedRuns = engine.getTelemetry().getSnapshot().runs - runsBeforeTiming;
+        render.microsPerRun = timedRuns > 0 ? juce::Time::highResolutionTicksToSeconds (timedTicks) * 1.0e6 / (double) timedRuns
+                                            : 0.0;
+        return render;
+    }
+}
+
+//==============================================================================
+juce::String ModelVariants::getName (Precision precision)
+{
+    switch (precision)
+    {
+        case Precision::float32:   return "float32";
+        case Precision::fp16:      return "fp16";
+        case Precision::int8:      return "int8";
+        case Precision::automatic: return "automatic";
+    }
+
+    return {};
+}
+
+juce::File ModelVariants::getFile (const juce::File& floatModel, Precision precision)
+{
+    if (precision != Precision::fp16 && precision != Precision::int8)
+        return floatModel;
+
+    return floatModel.getSiblingFile (floatModel.getFileNameWithoutExtension() + "." + getName (precision)
+                                        + floatModel.getFileExtension());
+}
+
+ModelVariants::Error ModelVariants::measureError (const juce::AudioBuffer<float>& reference,
+                                                  const juce::AudioBuffer<float>& test)
+{
+    const int numChannels = juce::jmin (reference.getNumChannels(), test.getNumChannels());
+    const int length      = juce::jmin (reference.getNumSamples(),  test.getNumSamples());
+
+    double signal = 0.0, noise = 0.0;
+    Error error;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* const ref = reference.getReadPointer (ch);
+        const float* const out = test.getReadPointer (ch);
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto diff = (double) out[i] - (double) ref[i];
+            signal += (double) ref[i] * (double) ref[i];
+            noise  += diff * diff;
+            error.maxAbs = juce::jmax (error.maxAbs, std::abs (diff));
+        }
+    }
+
+    error.snrDb = noise == 0.0  ? std::numeric_limits<double>::infinity()
+                : signal == 0.0 ? -std::numeric_limits<double>::infinity()
+                                : 10.0 * std::log10 (signal / noise);
+    return error;
+}
+
+ModelVariants::Report ModelVariants::verify (const juce::File& floatModel, Precision variant,
+                                             const juce::AudioBuffer<float>& reference, const Tolerance& tolerance)
+{
+    Report report;
+    report.precision = variant;
+
+    const auto variantFile = getFile (floatModel, variant);
+    report.found = variantFile != floatModel && variantFile.existsAsFile();
+
+    if (! report.found)
+    {
+        report.reason = "no " + getName (variant) + " variant of " + floatModel.getFileName();
+        return report;
+    }
+
+    const auto floatRender   = renderOffline (floatModel,  reference);
+    const auto variantRender = renderOffline (variantFile, reference);
+
+    if (floatRender.error.isNotEmpty() || variantRender.error.isNotEmpty())
+    {
+        report.reason = floatRender.error.isNotEmpty() ? floatRender.error : variantRender.error;
+        return report;
+    }
+
+    report.floatRunMicros   = floatRender.microsPerRun;
+    report.variantRunMicros = variantRender.microsPerRun;
+    report.speedup          = variantRender.microsPerRun > 0.0 ? floatRender.microsPerRun / variantRender.microsPerRun : 0.0;
+    report.error            = measureError (floatRender.output, variantRender.output);
+
+    report.accepted = report.error.snrDb >= tolerance.minSnrDb && report.error.maxAbs <= tolerance.maxAbsError;
+
+    if (! report.accepted)
+        report.reason = getName (variant) + " is " + juce::String (report.error.snrDb, 1) + " dB SNR, "
+                      + juce::String (report.error.maxAbs, 5) + " max error; needs "
+                      + juce::String (tolerance.minSnrDb, 1) + " dB and "
+                      + juce::String (tolerance.maxAbsError, 5);
+
+    return report;
+}
+
+juce::File ModelVariants::select (const juce::File& floatModel, Precision precision, juce::String& note)
+{
+    note.clear();
+
+    if (precision == Precision::float32)
+        return floatModel;
+
+    if (precision != Precision::automatic)
+    {
+        const auto variantFile = getFile (floatModel, precision);
+        if (variantFile.existsAsFile())
+            return variantFile;
+
+        note = "no " + getName (precision) + " variant, using float32";
+        return floatModel;
+    }
+
+    // Verdicts by variant and float model, each by path and modification
+    // time, shared by every instance in the process. Verifying renders audio
+    // through two sessions, so it happens outside the lock: a verdict still
+    // being reached is a future that only loads of the same pair wait on.
+    static juce::CriticalSection cacheLock;
+    static std::map<juce::String, std::shared_future<bool>> verdicts;
+
+    const auto stamp = [] (const juce::File& file)
+    {
+        return file.getFullPathName() + "@" + juce::String (file.getLastModificationTime().toMilliseconds());
+    };
+
+    for (auto candidate : { Precision::int8, Precision::fp16 })
+    {
+        const auto variantFile = getFile (floatModel, candidate);
+        if (! variantFile.existsAsFile())
+            continue;
+
+        const auto key = stamp (variantFile) + "|" + stamp (floatModel);
+
+        std::promise<bool> reached;
+        std::shared_future<bool> verdict;
+        bool verifyHere = false;
+
+        {
+            const juce::ScopedLock sl (cacheLock);
+
+            if (const auto it = verdicts.find (key); it != verdicts.end())
+            {
+                verdict = it->second;
+            }
+            else
+            {
+                verdict = verdicts[key] = reached.get_future().share();
+                verifyHere = true;
+            }
+        }
+
+        if (verifyHere)
+        {
+            const auto report = verify (floatModel, candidate, makeReferenceSignal (1, 48000.0, 2.0));
+            reached.set_value (report.accepted);
+
+            if (! report.accepted)
+                DBG ("Refused " << variantFile.getFileName() << ": " << report.reason);
+        }
+
+        if (verdict.get())
+        {
+            note = getName (candidate) + ", verified";
+            return variantFile;
+        }
+
+        note = getName (candidate) + " refused";
+    }
+
+    if (note.isNotEmpty())
+        note << ", using float32";
+
+    return floatModel;
+}
+
+juce::AudioBuffer<float> ModelVariants::makeReferenceSignal (int numChannels, double sampleRate, double seconds)
+{
+    const int length = juce::jmax (1, (int) (sampleRate * seconds));
+    const int sweepEnd = length / 2, noiseEnd = length * 7 / 8;
+
+    juce::AudioBuffer<float> signal (juce::jmax (1, numChannels), length);
+    signal.clear();
+
+    constexpr double kStartHz = 20.0;
+    const double endHz = juce::jmin (20000.0, 0.45 * sampleRate);
+    const double sweepSeconds = (double) sweepEnd / sampleRate;
+    const double rate = std::log (endHz / kStartHz);
+
+    for (int ch = 0; ch < signal.getNumChannels(); ++ch)
+    {
+        float* const out = signal.getWritePointer (ch);
+        juce::Random random (1234 + ch);
+
+        // Exponential sweep, its level stepping from -30 to 0 dBFS in
+        // quarters so the model is exercised at several drive levels.
+        for (int i = 0; i < sweepEnd; ++i)
+        {
+            const double t = (double) i / sampleRate;
+            const double phase = juce::MathConstants<double>::twoPi * kStartHz * sweepSeconds / rate
+                               * (std::exp (t / sweepSeconds * rate) - 1.0);
+            const float gain = juce::Decibels::decibelsToGain (-30.0f + 10.0f * (float) (4 * i / sweepEnd));
+            out[i] = gain * (float) std::sin (phase + 0.5 * ch);
+        }
+
+        for (int i = sweepEnd; i < noiseEnd; ++i)
+            out[i] = 0.5f * (random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    return signal;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Quantized builds of a model, kept next to the float one on disk:
+ *
+ *   amp.onnx        float32 — the reference
+ *   amp.fp16.onnx   FP16 weights (onnxconverter_common.float16, keep_io_types)
+ *   amp.int8.onnx   dynamic INT8 (onnxruntime.quantization.quantize_dynamic)
+ *
+ * verify() pushes reference audio through the float model and one variant,
+ * each in its own offline InferenceEngine with identical framing, and
+ * reports how much faster the variant's Runs were and how far its output
+ * moved (SNR and peak error against the float output). A variant outside
+ * the tolerance is refused.
+ *
+ * select() turns a precision setting into the file to load. The automatic
+ * setting verifies int8, then fp16, on a built-in test signal and takes the
+ * first one that passes; results are cached per variant and float model
+ * file, so instances opening the same model verify it once, and
+ * re-exporting either file verifies again.
+ */
+class ModelVariants
+{
+public:
+    enum class Precision
+    {
+        float32,    // always the float model
+        fp16,       // the fp16 variant if there is one, unverified
+        int8,       // the int8 variant if there is one, unverified
+        automatic   // the fastest variant that passes verify(), else float32
+    };
+
+    /** "float32", "fp16", "int8" or "automatic". */
+    static juce::String getName (Precision);
+
+    /** Where the given variant of floatModel lives. float32 (and automatic)
+        is floatModel itself. */
+    static juce::File getFile (const juce::File& floatModel, Precision);
+
+    //==============================================================================
+    struct Tolerance
+    {
+        double minSnrDb    = 40.0;    // against the float model's output
+        double maxAbsError = 1.0e-2;  // largest single-sample difference
+    };
+
+    struct Error
+    {
+        double snrDb    = 0.0;   // +inf when identical
+        double maxAbs   = 0.0;
+    };
+
+    /** Error of test against reference over their common length, across all
+        common channels. */
+    static Error measureError (const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& test);
+
+    struct Report
+    {
+        Precision    precision        = Precision::float32;
+        bool         found            = false;   // the variant file exists
+        bool         accepted         = false;   // found, ran, and within tolerance
+        double       floatRunMicros   = 0.0;     // mean per Run
+        double       variantRunMicros = 0.0;
+        double       speedup          = 0.0;     // float time / variant time
+        Error        error;
+        juce::String reason;                     // why it was refused
+    };
+
+    /** Renders reference through floatModel and its variant (offline, on
+        ONNX Runtime) and compares the two. Runs on the calling thread and
+        takes as long as both renders; never call it from the audio thread. */
+    static Report verify (const juce::File& floatModel, Precision variant,
+                          const juce::AudioBuffer<float>& reference, const Tolerance& tolerance = {});
+
+    /** The file to load for floatModel at the given precision. note says
+        which variant was chosen and why, for the load status. */
+    static juce::File select (const juce::File& floatModel, Precision, juce::String& note);
+
+    /** A deterministic test signal: an exponential sine sweep over a stepped
+        level ramp, then white noise, then silence. */
+    static juce::AudioBuffer<float> makeReferenceSignal (int numChannels, double sampleRate, double seconds);
+
+    /** Host block size the verification renders are driven with. */
+    static constexpr int kVerifyBlockSize = 512;
+};
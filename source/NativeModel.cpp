@@ -0,0 +1,930 @@
+#include "NativeModel.h"
+
+namespace
+{
+    using Register = NativeModel::Register;
+    using Layer    = NativeModel::Layer;
+    using Tensor   = OnnxGraph::Tensor;
+
+    constexpr int kLanes = NativeModel::kLanes;
+
+    constexpr int registersFor (int features) noexcept { return (features + kLanes - 1) / kLanes; }
+
+    inline float*       lanes (Register* r) noexcept       { return reinterpret_cast<float*> (r); }
+    inline const float* lanes (const Register* r) noexcept { return reinterpret_cast<const float*> (r); }
+
+    /** A register-padded vector of features. */
+    std::vector<Register> makeVector (int features, float fill = 0.0f)
+    {
+        std::vector<Register> v ((size_t) registersFor (features), Register::expand (0.0f));
+        for (int i = 0; i < features; ++i)
+            lanes (v.data())[i] = fill;
+
+        return v;
+    }
+
+    /** Column-major weights: column c holds every output's weight for input c,
+        padded to whole registers, so y += W·x is one broadcast-multiply-add
+        per input per register. */
+    struct Matrix
+    {
+        Matrix (int numRows, int numCols)
+            : rows (numRows), cols (numCols), regs (registersFor (numRows)),
+              data ((size_t) (numCols * regs), Register::expand (0.0f)) {}
+
+        void set (int row, int col, float value) noexcept { lanes (data.data() + col * regs)[row] = value; }
+        const Register* column (int col) const noexcept   { return data.data() + col * regs; }
+
+        int rows, cols, regs;
+        std::vector<Register> data;
+    };
+
+    /** acc += W·x for an R-register-tall W. */
+    template <int R>
+    inline void multiplyAccumulate (Register* acc, const Matrix& w, const float* x) noexcept
+    {
+        for (int c = 0; c < w.cols; ++c)
+        {
+            const auto xc = Register::expand (x[c]);
+            const auto* column = w.column (c);
+
+            for (int r = 0; r < R; ++r)
+                acc[r] = Register::multiplyAdd (acc[r], xc, column[r]);
+        }
+    }
+
+    template <int R>
+    inline void load (Register* dst, const std::vector<Register>& src) noexcept
+    {
+        for (int r = 0; r < R; ++r)
+            dst[r] = src[(size_t) r];
+    }
+
+    inline void applyTanh (float* v, int n) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+            v[i] = std::tanh (v[i]);
+    }
+
+    inline void applySigmoid (float* v, int n) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+            v[i] = 1.0f / (1.0f + std::exp (-v[i]));
+    }
+
+    //==============================================================================
+    struct DenseWeights
+    {
+        DenseWeights (int outputs, int inputs) : w (outputs, inputs), bias (makeVector (outputs)) {}
+
+        Matrix w;
+        std::vector<Register> bias;
+    };
+
+    template <int R>
+    class Dense : public Layer
+    {
+    public:
+        explicit Dense (std::shared_ptr<const DenseWeights> weights) : p (std::move (weights)) {}
+
+        int getInputSize() const noexcept override  { return p->w.cols; }
+        int getOutputSize() const noexcept override { return p->w.rows; }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            Register acc[R];
+            load<R> (acc, p->bias);
+            multiplyAccumulate<R> (acc, p->w, lanes (in));
+
+            for (int r = 0; r < R; ++r)
+                out[r] = acc[r];
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Dense> (*this); }
+
+    private:
+        std::shared_ptr<const DenseWeights> p;
+    };
+
+    //==============================================================================
+    /** y = x * scale + offset, per feature. */
+    struct AffineWeights
+    {
+        explicit AffineWeights (int features)
+            : size (features), scale (makeVector (features, 1.0f)), offset (makeVector (features)) {}
+
+        int size;
+        std::vector<Register> scale, offset;
+    };
+
+    template <int R>
+    class Affine : public Layer
+    {
+    public:
+        explicit Affine (std::shared_ptr<const AffineWeights> weights) : p (std::move (weights)) {}
+
+        int getInputSize() const noexcept override  { return p->size; }
+        int getOutputSize() const noexcept override { return p->size; }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            for (int r = 0; r < R; ++r)
+                out[r] = Register::multiplyAdd (p->offset[(size_t) r], in[r], p->scale[(size_t) r]);
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Affine> (*this); }
+
+    private:
+        std::shared_ptr<const AffineWeights> p;
+    };
+
+    //==============================================================================
+    class Activation : public Layer
+    {
+    public:
+        enum class Kind { tanh, sigmoid, relu };
+
+        Activation (Kind k, int features) : kind (k), size (features) {}
+
+        int getInputSize() const noexcept override  { return size; }
+        int getOutputSize() const noexcept override { return size; }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            const auto numRegisters = registersFor (size);
+
+            if (kind == Kind::relu)
+            {
+                const auto zero = Register::expand (0.0f);
+                for (int r = 0; r < numRegisters; ++r)
+                    out[r] = Register::max (in[r], zero);
+
+                return;
+            }
+
+            for (int r = 0; r < numRegisters; ++r)
+                out[r] = in[r];
+
+            if (kind == Kind::tanh)
+                applyTanh (lanes (out), size);
+            else
+                applySigmoid (lanes (out), size);
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Activation> (*this); }
+
+    private:
+        Kind kind;
+        int size;
+    };
+
+    //==============================================================================
+    /** ONNX GRU, gates in z, r, h order. */
+    struct GruWeights
+    {
+        GruWeights (int hiddenSize, int inputSize, bool resetAfterMatMul)
+            : hidden (hiddenSize), linearBeforeReset (resetAfterMatMul),
+              wz (hiddenSize, inputSize),  wr (hiddenSize, inputSize),  wh (hiddenSize, inputSize),
+              rz (hiddenSize, hiddenSize), rr (hiddenSize, hiddenSize), rh (hiddenSize, hiddenSize),
+              bz (makeVector (hiddenSize)), br (makeVector (hiddenSize)),
+              bwh (makeVector (hiddenSize)), brh (makeVector (hiddenSize)) {}
+
+        int hidden;
+        bool linearBeforeReset;
+        Matrix wz, wr, wh, rz, rr, rh;
+        std::vector<Register> bz, br;   // input and recurrent biases summed
+        std::vector<Register> bwh, brh; // kept apart: the reset gate sits between them
+    };
+
+    template <int R>
+    class Gru : public Layer
+    {
+    public:
+        explicit Gru (std::shared_ptr<const GruWeights> weights) : p (std::move (weights)) { reset(); }
+
+        int getInputSize() const noexcept override  { return p->wz.cols; }
+        int getOutputSize() const noexcept override { return p->hidden; }
+
+        void reset() noexcept override { state.fill (Register::expand (0.0f)); }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            const auto* x = lanes (in);
+            const auto* h = lanes (state.data());
+
+            Register z[R], r[R], n[R], recurrent[R];
+            load<R> (z, p->bz);
+            load<R> (r, p->br);
+            multiplyAccumulate<R> (z, p->wz, x);
+            multiplyAccumulate<R> (z, p->rz, h);
+            multiplyAccumulate<R> (r, p->wr, x);
+            multiplyAccumulate<R> (r, p->rr, h);
+            applySigmoid (lanes (z), p->hidden);
+            applySigmoid (lanes (r), p->hidden);
+
+            load<R> (n, p->bwh);
+            multiplyAccumulate<R> (n, p->wh, x);
+            load<R> (recurrent, p->brh);
+
+            if (p->linearBeforeReset)
+            {
+                // n = tanh (Wx + Wb + r ⊙ (Rh + Rb))
+                multiplyAccumulate<R> (recurrent, p->rh, h);
+
+                for (int i = 0; i < R; ++i)
+                    n[i] = Register::multiplyAdd (n[i], r[i], recurrent[i]);
+            }
+            else
+            {
+                // n = tanh (Wx + Wb + R(r ⊙ h) + Rb)
+                Register gated[R];
+                for (int i = 0; i < R; ++i)
+                    gated[i] = r[i] * state[(size_t) i];
+
+                multiplyAccumulate<R> (recurrent, p->rh, lanes (gated));
+
+                for (int i = 0; i < R; ++i)
+                    n[i] += recurrent[i];
+            }
+
+            applyTanh (lanes (n), p->hidden);
+
+            // h' = (1 - z) ⊙ n + z ⊙ h = n + z ⊙ (h - n)
+            for (int i = 0; i < R; ++i)
+            {
+                state[(size_t) i] = Register::multiplyAdd (n[i], z[i], state[(size_t) i] - n[i]);
+                out[i] = state[(size_t) i];
+            }
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Gru> (*this); }
+
+    private:
+        std::shared_ptr<const GruWeights> p;
+        std::array<Register, (size_t) R> state;
+    };
+
+    //==============================================================================
+    /** ONNX LSTM, gates in i, o, f, c order; no peepholes. */
+    struct LstmWeights
+    {
+        LstmWeights (int hiddenSize, int inputSize)
+            : hidden (hiddenSize),
+              wi (hiddenSize, inputSize),  wo (hiddenSize, inputSize),  wf (hiddenSize, inputSize),  wc (hiddenSize, inputSize),
+              ri (hiddenSize, hiddenSize), ro (hiddenSize, hiddenSize), rf (hiddenSize, hiddenSize), rc (hiddenSize, hiddenSize),
+              bi (makeVector (hiddenSize)), bo (makeVector (hiddenSize)),
+              bf (makeVector (hiddenSize)), bc (makeVector (hiddenSize)) {}
+
+        int hidden;
+        Matrix wi, wo, wf, wc, ri, ro, rf, rc;
+        std::vector<Register> bi, bo, bf, bc;   // input and recurrent biases summed
+    };
+
+    template <int R>
+    class Lstm : public Layer
+    {
+    public:
+        explicit Lstm (std::shared_ptr<const LstmWeights> weights) : p (std::move (weights)) { reset(); }
+
+        int getInputSize() const noexcept override  { return p->wi.cols; }
+        int getOutputSize() const noexcept override { return p->hidden; }
+
+        void reset() noexcept override
+        {
+            hiddenState.fill (Register::expand (0.0f));
+            cellState.fill (Register::expand (0.0f));
+        }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            const auto* x = lanes (in);
+            const auto* h = lanes (hiddenState.data());
+
+            Register i[R], o[R], f[R], c[R];
+            load<R> (i, p->bi);
+            load<R> (o, p->bo);
+            load<R> (f, p->bf);
+            load<R> (c, p->bc);
+
+            multiplyAccumulate<R> (i, p->wi, x);
+            multiplyAccumulate<R> (i, p->ri, h);
+            multiplyAccumulate<R> (o, p->wo, x);
+            multiplyAccumulate<R> (o, p->ro, h);
+            multiplyAccumulate<R> (f, p->wf, x);
+            multiplyAccumulate<R> (f, p->rf, h);
+            multiplyAccumulate<R> (c, p->wc, x);
+            multiplyAccumulate<R> (c, p->rc, h);
+
+            applySigmoid (lanes (i), p->hidden);
+            applySigmoid (lanes (o), p->hidden);
+            applySigmoid (lanes (f), p->hidden);
+            applyTanh (lanes (c), p->hidden);
+
+            // C' = f ⊙ C + i ⊙ c,  h' = o ⊙ tanh (C')
+            Register squashed[R];
+            for (int r = 0; r < R; ++r)
+            {
+                cellState[(size_t) r] = Register::multiplyAdd (f[r] * cellState[(size_t) r], i[r], c[r]);
+                squashed[r] = cellState[(size_t) r];
+            }
+
+            applyTanh (lanes (squashed), p->hidden);
+
+            for (int r = 0; r < R; ++r)
+            {
+                hiddenState[(size_t) r] = o[r] * squashed[r];
+                out[r] = hiddenState[(size_t) r];
+            }
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Lstm> (*this); }
+
+    private:
+        std::shared_ptr<const LstmWeights> p;
+        std::array<Register, (size_t) R> hiddenState, cellState;
+    };
+
+    //==============================================================================
+    /** A causal 1-D convolution: tap k of K sees the input from (K-1-k)·dilation
+        steps ago. */
+    struct ConvWeights
+    {
+        ConvWeights (int outputs, int inputs, int kernelSize, int dilationSteps)
+            : dilation (dilationSteps), span ((kernelSize - 1) * dilationSteps + 1),
+              taps ((size_t) kernelSize, Matrix (outputs, inputs)), bias (makeVector (outputs)) {}
+
+        int dilation, span;
+        std::vector<Matrix> taps;
+        std::vector<Register> bias;
+    };
+
+    template <int R>
+    class Conv1D : public Layer
+    {
+    public:
+        explicit Conv1D (std::shared_ptr<const ConvWeights> weights)
+            : p (std::move (weights)),
+              history ((size_t) (p->span * getInputSize()), 0.0f) {}
+
+        int getInputSize() const noexcept override  { return p->taps.front().cols; }
+        int getOutputSize() const noexcept override { return p->taps.front().rows; }
+
+        void reset() noexcept override
+        {
+            std::fill (history.begin(), history.end(), 0.0f);
+            writePosition = 0;
+        }
+
+        void step (const Register* in, Register* out) noexcept override
+        {
+            const auto inputs = getInputSize();
+            std::copy (lanes (in), lanes (in) + inputs, history.data() + writePosition * inputs);
+
+            Register acc[R];
+            load<R> (acc, p->bias);
+
+            const auto numTaps = (int) p->taps.size();
+            for (int k = 0; k < numTaps; ++k)
+            {
+                auto slot = writePosition - (numTaps - 1 - k) * p->dilation;
+                if (slot < 0)
+                    slot += p->span;
+
+                multiplyAccumulate<R> (acc, p->taps[(size_t) k], history.data() + slot * inputs);
+            }
+
+            for (int r = 0; r < R; ++r)
+                out[r] = acc[r];
+
+            writePosition = (writePosition + 1) % p->span;
+        }
+
+        std::unique_ptr<Layer> clone() const override { return std::make_unique<Conv1D> (*this); }
+
+    private:
+        std::shared_ptr<const ConvWeights> p;
+        std::vector<float> history;
+        int writePosition = 0;
+    };
+
+    //==============================================================================
+    /** Instantiates LayerType<R> for the smallest R that holds the layer, so
+        each width gets its own fully unrolled kernels. */
+    template <template <int> class LayerType, int R = 1, typename Weights>
+    std::unique_ptr<Layer> makeSized (int numRegisters, std::shared_ptr<const Weights> weights)
+    {
+        if constexpr (R > NativeModel::kMaxRegisters)
+        {
+            jassertfalse;
+            return nullptr;
+        }
+        else
+        {
+            if (numRegisters == R)
+                return std::make_unique<LayerType<R>> (std::move (weights));
+
+            return makeSized<LayerType, R + 1> (numRegisters, std::move (weights));
+        }
+    }
+
+    //==============================================================================
+    /** Initialisers and Constant node outputs, by name. */
+    class Constants
+    {
+    public:
+        explicit Constants (const OnnxGraph& graph)
+        {
+            for (const auto& [name, tensor] : graph.initializers)
+                tensors[name] = &tensor;
+
+            for (const auto& node : graph.nodes)
+                if (node.opType == "Constant" && ! node.outputs.empty() && node.hasAttribute ("value"))
+                    tensors[node.outputs.front()] = &node.attributes.at ("value").t;
+        }
+
+        /** A float constant, or nullptr. */
+        const Tensor* find (const std::string& name) const
+        {
+            const auto it = tensors.find (name);
+            return it != tensors.end() && ! it->second->data.empty() ? it->second : nullptr;
+        }
+
+        /** The first float constant that does not hold as many values as its
+            dims say (weights are indexed by the dims), or an empty name. */
+        std::string findMalformed() const
+        {
+            for (const auto& [name, tensor] : tensors)
+                if (! tensor->data.empty() && tensor->data.size() != tensor->getNumElements())
+                    return name;
+
+            return {};
+        }
+
+    private:
+        std::map<std::string, const Tensor*> tensors;
+    };
+
+    bool hasInput (const OnnxGraph::Node& node, size_t index)
+    {
+        return node.inputs.size() > index && ! node.inputs[index].empty();
+    }
+
+    juce::String describe (const OnnxGraph::Node& node)
+    {
+        return juce::String (node.opType) + (node.name.empty() ? juce::String() : " '" + juce::String (node.name) + "'");
+    }
+
+    bool isForward (const OnnxGraph::Node& node)
+    {
+        return node.getString ("direction", "forward") == "forward" && ! node.hasAttribute ("activations")
+            && ! node.hasAttribute ("clip");
+    }
+}
+
+//==============================================================================
+std::unique_ptr<NativeModel> NativeModel::fromFile (const juce::File& modelFile, juce::String& error)
+{
+    const juce::MemoryMappedFile bytes (modelFile, juce::MemoryMappedFile::readOnly);
+    if (bytes.getData() == nullptr || bytes.getSize() == 0)
+    {
+        error = "cannot read " + modelFile.getFileName();
+        return nullptr;
+    }
+
+    return fromMemory (bytes.getData(), bytes.getSize(), error);
+}
+
+std::unique_ptr<NativeModel> NativeModel::fromMemory (const void* modelData, size_t numBytes, juce::String& error)
+{
+    OnnxGraph graph;
+    if (! OnnxGraph::parse (modelData, numBytes, graph, error))
+        return nullptr;
+
+    return fromGraph (graph, error);
+}
+
+std::unique_ptr<NativeModel> NativeModel::fromGraph (const OnnxGraph& graph, juce::String& error)
+{
+    const auto pickNamed = [] (const std::vector<OnnxGraph::ValueInfo>& values, const char* preferred)
+    {
+        for (const auto& v : values)
+            if (v.name == preferred)
+                return v.name;
+
+        return values.empty() ? std::string() : values.front().name;
+    };
+
+    const auto inputName  = pickNamed (graph.inputs, "input");
+    const auto outputName = pickNamed (graph.outputs, "output");
+
+    if (inputName.empty() || outputName.empty())
+    {
+        error = "graph has no input or output";
+        return nullptr;
+    }
+
+    // Conditioned models (see ModelControls), spectral ones, with
+    // [batch, 2, bins] input, and ones trained at a fixed sample rate need
+    // the framed ONNX Runtime pipeline.
+    if (graph.metadata.count ("mojo.sample_rate") > 0)
+    {
+        error = "graph runs at a fixed sample rate";
+        return nullptr;
+    }
+
+    for (const auto& v : graph.inputs)
+    {
+        if (v.name == "controls")
+        {
+            error = "graph takes conditioning controls";
+            return nullptr;
+        }
+
+        if (v.name == inputName && v.dims.size() == 3)
+        {
+            error = "graph takes spectral frames";
+            return nullptr;
+        }
+    }
+
+    const Constants constants (graph);
+    std::unique_ptr<NativeModel> model (new NativeModel());
+
+    // The tensors that currently hold the chain's value: RNNs expose the
+    // same step through both Y and Y_h.
+    std::vector<std::string> current { inputName };
+    int width = 1;
+
+    const auto isCurrent = [&current] (const std::string& name)
+    {
+        return std::find (current.begin(), current.end(), name) != current.end();
+    };
+
+    const auto fail = [&error] (const juce::String& reason)
+    {
+        error = reason;
+        return std::unique_ptr<NativeModel>();
+    };
+
+    if (const auto malformed = constants.findMalformed(); ! malformed.empty())
+        return fail ("constant " + juce::String (malformed) + " does not hold as many values as its shape says");
+
+    const auto& nodes = graph.nodes;
+
+    for (size_t n = 0; n < nodes.size(); ++n)
+    {
+        const auto& node = nodes[n];
+        const auto& op = node.opType;
+
+        if (op == "Constant")
+            continue;
+
+        if (node.outputs.empty())
+            return fail (describe (node) + " has no output");
+
+        // Element-wise ops may take the running value on either side.
+        const bool dataOnRight = node.inputs.size() == 2 && ! isCurrent (node.inputs[0]) && isCurrent (node.inputs[1]);
+
+        if (node.inputs.empty() || ! (isCurrent (node.inputs[0]) || dataOnRight))
+            return fail (describe (node) + " is not on the single input-to-output chain");
+
+        std::unique_ptr<Layer> layer;
+        std::vector<std::string> produced { node.outputs[0] };
+
+        if (op == "Reshape" || op == "Squeeze" || op == "Unsqueeze" || op == "Flatten"
+            || op == "Transpose" || op == "Identity")
+        {
+            // One time step is a flat feature vector whichever way it is viewed.
+        }
+        else if (op == "Tanh" || op == "Sigmoid" || op == "Relu")
+        {
+            const auto kind = op == "Tanh" ? Activation::Kind::tanh
+                            : op == "Sigmoid" ? Activation::Kind::sigmoid
+                                              : Activation::Kind::relu;
+            layer = std::make_unique<Activation> (kind, width);
+        }
+        else if (op == "Mul" || op == "Add" || op == "Sub" || op == "Div")
+        {
+            const auto* c = node.inputs.size() == 2 ? constants.find (node.inputs[dataOnRight ? 0 : 1]) : nullptr;
+
+            if (c == nullptr || (c->data.size() != 1 && (int) c->data.size() != width))
+                return fail (describe (node) + " needs a scalar or per-feature constant operand");
+
+            if (op == "Div" && dataOnRight)
+                return fail (describe (node) + " divides by the signal");
+
+            auto weights = std::make_shared<AffineWeights> (width);
+
+            for (int i = 0; i < width; ++i)
+            {
+                const auto value = c->data[c->data.size() == 1 ? 0 : (size_t) i];
+                auto* scale  = lanes (weights->scale.data());
+                auto* offset = lanes (weights->offset.data());
+
+                if (op == "Mul")       scale[i] = value;
+                else if (op == "Div")  scale[i] = 1.0f / value;
+                else if (op == "Add")  offset[i] = value;
+                else if (dataOnRight)  { scale[i] = -1.0f; offset[i] = value; }   // c - x
+                else                   offset[i] = -value;
+            }
+
+            layer = makeSized<Affine> (registersFor (width), std::shared_ptr<const AffineWeights> (weights));
+        }
+        else if (op == "Gemm" || op == "MatMul")
+        {
+            const auto* b = hasInput (node, 1) ? constants.find (node.inputs[1]) : nullptr;
+
+            if (b == nullptr || b->dims.size() != 2 || node.getInt ("transA", 0) != 0)
+                return fail (describe (node) + " needs a constant 2-D weight matrix");
+
+            const bool transB = node.getInt ("transB", 0) != 0;
+            const auto inputs  = (int) b->dims[transB ? 1 : 0];
+            const auto outputs = (int) b->dims[transB ? 0 : 1];
+            const auto alpha = op == "Gemm" ? node.getFloat ("alpha", 1.0f) : 1.0f;
+
+            if (inputs != width)
+                return fail (describe (node) + " expects " + juce::String (inputs) + " features but gets " + juce::String (width));
+
+            auto weights = std::make_shared<DenseWeights> (outputs, inputs);
+
+            for (int o = 0; o < outputs; ++o)
+                for (int i = 0; i < inputs; ++i)
+                    weights->w.set (o, i, alpha * b->data[(size_t) (transB ? o * inputs + i : i * outputs + o)]);
+
+            // Gemm's C, or the Add that exporters put after a MatMul.
+            const Tensor* bias = nullptr;
+            auto beta = 1.0f;
+
+            if (op == "Gemm" && hasInput (node, 2))
+            {
+                bias = constants.find (node.inputs[2]);
+                beta = node.getFloat ("beta", 1.0f);
+            }
+            else if (op == "MatMul" && n + 1 < nodes.size() && nodes[n + 1].opType == "Add"
+                     && nodes[n + 1].inputs.size() == 2)
+            {
+                const auto& add = nodes[n + 1];
+                const auto& other = add.inputs[0] == node.outputs[0] ? add.inputs[1] : add.inputs[0];
+                const auto* candidate = constants.find (other);
+
+                if (candidate != nullptr && (candidate->data.size() == 1 || (int) candidate->data.size() == outputs))
+                {
+                    bias = candidate;
+                    produced = { add.outputs[0] };
+                    ++n;
+                }
+            }
+
+            if (bias != nullptr)
+            {
+                if (bias->data.size() != 1 && (int) bias->data.size() != outputs)
+                    return fail (describe (node) + " has a bias that does not match its outputs");
+
+                for (int o = 0; o < outputs; ++o)
+                    lanes (weights->bias.data())[o] = beta * bias->data[bias->data.size() == 1 ? 0 : (size_t) o];
+            }
+
+            if (registersFor (outputs) > kMaxRegisters)
+                return fail (describe (node) + " is wider than " + juce::String (kMaxWidth) + " features");
+
+            layer = makeSized<Dense> (registersFor (outputs), std::shared_ptr<const DenseWeights> (weights));
+            width = outputs;
+        }
+        else if (op == "Conv")
+        {
+            const auto* w = hasInput (node, 1) ? constants.find (node.inputs[1]) : nullptr;
+
+            if (w == nullptr || w->dims.size() != 3)
+                return fail (describe (node) + " needs a constant 1-D kernel");
+
+            const auto strides   = node.getInts ("strides");
+            const auto dilations = node.getInts ("dilations");
+
+            if (node.getInt ("group", 1) != 1 || (! strides.empty() && strides.front() != 1))
+                return fail (describe (node) + " uses groups or strides");
+
+            const auto outputs    = (int) w->dims[0];
+            const auto inputs     = (int) w->dims[1];
+            const auto kernelSize = (int) w->dims[2];
+            const auto dilation   = dilations.empty() ? 1 : (int) dilations.front();
+
+            if (inputs != width)
+                return fail (describe (node) + " expects " + juce::String (inputs) + " channels but gets " + juce::String (width));
+
+            // Streaming, every output sample sees the kernel's span of past
+            // input. That is a causal conv (padded on the left only) or an
+            // unpadded one; anything padded on the right would look ahead.
+            const auto pads    = node.getInts ("pads");
+            const auto autoPad = node.getString ("auto_pad", "NOTSET");
+            const auto span    = (int64_t) (kernelSize - 1) * dilation;
+            const bool unpadded = std::all_of (pads.begin(), pads.end(), [] (int64_t p) { return p == 0; });
+            const bool causal   = pads.size() == 2 && pads[0] == span && pads[1] == 0;
+
+            if ((autoPad != "NOTSET" && autoPad != "VALID") || ! (unpadded || causal))
+                return fail (describe (node) + " is padded to look ahead; only causal (left) padding runs streaming");
+
+            if (registersFor (outputs) > kMaxRegisters)
+                return fail (describe (node) + " is wider than " + juce::String (kMaxWidth) + " channels");
+
+            auto weights = std::make_shared<ConvWeights> (outputs, inputs, kernelSize, dilation);
+
+            for (int k = 0; k < kernelSize; ++k)
+                for (int o = 0; o < outputs; ++o)
+                    for (int i = 0; i < inputs; ++i)
+                        weights->taps[(size_t) k].set (o, i, w->data[(size_t) ((o * inputs + i) * kernelSize + k)]);
+
+            if (hasInput (node, 2))
+                if (const auto* bias = constants.find (node.inputs[2]); bias != nullptr && (int) bias->data.size() == outputs)
+                    for (int o = 0; o < outputs; ++o)
+                        lanes (weights->bias.data())[o] = bias->data[(size_t) o];
+
+            layer = makeSized<Conv1D> (registersFor (outputs), std::shared_ptr<const ConvWeights> (weights));
+            width = outputs;
+        }
+        else if (op == "GRU" || op == "LSTM")
+        {
+            const auto numGates = op == "GRU" ? 3 : 4;
+            const auto* w = hasInput (node, 1) ? constants.find (node.inputs[1]) : nullptr;
+            const auto* r = hasInput (node, 2) ? constants.find (node.inputs[2]) : nullptr;
+            const auto* b = hasInput (node, 3) ? constants.find (node.inputs[3]) : nullptr;
+            const auto hidden = (int) node.getInt ("hidden_size", 0);
+
+            if (! isForward (node) || node.getInt ("input_forget", 0) != 0 || hasInput (node, 7))
+                return fail (describe (node) + " is not a plain forward cell");
+
+            if (w == nullptr || r == nullptr || hidden <= 0
+                || w->data.size() != (size_t) (numGates * hidden * width)
+                || r->data.size() != (size_t) (numGates * hidden * hidden)
+                || (b != nullptr && b->data.size() != (size_t) (2 * numGates * hidden)))
+                return fail (describe (node) + " has weights that do not match " + juce::String (width) + " inputs");
+
+            if (registersFor (hidden) > kMaxRegisters)
+                return fail (describe (node) + " is wider than " + juce::String (kMaxWidth) + " units");
+
+            // ONNX packs [gate][unit][input]; the bias is Wb for every gate, then Rb.
+            const auto fillGate = [&] (Matrix& input, Matrix& recurrent, int gate)
+            {
+                for (int o = 0; o < hidden; ++o)
+                {
+                    for (int i = 0; i < width; ++i)
+                        input.set (o, i, w->data[(size_t) ((gate * hidden + o) * width + i)]);
+
+                    for (int i = 0; i < hidden; ++i)
+                        recurrent.set (o, i, r->data[(size_t) ((gate * hidden + o) * hidden + i)]);
+                }
+            };
+
+            const auto biasOf = [&] (int gate, bool recurrent, int unit)
+            {
+                return b != nullptr ? b->data[(size_t) (((recurrent ? numGates : 0) + gate) * hidden + unit)] : 0.0f;
+            };
+
+            const auto fillBias = [&] (std::vector<Register>& dst, int gate, bool input, bool recurrent)
+            {
+                for (int o = 0; o < hidden; ++o)
+                    lanes (dst.data())[o] = (input ? biasOf (gate, false, o) : 0.0f)
+                                          + (recurrent ? biasOf (gate, true, o) : 0.0f);
+            };
+
+            if (op == "GRU")
+            {
+                auto weights = std::make_shared<GruWeights> (hidden, width, node.getInt ("linear_before_reset", 0) != 0);
+                fillGate (weights->wz, weights->rz, 0);
+                fillGate (weights->wr, weights->rr, 1);
+                fillGate (weights->wh, weights->rh, 2);
+                fillBias (weights->bz,  0, true, true);
+                fillBias (weights->br,  1, true, true);
+                fillBias (weights->bwh, 2, true, false);
+                fillBias (weights->brh, 2, false, true);
+
+                layer = makeSized<Gru> (registersFor (hidden), std::shared_ptr<const GruWeights> (weights));
+            }
+            else
+            {
+                auto weights = std::make_shared<LstmWeights> (hidden, width);
+                fillGate (weights->wi, weights->ri, 0);
+                fillGate (weights->wo, weights->ro, 1);
+                fillGate (weights->wf, weights->rf, 2);
+                fillGate (weights->wc, weights->rc, 3);
+                fillBias (weights->bi, 0, true, true);
+                fillBias (weights->bo, 1, true, true);
+                fillBias (weights->bf, 2, true, true);
+                fillBias (weights->bc, 3, true, true);
+
+                layer = makeSized<Lstm> (registersFor (hidden), std::shared_ptr<const LstmWeights> (weights));
+            }
+
+            // Y and Y_h both carry this step's hidden state (Y_c does not).
+            produced.clear();
+            for (size_t o = 0; o < juce::jmin ((size_t) 2, node.outputs.size()); ++o)
+                if (! node.outputs[o].empty())
+                    produced.push_back (node.outputs[o]);
+
+            width = hidden;
+        }
+        else
+        {
+            return fail ("unsupported op " + describe (node));
+        }
+
+        if (layer != nullptr)
+        {
+            model->maxRegisters = juce::jmax (model->maxRegisters, registersFor (layer->getInputSize()),
+                                              registersFor (layer->getOutputSize()));
+            model->layers.push_back (std::move (layer));
+        }
+
+        current = std::move (produced);
+    }
+
+    if (! isCurrent (outputName))
+        return fail ("the chain does not end at '" + juce::String (outputName) + "'");
+
+    if (width != 1)
+        return fail ("the model produces " + juce::String (width) + " features per sample, not 1");
+
+    model->allocateBuffers();
+    return model;
+}
+
+//==============================================================================
+std::unique_ptr<NativeModel> NativeModel::clone() const
+{
+    std::unique_ptr<NativeModel> copy (new NativeModel());
+    copy->maxRegisters = maxRegisters;
+
+    for (const auto& layer : layers)
+        copy->layers.push_back (layer->clone());
+
+    copy->allocateBuffers();
+    copy->reset();
+    return copy;
+}
+
+void NativeModel::allocateBuffers()
+{
+    bufferA.assign ((size_t) maxRegisters, Register::expand (0.0f));
+    bufferB.assign ((size_t) maxRegisters, Register::expand (0.0f));
+}
+
+void NativeModel::reset() noexcept
+{
+    for (auto& layer : layers)
+        layer->reset();
+}
+
+float NativeModel::processSample (float input) noexcept
+{
+    auto* in  = bufferA.data();
+    auto* out = bufferB.data();
+    lanes (in)[0] = input;
+
+    for (auto& layer : layers)
+    {
+        layer->step (in, out);
+        std::swap (in, out);
+    }
+
+    return lanes (in)[0];
+}
+
+void NativeModel::process (float* samples, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] = processSample (samples[i]);
+}
+
+//==============================================================================
+NativeBackend::NativeBackend (std::unique_ptr<NativeModel> model)
+    : prototype (std::move (model))
+{
+    jassert (prototype != nullptr);
+}
+
+void NativeBackend::prepare (int numChannels, int /*maxBlockSize*/)
+{
+    channelModels.clear();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelModels.push_back (prototype->clone());
+}
+
+void NativeBackend::reset() noexcept
+{
+    for (auto& m : channelModels)
+        m->reset();
+}
+
+void NativeBackend::process (float* const* channels, int numChannels, int numSamples) noexcept
+{
+    const auto n = juce::jmin (numChannels, (int) channelModels.size());
+
+    for (int ch = 0; ch < n; ++ch)
+        channelModels[(size_t) ch]->process (channels[ch], numSamples);
+}
+
+juce::String NativeBackend::getDescription() const
+{
+    return "native, " + juce::String (prototype->getNumLayers()) + " layers, "
+         + juce::String (prototype->getMaxWidth()) + " wide";
+}
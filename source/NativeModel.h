@@ -0,0 +1,112 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "InferenceBackend.h"
+#include "OnnxGraph.h"
+
+/**
+ * A small streaming network evaluated one sample at a time with
+ * juce::dsp::SIMDRegister kernels — the native alternative to ONNX Runtime
+ * for models tiny enough that ORT's per-Run overhead and the engine's
+ * framing latency dominate.
+ *
+ * It is built from the same ONNX file the ORT path loads. The graph must be
+ * a single chain from the model input (one feature per sample) to the output
+ * (one feature) made of:
+ *
+ *  - Gemm, or MatMul optionally followed by Add (dense layers);
+ *  - GRU (forward, either linear_before_reset) and LSTM (forward, no
+ *    peepholes), carrying their hidden state from sample to sample;
+ *  - Conv (1-D, stride 1, any dilation), evaluated causally from a history
+ *    ring, so a padded offline convolution becomes its streaming equivalent;
+ *  - Tanh, Sigmoid, Relu, and Mul/Add/Sub/Div by constants;
+ *  - shape-only ops (Reshape, Squeeze, Unsqueeze, Flatten, Transpose,
+ *    Identity), which are no-ops on a single time step.
+ *
+ * Layer widths are template parameters, in SIMD registers, so every kernel is
+ * a fixed-trip-count multiply-add loop the compiler fully unrolls. Layers up
+ * to kMaxWidth features wide are supported.
+ */
+class NativeModel
+{
+public:
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int kLanes        = (int) Register::SIMDNumElements;
+    static constexpr int kMaxRegisters = 16;
+    static constexpr int kMaxWidth     = kMaxRegisters * kLanes;
+
+    /** One step of one layer. Activations are register-padded float vectors. */
+    class Layer
+    {
+    public:
+        virtual ~Layer() = default;
+
+        virtual int getInputSize() const noexcept = 0;
+        virtual int getOutputSize() const noexcept = 0;
+
+        /** Computes one time step; in and out never alias. */
+        virtual void step (const Register* in, Register* out) noexcept = 0;
+
+        virtual void reset() noexcept {}
+
+        /** A copy with its own state; weights are shared. */
+        virtual std::unique_ptr<Layer> clone() const = 0;
+    };
+
+    //==============================================================================
+    /** Builds a model from a parsed graph, or returns nullptr with the reason
+        in error if the graph uses anything listed above does not cover. */
+    static std::unique_ptr<NativeModel> fromGraph (const OnnxGraph& graph, juce::String& error);
+
+    /** Parses an ONNX model held in memory (e.g. BinaryData), then calls
+        fromGraph. The weights are copied; the bytes need not outlive the call. */
+    static std::unique_ptr<NativeModel> fromMemory (const void* modelData, size_t numBytes, juce::String& error);
+
+    /** Memory-maps and parses an ONNX file, then calls fromGraph. */
+    static std::unique_ptr<NativeModel> fromFile (const juce::File& modelFile, juce::String& error);
+
+    /** A copy with its own state, for another channel. Weights are shared. */
+    std::unique_ptr<NativeModel> clone() const;
+
+    void reset() noexcept;
+
+    float processSample (float input) noexcept;
+
+    void process (float* samples, int numSamples) noexcept;
+
+    int getNumLayers() const noexcept { return (int) layers.size(); }
+
+    /** The widest layer input or output, in features. */
+    int getMaxWidth() const noexcept { return maxRegisters * kLanes; }
+
+private:
+    NativeModel() = default;
+
+    void allocateBuffers();
+
+    std::vector<std::unique_ptr<Layer>> layers;
+    std::vector<Register> bufferA, bufferB;   // ping-pong activations
+    int maxRegisters = 1;
+
+    JUCE_LEAK_DETECTOR (NativeModel)
+};
+
+//==============================================================================
+/** Runs one NativeModel per channel on the audio thread. */
+class NativeBackend : public InferenceBackend
+{
+public:
+    explicit NativeBackend (std::unique_ptr<NativeModel> prototype);
+
+    void prepare (int numChannels, int maxBlockSize) override;
+    void reset() noexcept override;
+    void process (float* const* channels, int numChannels, int numSamples) noexcept override;
+    juce::String getDescription() const override;
+
+private:
+    std::unique_ptr<NativeModel> prototype;
+    std::vector<std::unique_ptr<NativeModel>> channelModels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NativeBackend)
+};
@@ -0,0 +1,377 @@
+#include "OnnxGraph.h"
+
+namespace
+{
+    /** Just enough of the protobuf wire format to walk an ONNX file. */
+    class ProtoReader
+    {
+    public:
+        ProtoReader (const uint8_t* start, size_t numBytes) noexcept
+            : position (start), end (start + numBytes) {}
+
+        bool atEnd() const noexcept  { return position >= end || failed; }
+        bool hasFailed() const noexcept { return failed; }
+
+        /** Reads the next field key. */
+        bool next (int& field, int& wireType) noexcept
+        {
+            if (atEnd())
+                return false;
+
+            const auto key = varint();
+            field    = (int) (key >> 3);
+            wireType = (int) (key & 7);
+            return ! failed;
+        }
+
+        uint64_t varint() noexcept
+        {
+            uint64_t value = 0;
+
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                if (position >= end)
+                    break;
+
+                const auto byte = *position++;
+                value |= (uint64_t) (byte & 0x7f) << shift;
+
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+
+            failed = true;
+            return 0;
+        }
+
+        float fixed32() noexcept
+        {
+            if (end - position < 4)
+            {
+                failed = true;
+                return 0.0f;
+            }
+
+            float value;
+            std::memcpy (&value, position, 4);   // ONNX is little-endian, like every target we ship
+            position += 4;
+            return value;
+        }
+
+        ProtoReader bytes() noexcept
+        {
+            const auto length = (size_t) varint();
+
+            if (failed || (size_t) (end - position) < length)
+            {
+                failed = true;
+                return { position, 0 };
+            }
+
+            ProtoReader nested (position, length);
+            position += length;
+            return nested;
+        }
+
+        std::string string() noexcept
+        {
+            auto nested = bytes();
+            return { reinterpret_cast<const char*> (nested.position), (size_t) (nested.end - nested.position) };
+        }
+
+        void skip (int wireType) noexcept
+        {
+            switch (wireType)
+            {
+                case 0:  varint(); break;
+                case 1:  position += 8; break;
+                case 2:  bytes(); break;
+                case 5:  position += 4; break;
+                default: failed = true; break;
+            }
+
+            failed = failed || position > end;
+        }
+
+        /** A repeated int64, packed or not. */
+        void appendInts (int wireType, std::vector<int64_t>& out) noexcept
+        {
+            if (wireType != 2)
+            {
+                out.push_back ((int64_t) varint());
+                return;
+            }
+
+            for (auto packed = bytes(); ! packed.atEnd();)
+                out.push_back ((int64_t) packed.varint());
+        }
+
+        /** A repeated float, packed or not. */
+        void appendFloats (int wireType, std::vector<float>& out) noexcept
+        {
+            if (wireType != 2)
+            {
+                out.push_back (fixed32());
+                return;
+            }
+
+            for (auto packed = bytes(); ! packed.atEnd();)
+                out.push_back (packed.fixed32());
+        }
+
+        const uint8_t* position;
+        const uint8_t* end;
+        bool failed = false;
+    };
+
+    //==============================================================================
+    OnnxGraph::Tensor readTensor (ProtoReader reader)
+    {
+        OnnxGraph::Tensor tensor;
+        std::string raw;
+
+        for (int field, wire; reader.next (field, wire);)
+        {
+            switch (field)
+            {
+                case 1:  reader.appendInts (wire, tensor.dims); break;
+                case 2:  tensor.dataType = (int) reader.varint(); break;
+                case 4:  reader.appendFloats (wire, tensor.data); break;
+                case 9:  raw = reader.string(); break;
+                default: reader.skip (wire); break;
+            }
+        }
+
+        if (tensor.dataType != OnnxGraph::kFloatType)
+            tensor.data.clear();
+        else if (tensor.data.empty() && ! raw.empty())
+        {
+            tensor.data.resize (raw.size() / sizeof (float));
+            std::memcpy (tensor.data.data(), raw.data(), tensor.data.size() * sizeof (float));
+        }
+
+        return tensor;
+    }
+
+    std::string readTensorName (ProtoReader reader)
+    {
+        for (int field, wire; reader.next (field, wire);)
+        {
+            if (field == 8)
+                return reader.string();
+
+            reader.skip (wire);
+        }
+
+        return {};
+    }
+
+    /** A StringStringEntryProto from the model's metadata_props. */
+    std::pair<std::string, std::string> readMetadataEntry (ProtoReader reader)
+    {
+        std::pair<std::string, std::string> entry;
+
+        for (int field, wire; reader.next (field, wire);)
+        {
+            if (field == 1)
+                entry.first = reader.string();
+            else if (field == 2)
+                entry.second = reader.string();
+            else
+                reader.skip (wire);
+        }
+
+        return entry;
+    }
+
+    OnnxGraph::Attribute readAttribute (ProtoReader reader, std::string& name)
+    {
+        OnnxGraph::Attribute attribute;
+
+        for (int field, wire; reader.next (field, wire);)
+        {
+            switch (field)
+            {
+                case 1:  name = reader.string(); break;
+                case 2:  attribute.f = reader.fixed32(); break;
+                case 3:  attribute.i = (int64_t) reader.varint(); break;
+                case 4:  attribute.s = reader.string(); break;
+                case 5:  attribute.t = readTensor (reader.bytes()); break;
+                case 7:  reader.appendFloats (wire, attribute.floats); break;
+                case 8:  reader.appendInts (wire, attribute.ints); break;
+                default: reader.skip (wire); break;
+            }
+        }
+
+        return attribute;
+    }
+
+    OnnxGraph::Node readNode (ProtoReader reader)
+    {
+        OnnxGraph::Node node;
+
+        for (int field, wire; reader.next (field, wire);)
+        {
+            switch (field)
+            {
+                case 1:  node.inputs.push_back (reader.string()); break;
+                case 2:  node.outputs.push_back (reader.string()); break;
+                case 3:  node.name = reader.string(); break;
+                case 4:  node.opType = reader.string(); break;
+                case 5:
+                {
+                    std::string name;
+                    auto attribute = readAttribute (reader.bytes(), name);
+                    node.attributes[name] = std::move (attribute);
+                    break;
+                }
+                default: reader.skip (wire); break;
+            }
+        }
+
+        return node;
+    }
+
+    // ValueInfoProto → TypeProto → TypeProto.Tensor → TensorShapeProto → Dimension
+    OnnxGraph::ValueInfo readValueInfo (ProtoReader reader)
+    {
+        OnnxGraph::ValueInfo info;
+
+        for (int field, wire; reader.next (field, wire);)
+        {
+            if (field == 1)
+            {
+                info.name = reader.string();
+            }
+            else if (field == 2)
+            {
+                for (auto type = reader.bytes(); type.next (field, wire);)
+                {
+                    if (field != 1) { type.skip (wire); continue; }
+
+                    for (auto tensorType = type.bytes(); tensorType.next (field, wire);)
+                    {
+                        if (field != 2) { tensorType.skip (wire); continue; }
+
+                        for (auto shape = tensorType.bytes(); shape.next (field, wire);)
+                        {
+                            if (field != 1) { shape.skip (wire); continue; }
+
+                            int64_t size = -1;
+                            for (auto dim = shape.bytes(); dim.next (field, wire);)
+                            {
+                                if (field == 1)
+                                    size = (int64_t) dim.varint();
+                                else
+                                    dim.skip (wire);
+                            }
+
+                            info.dims.push_back (size);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                reader.skip (wire);
+            }
+        }
+
+        return info;
+    }
+}
+
+//==============================================================================
+size_t OnnxGraph::Tensor::getNumElements() const noexcept
+{
+    size_t count = 1;
+    for (auto dim : dims)
+        count *= (size_t) juce::jmax ((int64_t) 0, dim);
+
+    return count;
+}
+
+int64_t OnnxGraph::Node::getInt (const std::string& attributeName, int64_t fallback) const
+{
+    const auto it = attributes.find (attributeName);
+    return it != attributes.end() ? it->second.i : fallback;
+}
+
+float OnnxGraph::Node::getFloat (const std::string& attributeName, float fallback) const
+{
+    const auto it = attributes.find (attributeName);
+    return it != attributes.end() ? it->second.f : fallback;
+}
+
+std::string OnnxGraph::Node::getString (const std::string& attributeName, const std::string& fallback) const
+{
+    const auto it = attributes.find (attributeName);
+    return it != attributes.end() ? it->second.s : fallback;
+}
+
+std::vector<int64_t> OnnxGraph::Node::getInts (const std::string& attributeName) const
+{
+    const auto it = attributes.find (attributeName);
+    return it != attributes.end() ? it->second.ints : std::vector<int64_t>();
+}
+
+//==============================================================================
+bool OnnxGraph::parse (const void* data, size_t numBytes, OnnxGraph& result, juce::String& error)
+{
+    result = {};
+
+    ProtoReader model (static_cast<const uint8_t*> (data), numBytes);
+    bool foundGraph = false;
+
+    for (int field, wire; model.next (field, wire);)
+    {
+        if (field == 14 && wire == 2)
+        {
+            result.metadata.insert (readMetadataEntry (model.bytes()));
+            continue;
+        }
+
+        if (field != 7 || wire != 2)
+        {
+            model.skip (wire);
+            continue;
+        }
+
+        foundGraph = true;
+
+        for (auto graph = model.bytes(); graph.next (field, wire);)
+        {
+            switch (field)
+            {
+                case 1:  result.nodes.push_back (readNode (graph.bytes())); break;
+                case 5:
+                {
+                    auto tensorBytes = graph.bytes();
+                    result.initializers[readTensorName (tensorBytes)] = readTensor (tensorBytes);
+                    break;
+                }
+                case 11: result.inputs.push_back (readValueInfo (graph.bytes())); break;
+                case 12: result.outputs.push_back (readValueInfo (graph.bytes())); break;
+                default: graph.skip (wire); break;
+            }
+
+            if (graph.hasFailed())
+            {
+                error = "truncated or corrupt ONNX graph";
+                return false;
+            }
+        }
+    }
+
+    if (model.hasFailed() || ! foundGraph)
+    {
+        error = "not an ONNX model";
+        return false;
+    }
+
+    // Older exporters list initialisers among the graph inputs too.
+    result.inputs.erase (std::remove_if (result.inputs.begin(), result.inputs.end(),
+                                         [&result] (const ValueInfo& v) { return result.initializers.count (v.name) > 0; }),
+                         result.inputs.end());
+    return true;
+}
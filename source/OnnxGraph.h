@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * The parts of an ONNX model the native backend needs — the node list, the
+ * float initialisers, the graph's input/output shapes and the model's
+ * metadata — read straight from the protobuf, so it works with or without
+ * ONNX Runtime built in.
+ *
+ * Only what NativeModel understands is kept: tensors other than float keep
+ * their dims but no data, and unknown fields are skipped.
+ */
+struct OnnxGraph
+{
+    struct Tensor
+    {
+        std::vector<int64_t> dims;
+        std::vector<float>   data;       // empty unless the tensor is float
+        int                  dataType = 0;
+
+        size_t getNumElements() const noexcept;
+    };
+
+    struct Attribute
+    {
+        float                f = 0.0f;
+        int64_t              i = 0;
+        std::string          s;
+        std::vector<float>   floats;
+        std::vector<int64_t> ints;
+        Tensor               t;
+    };
+
+    struct Node
+    {
+        std::string                      opType, name;
+        std::vector<std::string>         inputs, outputs;
+        std::map<std::string, Attribute> attributes;
+
+        bool hasAttribute (const std::string& attributeName) const { return attributes.count (attributeName) > 0; }
+        int64_t              getInt    (const std::string& attributeName, int64_t fallback) const;
+        float                getFloat  (const std::string& attributeName, float fallback) const;
+        std::string          getString (const std::string& attributeName, const std::string& fallback) const;
+        std::vector<int64_t> getInts   (const std::string& attributeName) const;
+    };
+
+    struct ValueInfo
+    {
+        std::string          name;
+        std::vector<int64_t> dims;   // -1 for dynamic dimensions
+    };
+
+    std::vector<Node>             nodes;
+    std::map<std::string, Tensor> initializers;
+    std::vector<ValueInfo>        inputs, outputs;
+    std::map<std::string, std::string> metadata;   // the model's metadata_props
+
+    /** Parses a serialised ModelProto into result. Returns false, with a
+        reason in error, if the bytes are not a readable ONNX model. */
+    static bool parse (const void* data, size_t numBytes, OnnxGraph& result, juce::String& error);
+
+    static constexpr int kFloatType = 1;   // TensorProto.DataType.FLOAT
+};
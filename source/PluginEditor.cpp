@@ -5,29 +5,118 @@ MojoInsectsAudioProcessorEditor::MojoInsectsAudioProcessorEditor (MojoInsectsAud
     : AudioProcessorEditor (&p),
       processorRef (p),
       inputGainAttachment  (p.apvts, "inputGain",  inputGainSlider),
+      mixAttachment        (p.apvts, "mix",        mixSlider),
       outputGainAttachment (p.apvts, "outputGain", outputGainSlider)
 {
     inputGainLabel.setText ("Input Gain", juce::dontSendNotification);
     inputGainLabel.attachToComponent (&inputGainSlider, false);
 
+    mixLabel.setText ("Mix", juce::dontSendNotification);
+    mixLabel.attachToComponent (&mixSlider, false);
+
     outputGainLabel.setText ("Output Gain", juce::dontSendNotification);
     outputGainLabel.attachToComponent (&outputGainSlider, false);
 
     inputGainSlider.setSliderStyle  (juce::Slider::RotaryHorizontalVerticalDrag);
     inputGainSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 80, 20);
 
+    mixSlider.setSliderStyle  (juce::Slider::RotaryHorizontalVerticalDrag);
+    mixSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 80, 20);
+
     outputGainSlider.setSliderStyle  (juce::Slider::RotaryHorizontalVerticalDrag);
     outputGainSlider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 80, 20);
 
     addAndMakeVisible (inputGainSlider);
+    addAndMakeVisible (mixSlider);
     addAndMakeVisible (outputGainSlider);
     addAndMakeVisible (inputGainLabel);
+    addAndMakeVisible (mixLabel);
     addAndMakeVisible (outputGainLabel);
 
-    setSize (400, 300);
+    loadModelButton.onClick = [this]
+    {
+        modelChooser = std::make_unique<juce::FileChooser> ("Load ONNX model", juce::File(), "*.onnx");
+        modelChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                   [this] (const juce::FileChooser& chooser)
+                                   {
+                                       const auto file = chooser.getResult();
+                                       if (file.existsAsFile())
+                                           processorRef.loadModelAsync (file);
+                                   });
+    };
+    addAndMakeVisible (loadModelButton);
+
+    for (int i = 0; i < ModelControls::kMaxControls; ++i)
+    {
+        auto& slider = controlSliders[(size_t) i];
+        slider.setSliderStyle  (juce::Slider::RotaryHorizontalVerticalDrag);
+        slider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 50, 16);
+
+        controlLabels[(size_t) i].setJustificationType (juce::Justification::centred);
+        controlLabels[(size_t) i].setFont (juce::FontOptions (12.0f));
+
+        controlAttachments.push_back (std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (
+            p.apvts, MojoInsectsAudioProcessor::getControlParameterID (i), slider));
+
+        addChildComponent (slider);
+        addChildComponent (controlLabels[(size_t) i]);
+    }
+
+    showControls (processorRef.getModelControls());
+
+    setSize (480, 460);
+    startTimerHz (10);
 }
 
-MojoInsectsAudioProcessorEditor::~MojoInsectsAudioProcessorEditor() = default;
+MojoInsectsAudioProcessorEditor::~MojoInsectsAudioProcessorEditor()
+{
+    stopTimer();
+}
+
+void MojoInsectsAudioProcessorEditor::timerCallback()
+{
+    telemetry  = processorRef.getTelemetry();
+    loadStatus = processorRef.getModelLoadStatus();
+    repaint (telemetryArea);
+    repaint (loadStatusArea);
+
+    if (const auto controls = processorRef.getModelControls(); controls != shownControls)
+        showControls (controls);
+}
+
+// Names the control knobs after the model's controls and shows their values
+// in the model's ranges; the parameters themselves stay normalised.
+void MojoInsectsAudioProcessorEditor::showControls (const ModelControls& controls)
+{
+    shownControls = controls;
+
+    for (int i = 0; i < ModelControls::kMaxControls; ++i)
+    {
+        auto& slider = controlSliders[(size_t) i];
+        const bool declared = i < controls.size();
+
+        slider.setVisible (declared);
+        controlLabels[(size_t) i].setVisible (declared);
+
+        if (! declared)
+            continue;
+
+        const auto control = controls.controls[(size_t) i];
+        controlLabels[(size_t) i].setText (control.name, juce::dontSendNotification);
+
+        slider.textFromValueFunction = [control] (double value)
+        {
+            return juce::String (control.fromNormalised ((float) value), 2);
+        };
+        slider.valueFromTextFunction = [control] (const juce::String& text)
+        {
+            return (double) control.toNormalised (text.getFloatValue());
+        };
+        slider.updateText();
+    }
+
+    resized();
+}
 
 //==============================================================================
 void MojoInsectsAudioProcessorEditor::paint (juce::Graphics& g)
@@ -38,6 +127,44 @@ void MojoInsectsAudioProcessorEditor::paint (juce::Graphics& g)
     g.setFont (juce::FontOptions (20.0f, juce::Font::bold));
     g.drawFittedText ("Mojo Insects", getLocalBounds().removeFromTop (50),
                       juce::Justification::centred, 1);
+
+    // Model load progress, or why it failed.
+    using LoadState = InferenceEngine::LoadState;
+    auto status = loadStatus.message;
+    if (loadStatus.state != LoadState::ready && loadStatus.state != LoadState::failed
+         && loadStatus.state != LoadState::idle)
+        status << "  (" << juce::roundToInt (loadStatus.progress * 100.0f) << "%)";
+
+    g.setColour (loadStatus.state == LoadState::failed ? juce::Colours::orangered
+                                                       : juce::Colours::white.withAlpha (0.85f));
+    g.setFont (juce::FontOptions (13.0f));
+    g.drawFittedText (status, loadStatusArea, juce::Justification::centredLeft, 2);
+
+    // Bucket upper edges, so these read as "at most".
+    const auto micros = [] (double us) { return juce::String (juce::roundToInt (us)) + " us"; };
+
+    const juce::String lines[] =
+    {
+        "Run  p50 " + micros (telemetry.getRunQuantileMicros (0.50))
+          + "   p99 " + micros (telemetry.getRunQuantileMicros (0.99))
+          + "   max " + micros (telemetry.getRunQuantileMicros (1.0))
+          + "   (" + juce::String ((juce::int64) telemetry.runs) + " runs)",
+        "Dry blocks " + juce::String ((juce::int64) telemetry.dryBlocks)
+          + " / " + juce::String ((juce::int64) telemetry.blocks)
+          + "   dropped in " + juce::String ((juce::int64) telemetry.droppedInputSamples)
+          + "  out " + juce::String ((juce::int64) telemetry.droppedOutputSamples),
+        "FIFO high-water  in " + juce::String (telemetry.inputFifoHighWater)
+          + "  out " + juce::String (telemetry.outputFifoHighWater),
+        "Deadline  reduced " + juce::String ((juce::int64) telemetry.reducedHops)
+          + "  bypassed " + juce::String ((juce::int64) telemetry.bypassedHops) + " hops"
+    };
+
+    g.setColour (juce::Colours::white.withAlpha (0.7f));
+    g.setFont (juce::FontOptions (12.0f));
+
+    auto area = telemetryArea;
+    for (const auto& line : lines)
+        g.drawText (line, area.removeFromTop (18), juce::Justification::centredLeft, true);
 }
 
 void MojoInsectsAudioProcessorEditor::resized()
@@ -49,5 +176,22 @@ void MojoInsectsAudioProcessorEditor::resized()
     auto row = area.removeFromTop (knobSize + 30);
 
     inputGainSlider.setBounds  (row.removeFromLeft (knobSize + 20).withTrimmedTop (30));
+    mixSlider.setBounds        (row.removeFromLeft (knobSize + 20).withTrimmedTop (30));
     outputGainSlider.setBounds (row.removeFromLeft (knobSize + 20).withTrimmedTop (30));
+
+    auto loadRow = area.removeFromTop (28);
+    loadModelButton.setBounds (loadRow.removeFromLeft (120));
+    loadStatusArea = loadRow.withTrimmedLeft (10);
+
+    auto controlRow = area.removeFromTop (80).withTrimmedTop (10);
+    const int controlWidth = controlRow.getWidth() / ModelControls::kMaxControls;
+
+    for (int i = 0; i < shownControls.size(); ++i)
+    {
+        auto cell = controlRow.removeFromLeft (controlWidth);
+        controlLabels[(size_t) i].setBounds (cell.removeFromTop (16));
+        controlSliders[(size_t) i].setBounds (cell);
+    }
+
+    telemetryArea = area.removeFromBottom (4 * 18);
 }
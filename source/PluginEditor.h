@@ -3,7 +3,8 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-class MojoInsectsAudioProcessorEditor : public juce::AudioProcessorEditor
+class MojoInsectsAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                        private juce::Timer
 {
 public:
     explicit MojoInsectsAudioProcessorEditor (MojoInsectsAudioProcessor&);
@@ -13,15 +14,38 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+    void showControls (const ModelControls& controls);
+
     MojoInsectsAudioProcessor& processorRef;
 
     juce::Slider inputGainSlider;
+    juce::Slider mixSlider;
     juce::Slider outputGainSlider;
     juce::Label  inputGainLabel;
+    juce::Label  mixLabel;
     juce::Label  outputGainLabel;
 
+    juce::TextButton                   loadModelButton { "Load Model..." };
+    std::unique_ptr<juce::FileChooser> modelChooser;
+
     juce::AudioProcessorValueTreeState::SliderAttachment inputGainAttachment;
+    juce::AudioProcessorValueTreeState::SliderAttachment mixAttachment;
     juce::AudioProcessorValueTreeState::SliderAttachment outputGainAttachment;
 
+    // One small knob per conditioning control the loaded model declares,
+    // named and scaled from its metadata; the rest are hidden.
+    std::array<juce::Slider, ModelControls::kMaxControls> controlSliders;
+    std::array<juce::Label,  ModelControls::kMaxControls> controlLabels;
+    std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> controlAttachments;
+    ModelControls shownControls;
+
+    // Engine health and model load progress, polled from the processor a few
+    // times a second.
+    EngineTelemetry::Snapshot   telemetry;
+    InferenceEngine::LoadStatus loadStatus;
+    juce::Rectangle<int>        telemetryArea;
+    juce::Rectangle<int>        loadStatusArea;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MojoInsectsAudioProcessorEditor)
 };
@@ -18,6 +18,21 @@ juce::AudioProcessorValueTreeState::ParameterLayout MojoInsectsAudioProcessor::c
         juce::NormalisableRange<float> (-60.0f, 12.0f, 0.1f),
         0.0f));
 
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID { "mix", 1 },
+        "Mix",
+        juce::NormalisableRange<float> (0.0f, 100.0f, 0.1f),
+        100.0f));
+
+    // Conditioning controls. The host needs a fixed parameter list, so these
+    // are generic and normalised; the loaded model says what they mean.
+    for (int i = 0; i < ModelControls::kMaxControls; ++i)
+        layout.add (std::make_unique<juce::AudioParameterFloat> (
+            juce::ParameterID { getControlParameterID (i), 1 },
+            "Control " + juce::String (i + 1),
+            juce::NormalisableRange<float> (0.0f, 1.0f),
+            0.5f));
+
     return layout;
 }
 
@@ -28,7 +43,20 @@ MojoInsectsAudioProcessor::MojoInsectsAudioProcessor()
                         .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
       apvts (*this, nullptr, "Parameters", createParameterLayout())
 {
-    inferenceEngine.setOutputFifo (&resultFifo, resultBuffer.data());
+    for (int i = 0; i < ModelControls::kMaxControls; ++i)
+        controlParameters[(size_t) i] = apvts.getRawParameterValue (getControlParameterID (i));
+
+    inferenceEngine.setSessionTrace (&sessionTrace);
+
+    // A model loaded during playback that cannot take over in place.
+    inferenceEngine.onReprepareNeeded = [this] { triggerAsyncUpdate(); };
+
+    // Capture switched on from outside, for a customer reproducing a problem.
+    // Every instance gets a file of its own next to the one named.
+    const auto tracePath = juce::SystemStats::getEnvironmentVariable ("MOJO_SESSION_TRACE", {});
+    if (juce::File::isAbsolutePath (tracePath))
+        startTrace (juce::File (tracePath).getNonexistentSibling(),
+                    juce::SystemStats::getEnvironmentVariable ("MOJO_SESSION_TRACE_AUDIO", {}) == "1");
 }
 
 MojoInsectsAudioProcessor::~MojoInsectsAudioProcessor() = default;
@@ -47,12 +75,67 @@ const juce::String MojoInsectsAudioProcessor::getProgramName (int)            {
 void MojoInsectsAudioProcessor::changeProgramName (int, const juce::String&)  {}
 
 //==============================================================================
-void MojoInsectsAudioProcessor::prepareToPlay (double /*sampleRate*/, int /*samplesPerBlock*/)
+void MojoInsectsAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     // Pre-allocate anything needed here — never in processBlock.
+
+    // Detach the result FIFO while it is resized so the inference thread
+    // cannot write into the old storage.
+    inferenceEngine.setOutputFifo (nullptr, nullptr);
+
+    // Bounces run inference synchronously on a multi-threaded session;
+    // playback goes back to the low-latency background thread.
+    inferenceEngine.setOfflineMode (isNonRealtime());
+
+    const int numChannels = juce::jmax (1, getTotalNumInputChannels());
+    // The sample rate sets the per-hop deadline the engine degrades against.
+    inferenceEngine.prepare (numChannels, samplesPerBlock, sampleRate);
+
+    const int latency = inferenceEngine.getLatencySamples();
+    const int fifoSize = inferenceEngine.getRequiredOutputFifoSize();
+
+    resultBuffer.setSize (numChannels, fifoSize);
+    resultBuffer.clear();
+    resultFifo.setTotalSize (fifoSize);
+
+    // Prime with silence so every block finds a full block of wet samples
+    // waiting; together with the overlap-add delay this is the host latency.
+    resultFifo.finishedWrite (inferenceEngine.getPrimingSamples());
+
+    inferenceEngine.setOutputFifo (&resultFifo, &resultBuffer);
+    setLatencySamples (latency);
+
+    sessionTrace.recordPrepare (numChannels, samplesPerBlock, sampleRate, isNonRealtime());
+
+    // Start from the current settings rather than ramping up from zero; the
+    // dry signal is held back by the latency so it meets the wet one.
+    gainMix.prepare (sampleRate, numChannels, samplesPerBlock, latency,
+                     juce::Decibels::decibelsToGain (apvts.getRawParameterValue ("inputGain")->load()),
+                     apvts.getRawParameterValue ("mix")->load() / 100.0f,
+                     juce::Decibels::decibelsToGain (apvts.getRawParameterValue ("outputGain")->load()));
+}
+
+void MojoInsectsAudioProcessor::releaseResources()
+{
+    // Recurrent models start the next playback from a clean state, and while
+    // stopped a model loaded from the editor may reframe the engine freely.
+    inferenceEngine.resetState();
+    inferenceEngine.release();
 }
 
-void MojoInsectsAudioProcessor::releaseResources() {}
+// Restarts playback around a model loadModelAsync() could not swap in
+// without changing the framing (and so the latency) or the backend.
+void MojoInsectsAudioProcessor::handleAsyncUpdate()
+{
+    if (! inferenceEngine.isPrepared())
+        return; // released meanwhile: it took over then
+
+    suspendProcessing (true);
+    prepareToPlay (getSampleRate(), getBlockSize());
+    suspendProcessing (false);
+
+    updateHostDisplay (ChangeDetails().withLatencyChanged (true));
+}
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool MojoInsectsAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
@@ -72,38 +155,207 @@ void MojoInsectsAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
 {
     juce::ScopedNoDenormals noDenormals;
 
+    const bool tracing = sessionTrace.isCapturing();
+    const auto blockStart = tracing ? juce::Time::getHighResolutionTicks() : 0;
+
     auto* inputGainParam  = apvts.getRawParameterValue ("inputGain");
     auto* outputGainParam = apvts.getRawParameterValue ("outputGain");
+    auto* mixParam        = apvts.getRawParameterValue ("mix");
+
+    gainMix.setTargets (juce::Decibels::decibelsToGain (inputGainParam->load()),
+                        mixParam->load() / 100.0f,
+                        juce::Decibels::decibelsToGain (outputGainParam->load()));
+
+    // Conditioning controls, for the engine to ramp to over its next hop.
+    // Only changed values are passed on, through atomics.
+    std::array<float, ModelControls::kMaxControls> controls;
+    for (size_t i = 0; i < controls.size(); ++i)
+        controls[i] = controlParameters[i]->load();
 
-    const float inputGainLinear  = juce::Decibels::decibelsToGain (inputGainParam->load());
-    const float outputGainLinear = juce::Decibels::decibelsToGain (outputGainParam->load());
+    inferenceEngine.setControls (controls.data(), (int) controls.size());
 
-    buffer.applyGain (inputGainLinear);
+    const int numSamples  = buffer.getNumSamples();
+    const int numChannels = buffer.getNumChannels();
+    float* const* channels = buffer.getArrayOfWritePointers();
 
-    // Submit audio to the inference engine (lock-free write).
-    if (inferenceEngine.isReady())
+    const int tracedSamples = tracing ? sessionTrace.captureInput (channels, numChannels, numSamples) : 0;
+
+    gainMix.processInput (channels, numChannels, numSamples);
+
+    // A native model runs right here, in place, with no FIFO round-trip.
+    if (inferenceEngine.runsInline())
     {
-        const int numSamples = buffer.getNumSamples();
-        inferenceEngine.submitInput (buffer.getReadPointer (0), numSamples);
-
-        // Read any available inference results back into the buffer.
-        const int available = resultFifo.getNumReady();
-        if (available >= numSamples)
-        {
-            const auto scope = resultFifo.read (numSamples);
-            // Copy result into each channel (simple passthrough for now).
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                auto* dst = buffer.getWritePointer (ch);
-                for (int i = 0; i < scope.blockSize1; ++i)
-                    dst[i] = resultBuffer[(size_t)(scope.startIndex1 + i)];
-                for (int i = 0; i < scope.blockSize2; ++i)
-                    dst[scope.blockSize1 + i] = resultBuffer[(size_t)(scope.startIndex2 + i)];
-            }
-        }
+        inferenceEngine.processInline (channels, numChannels, numSamples);
+        inferenceEngine.getTelemetry().addBlock (false);
+        gainMix.processOutput (channels, numChannels, buffer, 0, numSamples, 0, 0);
+
+        if (tracing)
+            sessionTrace.recordBlock (blockStart, numSamples, numChannels, 0, numSamples,
+                                      SessionTrace::ranInline, tracedSamples);
+        return;
     }
 
-    buffer.applyGain (outputGainLinear);
+    // Submit audio to the inference engine (lock-free write). With no model
+    // loaded the engine passes audio through, so the reported latency holds.
+    inferenceEngine.submitInput (buffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+    // Offline renders never fall back to dry: every complete hop is inferred
+    // right here, so the bounce matches what playback sounds like.
+    if (inferenceEngine.isOfflineMode())
+        inferenceEngine.processPendingInput();
+
+    // Mix the inference results, straight from the result ring, with the
+    // delayed dry signal.
+    const int available = resultFifo.getNumReady();
+    const bool wentDry = available < numSamples;
+    inferenceEngine.getTelemetry().addBlock (wentDry);
+
+    if (wentDry)
+    {
+        gainMix.processOutputGainOnly (channels, numChannels, numSamples);
+    }
+    else
+    {
+        const auto scope = resultFifo.read (numSamples);
+        gainMix.processOutput (channels, numChannels, resultBuffer,
+                               scope.startIndex1, scope.blockSize1, scope.startIndex2, scope.blockSize2);
+    }
+
+    if (tracing)
+        sessionTrace.recordBlock (blockStart, numSamples, numChannels, inferenceEngine.getInputFifoLevel(),
+                                  available, wentDry ? SessionTrace::wentDry : 0, tracedSamples);
+}
+
+//==============================================================================
+bool MojoInsectsAudioProcessor::loadModel (const juce::File& modelFile)
+{
+    if (! inferenceEngine.loadModel (modelFile))
+        return false;
+
+    applyControlDefaults();
+    return true;
+}
+
+bool MojoInsectsAudioProcessor::loadModel (const void* modelData, size_t numBytes, const juce::String& name)
+{
+    if (! inferenceEngine.loadModel (modelData, numBytes, name))
+        return false;
+
+    applyControlDefaults();
+    return true;
+}
+
+bool MojoInsectsAudioProcessor::loadModelChain (const juce::Array<juce::File>& modelFiles)
+{
+    if (! inferenceEngine.loadModelChain (modelFiles))
+        return false;
+
+    applyControlDefaults();
+    return true;
+}
+
+bool MojoInsectsAudioProcessor::startTrace (const juce::File& file, bool withAudio)
+{
+    // Opens with the current configuration when already playing; otherwise
+    // the next prepareToPlay records it.
+    SessionTrace::Event prepared;
+    prepared.type        = SessionTrace::EventType::prepare;
+    prepared.flags       = isNonRealtime() ? SessionTrace::offline : 0;
+    prepared.numChannels = juce::jmax (1, getTotalNumInputChannels());
+    prepared.numSamples  = getBlockSize();
+    prepared.sampleRate  = getSampleRate();
+    prepared.startTicks  = prepared.endTicks = juce::Time::getHighResolutionTicks();
+
+    // A few seconds of stereo input in flight to the writer.
+    return sessionTrace.start (file, withAudio, 2, 1 << 18, prepared);
+}
+
+void MojoInsectsAudioProcessor::stopTrace()
+{
+    sessionTrace.stop();
+}
+
+bool MojoInsectsAudioProcessor::isTracing() const noexcept
+{
+    return sessionTrace.isCapturing();
+}
+
+// A freshly loaded model starts where its author meant it to. (A model
+// swapped in during playback keeps the knobs where they are instead.)
+void MojoInsectsAudioProcessor::applyControlDefaults()
+{
+    const auto declared = inferenceEngine.getControls();
+
+    for (int i = 0; i < declared.size(); ++i)
+    {
+        const auto& control = declared.controls[(size_t) i];
+
+        if (auto* parameter = apvts.getParameter (getControlParameterID (i)))
+            parameter->setValueNotifyingHost (control.toNormalised (control.defaultValue));
+    }
+}
+
+ModelControls MojoInsectsAudioProcessor::getModelControls() const
+{
+    return inferenceEngine.getControls();
+}
+
+juce::String MojoInsectsAudioProcessor::getControlParameterID (int index)
+{
+    return "control" + juce::String (index + 1);
+}
+
+void MojoInsectsAudioProcessor::loadModelAsync (const juce::File& modelFile)
+{
+    inferenceEngine.loadModelAsync (modelFile);
+}
+
+void MojoInsectsAudioProcessor::setModelPrecision (ModelVariants::Precision precision)
+{
+    inferenceEngine.setPrecision (precision);
+
+    // Not a host parameter (it only applies to the next load), but it
+    // travels with the rest of the state.
+    apvts.state.setProperty ("modelPrecision", ModelVariants::getName (precision), nullptr);
+}
+
+ModelVariants::Precision MojoInsectsAudioProcessor::getModelPrecision() const noexcept
+{
+    return inferenceEngine.getPrecision();
+}
+
+bool MojoInsectsAudioProcessor::loadFallbackModel (const juce::File& modelFile)
+{
+    return inferenceEngine.loadFallbackModel (modelFile);
+}
+
+bool MojoInsectsAudioProcessor::setThreading (const EngineThreading& threading)
+{
+    auto& state = apvts.state;
+    state.removeChild (state.getChildWithName (EngineThreading::kStateType), nullptr);
+    state.appendChild (threading.toValueTree(), nullptr);
+
+    return inferenceEngine.setThreading (threading);
+}
+
+EngineThreading MojoInsectsAudioProcessor::getThreading() const
+{
+    return inferenceEngine.getThreading();
+}
+
+void MojoInsectsAudioProcessor::setInferenceBackend (InferenceEngine::Backend backend) noexcept
+{
+    inferenceEngine.setBackend (backend);
+}
+
+InferenceEngine::LoadStatus MojoInsectsAudioProcessor::getModelLoadStatus() const
+{
+    return inferenceEngine.getLoadStatus();
+}
+
+EngineTelemetry::Snapshot MojoInsectsAudioProcessor::getTelemetry() const noexcept
+{
+    return inferenceEngine.getTelemetry().getSnapshot();
 }
 
 //==============================================================================
@@ -126,7 +378,20 @@ void MojoInsectsAudioProcessor::setStateInformation (const void* data, int sizeI
 {
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
     if (xmlState && xmlState->hasTagName (apvts.state.getType()))
+    {
         apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+
+        const auto precisionName = apvts.state.getProperty ("modelPrecision", "float32").toString();
+
+        for (auto precision : { ModelVariants::Precision::float32, ModelVariants::Precision::fp16,
+                                ModelVariants::Precision::int8,    ModelVariants::Precision::automatic })
+            if (precisionName == ModelVariants::getName (precision))
+                inferenceEngine.setPrecision (precision);
+
+        // Defaults when the state predates the setting.
+        inferenceEngine.setThreading (EngineThreading::fromValueTree (
+            apvts.state.getChildWithName (EngineThreading::kStateType)));
+    }
 }
 
 //==============================================================================
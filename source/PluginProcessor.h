@@ -1,9 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "GainMix.h"
 #include "InferenceEngine.h"
 
-class MojoInsectsAudioProcessor : public juce::AudioProcessor
+class MojoInsectsAudioProcessor : public juce::AudioProcessor,
+                                  private juce::AsyncUpdater
 {
 public:
     MojoInsectsAudioProcessor();
@@ -17,7 +19,8 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
-    // Real-time safe — no heap allocation, no locks.
+    // Real-time safe — no heap allocation, no locks. (Offline renders run
+    // inference inline, see InferenceEngine::setOfflineMode.)
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
     //==============================================================================
@@ -42,18 +45,96 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /** Loads a .onnx model into the inference engine. Call before
+        prepareToPlay(), never from the audio thread. The control
+        parameters jump to the defaults a conditioned model declares. */
+    bool loadModel (const juce::File& modelFile);
+
+    /** Loads a model compiled into the plugin (BinaryData) straight from
+        memory. The data must outlive the processor. */
+    bool loadModel (const void* modelData, size_t numBytes, const juce::String& name);
+
+    /** Loads several models to run in series, each on its own inference
+        thread (see InferenceEngine::loadModelChain()). The controls are the
+        first model's. Call before prepareToPlay(). */
+    bool loadModelChain (const juce::Array<juce::File>& modelFiles);
+
+    /** Loads a model in the background and swaps it in during playback with a
+        short crossfade. Safe to call from the message thread at any time. A
+        model that needs other framing or another backend restarts playback
+        around itself instead, and reports the new latency to the host. */
+    void loadModelAsync (const juce::File& modelFile);
+
+    /** Loads a lighter model the engine switches to while it is short of
+        time, instead of letting blocks go dry. Call before prepareToPlay(). */
+    bool loadFallbackModel (const juce::File& modelFile);
+
+    /** Which quantized variant of a model to load from now on (see
+        ModelVariants). Saved with the plugin state. */
+    void setModelPrecision (ModelVariants::Precision precision);
+    ModelVariants::Precision getModelPrecision() const noexcept;
+
+    /** Inference thread priority and affinity, and ONNX Runtime threading
+        (see EngineThreading). Saved with the plugin state. Call off the
+        audio thread, preferably while stopped. */
+    bool setThreading (const EngineThreading& threading);
+    EngineThreading getThreading() const;
+
+    /** Chooses between the native in-place backend and ONNX Runtime for
+        models loaded from now on (automatic by default). */
+    void setInferenceBackend (InferenceEngine::Backend backend) noexcept;
+
+    /** The conditioning controls the loaded model declares, which the first
+        few "controlN" parameters drive (see ModelControls). */
+    ModelControls getModelControls() const;
+
+    /** "control1" .. "control8": generic normalised parameters, named and
+        ranged by whichever conditioned model is loaded. */
+    static juce::String getControlParameterID (int index);
+
+    /** Progress and errors of the most recent model load. */
+    InferenceEngine::LoadStatus getModelLoadStatus() const;
+
+    /** Inference timings, FIFO levels and drop/dry-fallback counters since
+        construction. Lock-free; meant for the editor's timer. */
+    EngineTelemetry::Snapshot getTelemetry() const noexcept;
+
+    /** Starts recording a session trace into file (see SessionTrace): the
+        timing of every processBlock call and inference Run, and with
+        withAudio the input too, for MojoInsectsTraceReplay. Setting the
+        MOJO_SESSION_TRACE environment variable to a file path starts one as
+        the plugin opens (MOJO_SESSION_TRACE_AUDIO=1 adds the audio).
+        Message thread. */
+    bool startTrace (const juce::File& file, bool withAudio);
+    void stopTrace();
+    bool isTracing() const noexcept;
+
     //==============================================================================
     juce::AudioProcessorValueTreeState apvts;
 
 private:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() noexcept;
+    void applyControlDefaults();
+    void handleAsyncUpdate() override;
+
+    // Declared before the engine, which records into it until destroyed.
+    SessionTrace sessionTrace;
 
     InferenceEngine inferenceEngine;
 
-    // Lock-free FIFO for audio ↔ inference results exchange.
-    static constexpr int kFifoSize = 512;
-    juce::AbstractFifo resultFifo { kFifoSize };
-    std::array<float, kFifoSize> resultBuffer {};
+    // Lock-free FIFO for audio ↔ inference results exchange, one planar
+    // channel per bus channel. Sized in prepareToPlay() from the block size
+    // and the engine's hop.
+    SpscFifo                 resultFifo { 1 };
+    juce::AudioBuffer<float> resultBuffer;
+
+    // The control parameters' raw values, looked up once so processBlock does
+    // not build their IDs.
+    std::array<std::atomic<float>*, ModelControls::kMaxControls> controlParameters {};
+
+    // Smoothed input gain, dry/wet mix and output gain around the engine.
+    GainMix gainMix;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MojoInsectsAudioProcessor)
 };
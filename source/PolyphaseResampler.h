@@ -0,0 +1,188 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Converts a multichannel stream between two sample rates by an exact
+ * rational factor L / M: conceptually upsampling by L, low-pass filtering
+ * and keeping every Mth sample, done as a polyphase FIR so only the taps
+ * that land on real input samples are ever computed.
+ *
+ * The prototype low-pass is a Kaiser-windowed sinc with kTapsPerPhase taps
+ * per phase, cut off at 0.45 of the lower of the two rates, which keeps
+ * 20 kHz of a 48 kHz stream and rejects images and aliases by about 70 dB.
+ * Each output sample is one kTapsPerPhase-long dot product, written as
+ * eight independent partial sums so that it compiles to packed multiply-adds
+ * (SSE, AVX or NEON) without reassociating a single running sum.
+ *
+ * Both rates are whole numbers of Hz. Pairs whose reduced ratio needs more
+ * than kMaxPhases phases (none of the usual 44.1/48 kHz families do) are
+ * refused by prepare().
+ *
+ * The filter is linear-phase, so the conversion delays the signal by a fixed
+ * getLatencyInInputSamples(). prepare() allocates; process() does not.
+ */
+class PolyphaseResampler
+{
+public:
+    static constexpr int kTapsPerPhase = 64;
+    static constexpr int kMaxPhases    = 1024;
+
+    /** Sets up conversion from inputRate to outputRate for numChannels
+        channels, processed in chunks of at most maxChunkSamples input samples
+        (longer inputs are split). Clears the history. Returns false if the
+        rates are not positive or their ratio needs too many phases. */
+    bool prepare (int inputRate, int outputRate, int newNumChannels, int maxChunkSamples)
+    {
+        if (inputRate <= 0 || outputRate <= 0)
+            return false;
+
+        const int divisor = std::gcd (inputRate, outputRate);
+        const int newUp   = outputRate / divisor;
+        const int newDown = inputRate / divisor;
+
+        if (newUp > kMaxPhases)
+            return false;
+
+        numChannels = juce::jmax (1, newNumChannels);
+        maxChunk    = juce::jmax (1, maxChunkSamples);
+
+        if (newUp != up || newDown != down)
+        {
+            up   = newUp;
+            down = newDown;
+            designFilter();
+        }
+
+        history.assign ((size_t) (numChannels * getHistoryLength()), 0.0f);
+        reset();
+        return true;
+    }
+
+    /** Clears the filter history, as if the stream had just started. */
+    void reset() noexcept
+    {
+        std::fill (history.begin(), history.end(), 0.0f);
+        nextPosition = 0;
+    }
+
+    int getUpFactor() const noexcept   { return up; }
+    int getDownFactor() const noexcept { return down; }
+
+    /** Most output samples process() can return for numInputSamples. */
+    int getMaxOutputSamples (int numInputSamples) const noexcept
+    {
+        return (int) (((int64_t) numInputSamples * up + down - 1) / down) + 1;
+    }
+
+    /** How far the filter delays the signal, in input samples. */
+    double getLatencyInInputSamples() const noexcept
+    {
+        return (double) (up * kTapsPerPhase - 1) / (2.0 * up);
+    }
+
+    /** Converts numInputSamples of every channel, writing the results to
+        output (which must have room for getMaxOutputSamples()), and returns
+        how many samples each channel got. */
+    int process (const float* const* input, int numInputSamples, float* const* output) noexcept
+    {
+        jassert (up > 0);
+
+        const int historyLength = getHistoryLength();
+        int produced = 0;
+
+        for (int offset = 0; offset < numInputSamples;)
+        {
+            const int chunk = juce::jmin (maxChunk, numInputSamples - offset);
+
+            // Each channel's history holds the last kTapsPerPhase - 1 inputs,
+            // then this chunk.
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy_n (input[ch] + offset, chunk, history.data() + ch * historyLength + kTapsPerPhase - 1);
+
+            // nextPosition counts upsampled samples from the chunk's first
+            // input: output k of the chunk reads input n = position / up
+            // through phase position % up.
+            const int end = chunk * up;
+            int count = 0;
+
+            for (; nextPosition < end; nextPosition += down, ++count)
+            {
+                const int n = nextPosition / up;
+                const float* const taps = coefficients.data() + (nextPosition % up) * kTapsPerPhase;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    output[ch][produced + count] = dot (taps, history.data() + ch * historyLength + n);
+            }
+
+            nextPosition -= end;
+            produced += count;
+            offset   += chunk;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* const channelHistory = history.data() + ch * historyLength;
+                std::copy_n (channelHistory + chunk, kTapsPerPhase - 1, channelHistory);
+            }
+        }
+
+        return produced;
+    }
+
+private:
+    int getHistoryLength() const noexcept { return kTapsPerPhase - 1 + maxChunk; }
+
+    // Designs the prototype low-pass at up × the input rate, and splits it
+    // into up phases of kTapsPerPhase taps, each stored reversed so that a
+    // phase runs forwards over the history.
+    void designFilter()
+    {
+        const int length = up * kTapsPerPhase;
+        const double centre = (double) (length - 1) / 2.0;
+        const double cutoff = 0.45 / (double) juce::jmax (up, down);   // cycles per upsampled sample
+
+        std::vector<double> prototype ((size_t) length);
+        juce::dsp::WindowingFunction<double>::fillWindowingTables (prototype.data(), (size_t) length,
+                                                                   juce::dsp::WindowingFunction<double>::kaiser,
+                                                                   false, 7.0);
+        double sum = 0.0;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const double x = 2.0 * cutoff * ((double) i - centre);
+            const double sinc = std::abs (x) < 1.0e-12 ? 1.0 : std::sin (juce::MathConstants<double>::pi * x)
+                                                                 / (juce::MathConstants<double>::pi * x);
+            prototype[(size_t) i] *= 2.0 * cutoff * sinc;
+            sum += prototype[(size_t) i];
+        }
+
+        // Unity gain at DC for each phase: the zeros stuffed in between the
+        // input samples take (up - 1) / up of the energy.
+        coefficients.resize ((size_t) length);
+
+        for (int phase = 0; phase < up; ++phase)
+            for (int tap = 0; tap < kTapsPerPhase; ++tap)
+                coefficients[(size_t) (phase * kTapsPerPhase + kTapsPerPhase - 1 - tap)]
+                    = (float) (prototype[(size_t) (phase + tap * up)] * (double) up / sum);
+    }
+
+    static float dot (const float* taps, const float* samples) noexcept
+    {
+        static_assert (kTapsPerPhase % 8 == 0, "the dot product runs eight lanes at a time");
+
+        float lanes[8] = {};
+
+        for (int i = 0; i < kTapsPerPhase; i += 8)
+            for (int lane = 0; lane < 8; ++lane)
+                lanes[lane] += taps[i + lane] * samples[i + lane];
+
+        return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+    }
+
+    int up { 0 }, down { 0 };
+    int numChannels { 1 };
+    int maxChunk { 1 };
+    int nextPosition { 0 };             // upsampled samples from the current chunk's start
+    std::vector<float> coefficients;    // [up][kTapsPerPhase], each phase reversed
+    std::vector<float> history;         // [numChannels][kTapsPerPhase - 1 + maxChunk]
+};
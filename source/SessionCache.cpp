@@ -0,0 +1,262 @@
+#include "SessionCache.h"
+
+#if MOJO_ONNX_ENABLED
+  #include <onnxruntime_cxx_api.h>
+
+namespace
+{
+    juce::CriticalSection graphCacheLock;
+
+    juce::File& graphCacheDirectory()
+    {
+        static juce::File directory = juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+                                          .getChildFile ("MojoInsects")
+                                          .getChildFile ("GraphCache");
+        return directory;
+    }
+
+    /** The part of the cache key that is the same for every model on this
+        machine: the ORT version, and a short hash of the CPU and the
+        instruction sets ORT's kernels and layout transforms select on. */
+    juce::String getRuntimeTag()
+    {
+        static const auto tag = []
+        {
+            juce::String cpu;
+            cpu << juce::SystemStats::getCpuVendor() << "/" << juce::SystemStats::getCpuModel()
+                << (juce::SystemStats::hasSSE41()   ? " sse4.1"  : "")
+                << (juce::SystemStats::hasAVX()     ? " avx"     : "")
+                << (juce::SystemStats::hasAVX2()    ? " avx2"    : "")
+                << (juce::SystemStats::hasFMA3()    ? " fma3"    : "")
+                << (juce::SystemStats::hasAVX512F() ? " avx512f" : "")
+                << (juce::SystemStats::hasNeon()    ? " neon"    : "");
+
+            const auto cpuHash = SessionCache::hashModel (cpu.toRawUTF8(), cpu.getNumBytesAsUTF8());
+            return "ort" + juce::String (OrtGetApiBase()->GetVersionString()) + "-" + cpuHash.substring (0, 8);
+        }();
+
+        return tag;
+    }
+
+    void setOptimizedModelPath (Ort::SessionOptions& options, const juce::File& file)
+    {
+       #if JUCE_WINDOWS
+        options.SetOptimizedModelFilePath (file.getFullPathName().toWideCharPointer());
+       #else
+        options.SetOptimizedModelFilePath (file.getFullPathName().toRawUTF8());
+       #endif
+    }
+}
+
+//==============================================================================
+SessionCache::SessionCache()
+    : env (std::make_unique<Ort::Env> (ORT_LOGGING_LEVEL_WARNING, "MojoInsects")),
+      prepackedWeights (std::make_unique<Ort::PrepackedWeightsContainer>())
+{
+}
+
+SessionCache::~SessionCache()
+{
+    // Every engine holds the cache for as long as it holds a session.
+    jassert (getNumLiveSessions() == 0);
+}
+
+//==============================================================================
+std::shared_ptr<Ort::Session> SessionCache::acquire (const juce::File& modelFile, const EngineThreading& threading)
+{
+    // Mapped rather than read: the bytes are hashed and handed to ORT where
+    // they are, without a heap copy of the model.
+    const juce::MemoryMappedFile model (modelFile, juce::MemoryMappedFile::readOnly);
+    if (model.getData() == nullptr || model.getSize() == 0)
+        return nullptr;
+
+    return acquire (model.getData(), model.getSize(), threading);
+}
+
+std::shared_ptr<Ort::Session> SessionCache::acquire (const void* modelData, size_t numBytes,
+                                                     const EngineThreading& threading)
+{
+    if (modelData == nullptr || numBytes == 0)
+        return nullptr;
+
+    const auto modelHash = hashModel (modelData, numBytes);
+    const auto key = modelHash + "/" + threading.getSessionKey();
+
+    // Building a session runs the optimiser, which can take seconds, so it
+    // happens outside the lock. Only instances loading the same model at
+    // the same time wait for it, and it is built once.
+    std::promise<std::shared_ptr<Ort::Session>> built;
+    std::shared_future<std::shared_ptr<Ort::Session>> inFlight;
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (auto existing = sessions[key].lock())
+            return existing;
+
+        if (const auto it = building.find (key); it != building.end())
+            inFlight = it->second;
+        else
+            building[key] = built.get_future().share();
+    }
+
+    if (inFlight.valid())
+        return inFlight.get(); // rethrows whatever the builder threw
+
+    std::shared_ptr<Ort::Session> session;
+
+    try
+    {
+        session = createSession (modelData, numBytes, modelHash, threading);
+    }
+    catch (...)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            building.erase (key);
+        }
+
+        built.set_exception (std::current_exception());
+        throw;
+    }
+
+    {
+        const juce::ScopedLock sl (lock);
+        sessions[key] = session;
+        building.erase (key);
+
+        // Drop entries whose last user has gone.
+        for (auto it = sessions.begin(); it != sessions.end();)
+            it = it->second.expired() ? sessions.erase (it) : std::next (it);
+    }
+
+    built.set_value (session);
+    return session;
+}
+
+std::shared_ptr<Ort::Session> SessionCache::createSession (const void* modelData, size_t numBytes,
+                                                           const juce::String& modelHash, const EngineThreading& threading)
+{
+    Ort::SessionOptions sessionOptions;
+    sessionOptions.SetIntraOpNumThreads (threading.intraOpThreads);
+    sessionOptions.SetInterOpNumThreads (threading.interOpThreads);
+    sessionOptions.SetExecutionMode (threading.parallelExecution ? ExecutionMode::ORT_PARALLEL
+                                                                 : ExecutionMode::ORT_SEQUENTIAL);
+
+    // Spinning keeps pool threads hot between Runs at the cost of burning a
+    // core; without it they sleep and take a wakeup on every Run.
+    const char* const spin = threading.allowSpinning ? "1" : "0";
+    sessionOptions.AddConfigEntry ("session.intra_op.allow_spinning", spin);
+    sessionOptions.AddConfigEntry ("session.inter_op.allow_spinning", spin);
+
+    const auto cachedGraph = getGraphCacheFile (modelHash);
+
+    if (cachedGraph.existsAsFile())
+    {
+        const juce::MemoryMappedFile graph (cachedGraph, juce::MemoryMappedFile::readOnly);
+
+        if (graph.getData() != nullptr && graph.getSize() > 0)
+        {
+            try
+            {
+                // Already optimised for this runtime and CPU; running the
+                // optimiser again is what the cache is there to skip.
+                sessionOptions.SetGraphOptimizationLevel (GraphOptimizationLevel::ORT_DISABLE_ALL);
+                auto session = std::make_shared<Ort::Session> (*env, graph.getData(), graph.getSize(),
+                                                               sessionOptions, *prepackedWeights);
+                ++graphCacheHits;
+                return session;
+            }
+            catch (const Ort::Exception& e)
+            {
+                DBG ("Discarding cached graph " << cachedGraph.getFileName() << ": " << e.what());
+            }
+        }
+
+        cachedGraph.deleteFile();
+    }
+
+    sessionOptions.SetGraphOptimizationLevel (GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+    // ORT writes the optimised graph while it builds the session. It goes to
+    // a temporary name first and is only published once the session exists,
+    // so another process never maps half a file.
+    juce::File pendingGraph;
+
+    if (cachedGraph != juce::File() && cachedGraph.getParentDirectory().createDirectory().wasOk())
+    {
+        pendingGraph = cachedGraph.getSiblingFile (cachedGraph.getFileNameWithoutExtension() + "-"
+                                                   + juce::String::toHexString (juce::Random::getSystemRandom().nextInt64())
+                                                   + ".tmp");
+        setOptimizedModelPath (sessionOptions, pendingGraph);
+    }
+
+    std::shared_ptr<Ort::Session> session;
+
+    try
+    {
+        session = std::make_shared<Ort::Session> (*env, modelData, numBytes, sessionOptions, *prepackedWeights);
+    }
+    catch (...)
+    {
+        pendingGraph.deleteFile();
+        throw;
+    }
+
+    if (pendingGraph != juce::File())
+    {
+        ++graphCacheMisses;
+
+        if (! pendingGraph.moveFileTo (cachedGraph))
+            pendingGraph.deleteFile();
+    }
+
+    return session;
+}
+
+juce::String SessionCache::hashModel (const void* data, size_t numBytes) noexcept
+{
+    auto hash = (uint64_t) 0xcbf29ce484222325ull;
+    const auto* bytes = static_cast<const uint8_t*> (data);
+
+    for (size_t i = 0; i < numBytes; ++i)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+
+    return juce::String::toHexString ((juce::int64) hash).paddedLeft ('0', 16);
+}
+
+int SessionCache::getNumLiveSessions() const
+{
+    const juce::ScopedLock sl (lock);
+
+    int live = 0;
+    for (const auto& entry : sessions)
+        live += entry.second.expired() ? 0 : 1;
+
+    return live;
+}
+
+//==============================================================================
+void SessionCache::setGraphCacheDirectory (const juce::File& directory)
+{
+    const juce::ScopedLock sl (graphCacheLock);
+    graphCacheDirectory() = directory;
+}
+
+juce::File SessionCache::getGraphCacheDirectory()
+{
+    const juce::ScopedLock sl (graphCacheLock);
+    return graphCacheDirectory();
+}
+
+juce::File SessionCache::getGraphCacheFile (const juce::String& modelHash)
+{
+    const auto directory = getGraphCacheDirectory();
+
+    if (directory == juce::File())
+        return {};
+
+    return directory.getChildFile (modelHash + "-" + getRuntimeTag() + ".onnx");
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "EngineThreading.h"
+
+#include <future>
+
+#if MOJO_ONNX_ENABLED
+
+namespace Ort { class Session; class Env; struct PrepackedWeightsContainer; }
+
+/**
+ * Process-wide ONNX Runtime state shared by every plugin instance: one
+ * Ort::Env, one prepacked-weights container, and a cache of sessions keyed by
+ * the model file's content hash.
+ *
+ * Instances that load the same model (from any path) get the same session,
+ * and therefore one copy of the weights and of ORT's prepacked buffers.
+ * Sessions are reference counted: the cache only holds weak references, so a
+ * model is freed as soon as the last instance using it lets go. Session::Run
+ * is safe to call concurrently, so each instance keeps only its own I/O
+ * bindings and buffers.
+ *
+ * Model files are memory-mapped rather than read into a heap copy, and
+ * models compiled into the binary (BinaryData) are handed to ORT where they
+ * are.
+ *
+ * Optimised graphs are cached on disk. The first time a model is loaded on
+ * a machine, ORT_ENABLE_ALL optimisation runs as usual and ORT writes the
+ * result to the graph cache directory; later loads (in this or any other
+ * process) read that back with optimisation switched off. The cache key is
+ * the model's content hash, the ORT version and the CPU's feature set,
+ * since the optimised graph is specific to all three. A cached graph ORT
+ * rejects is deleted and rebuilt.
+ *
+ * Hold it through a juce::SharedResourcePointer<SessionCache>; the cache (and
+ * the Env) then lives exactly as long as at least one engine does.
+ */
+class SessionCache
+{
+public:
+    SessionCache();
+    ~SessionCache();
+
+    /** Returns a session for modelFile with the given ORT threading options,
+        creating it only if no live instance already has one for the same
+        content and options. Loads of different models never wait for each
+        other; simultaneous loads of the same one share a single build.
+        Throws Ort::Exception if ORT rejects the model; returns nullptr if
+        the file cannot be read. */
+    std::shared_ptr<Ort::Session> acquire (const juce::File& modelFile, const EngineThreading& threading);
+
+    /** The same for a model that is already in memory, such as a BinaryData
+        resource. The bytes are only read during the call. */
+    std::shared_ptr<Ort::Session> acquire (const void* modelData, size_t numBytes, const EngineThreading& threading);
+
+    /** 64-bit FNV-1a over the model bytes, as hex. Identical files hash the
+        same regardless of where they live on disk. */
+    static juce::String hashModel (const void* data, size_t numBytes) noexcept;
+
+    /** Sessions currently alive, for tests and telemetry. */
+    int getNumLiveSessions() const;
+
+    //==============================================================================
+    /** Where optimised graphs are kept, for every cache in the process. An
+        empty File turns the cache off. Defaults to "MojoInsects/GraphCache"
+        in the user's application data directory. */
+    static void setGraphCacheDirectory (const juce::File& directory);
+    static juce::File getGraphCacheDirectory();
+
+    /** The cache file an optimised graph of the model with this content hash
+        lives in: "<hash>-ort<version>-<cpu features>.onnx". */
+    static juce::File getGraphCacheFile (const juce::String& modelHash);
+
+    /** Sessions created from a cached optimised graph, and sessions that had
+        to optimise from scratch (and wrote one), since construction. */
+    int getNumGraphCacheHits() const noexcept   { return graphCacheHits.load(); }
+    int getNumGraphCacheMisses() const noexcept { return graphCacheMisses.load(); }
+
+private:
+    std::shared_ptr<Ort::Session> createSession (const void* modelData, size_t numBytes,
+                                                 const juce::String& modelHash, const EngineThreading& threading);
+
+    std::unique_ptr<Ort::Env>                       env;
+    std::unique_ptr<Ort::PrepackedWeightsContainer> prepackedWeights;
+
+    // "<content hash>/<threading session key>" → session shared by the instances
+    // currently using it, and the ones still being built, which later callers
+    // for the same key wait on. Sessions are built outside the lock.
+    std::map<juce::String, std::weak_ptr<Ort::Session>> sessions;
+    std::map<juce::String, std::shared_future<std::shared_ptr<Ort::Session>>> building;
+    juce::CriticalSection lock;
+
+    std::atomic<int> graphCacheHits   { 0 };
+    std::atomic<int> graphCacheMisses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SessionCache)
+};
+
+#endif
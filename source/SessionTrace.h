@@ -0,0 +1,446 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SpscFifo.h"
+
+/**
+ * Opt-in capture of a session's real timing, so a customer's dropouts can be
+ * replayed offline against any build (see tools/TraceReplay.cpp).
+ *
+ * While capturing, every processBlock call leaves one block event (entry and
+ * exit time, block size, FIFO levels, whether wet output was ready) and every
+ * inference Run one run event (start and end time, frames batched, quality).
+ * Optionally the block's input audio is kept too. prepareToPlay leaves a
+ * prepare event with the new sample rate and block size.
+ *
+ * The audio and inference threads only copy fixed-size events (and audio)
+ * into preallocated SpscFifo rings: no allocation, no locks, no I/O. A
+ * low-priority writer thread drains the rings into the file every few
+ * milliseconds. Whatever does not fit because the writer fell behind is
+ * counted and reported at the end of the trace instead of blocking.
+ *
+ * The file is little-endian binary: a header ("MOJOTRC1", version, ticks
+ * per second, flags), then the events, each block event followed by its
+ * audio (channel after channel), then a trailer with the drop counts.
+ * read() loads one back.
+ *
+ * start() and stop() belong to the message thread; recordPrepare() to
+ * whoever calls prepareToPlay; recordBlock() and captureInput() to the audio
+ * thread; recordRun() to the inference thread.
+ */
+class SessionTrace : private juce::Thread
+{
+public:
+    /** Events each ring holds before the writer must have drained it. */
+    static constexpr int kRingEvents = 1 << 14;
+
+    enum class EventType : uint8_t { prepare = 1, block = 2, run = 3 };
+
+    /** Flag bits of block and prepare events. */
+    enum Flags : uint8_t
+    {
+        wentDry   = 1,   // block: no wet samples were ready, so it went out dry
+        ranInline = 2,   // block: a native model processed it in place
+        offline   = 4    // prepare: rendering offline
+    };
+
+    struct Event
+    {
+        EventType   type         = EventType::block;
+        uint8_t     flags        = 0;     // Flags; for a run, its DeadlineScheduler::Quality
+        int         numChannels  = 0;     // prepare: bus channels; block: channels of audio captured
+        int         numSamples   = 0;     // prepare: max block size; block: its size; run: frames batched
+        juce::int64 startTicks   = 0;     // high-resolution ticks at processBlock entry, or Run start
+        juce::int64 endTicks     = 0;     // at processBlock exit, or Run end
+        int         inputLevel   = 0;     // samples waiting in the engine's input ring
+        int         outputLevel  = 0;     // block: wet samples ready to mix; run: in the result ring as it ended
+        int         audioSamples = 0;     // block: input samples captured per channel
+        double      sampleRate   = 0.0;   // prepare only
+        size_t      audioOffset  = 0;     // read() only: where the block's audio starts in Contents::audio
+    };
+
+    SessionTrace() : juce::Thread ("Session trace writer") {}
+    ~SessionTrace() override { stop(); }
+
+    //==============================================================================
+    /** Starts capturing into file, replacing it. With withAudio, up to
+        maxChannels of input are kept, through a ring of audioRingSamples
+        per channel. prepared (a prepare event) opens the trace with the
+        current configuration when the caller is already playing. */
+    bool start (const juce::File& file, bool withAudio, int maxChannels, int audioRingSamples, const Event& prepared)
+    {
+        stop();
+
+        file.deleteFile();
+        std::unique_ptr<juce::FileOutputStream> out (file.createOutputStream (1 << 16));
+        if (out == nullptr)
+            return false;
+
+        out->write (kMagic, sizeof (kMagic));
+        out->writeInt (kVersion);
+        out->writeInt64 (juce::Time::getHighResolutionTicksPerSecond());
+        out->writeInt (withAudio ? 1 : 0);
+
+        if (prepared.type == EventType::prepare && prepared.sampleRate > 0.0)
+            writeEvent (*out, prepared);
+
+        blockEvents.assign ((size_t) kRingEvents, {});
+        runEvents  .assign ((size_t) kRingEvents, {});
+        blockRing.setTotalSize (kRingEvents);
+        runRing  .setTotalSize (kRingEvents);
+
+        captureAudio = withAudio;
+        audio.setSize (withAudio ? juce::jmax (1, maxChannels) : 1, withAudio ? juce::jmax (1, audioRingSamples) : 1);
+        audioRing.setTotalSize (audio.getNumSamples());
+
+        droppedEvents.store (0);
+        droppedAudioBlocks.store (0);
+        stream = std::move (out);
+
+        capturing.store (true);
+        return startThread (juce::Thread::Priority::low);
+    }
+
+    /** Stops capturing, writes out everything still queued and closes the
+        file. */
+    void stop()
+    {
+        if (! capturing.exchange (false))
+            return;
+
+        // A record already under way finishes before the rings go quiet.
+        while (activeWriters.load() > 0)
+            juce::Thread::yield();
+
+        stopThread (2000);
+        drain();
+
+        stream->writeByte ((char) kTrailer);
+        stream->writeInt64 (droppedEvents.load());
+        stream->writeInt64 (droppedAudioBlocks.load());
+        stream->flush();
+        stream.reset();
+    }
+
+    bool isCapturing() const noexcept { return capturing.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** A new configuration. Never concurrent with recordBlock(), as
+        prepareToPlay never runs alongside processBlock. */
+    void recordPrepare (int numChannels, int maxBlockSize, double sampleRate, bool isOffline) noexcept
+    {
+        if (! enter())
+            return;
+
+        Event event;
+        event.type        = EventType::prepare;
+        event.flags       = isOffline ? offline : 0;
+        event.numChannels = numChannels;
+        event.numSamples  = maxBlockSize;
+        event.startTicks  = event.endTicks = juce::Time::getHighResolutionTicks();
+        event.sampleRate  = sampleRate;
+        push (blockRing, blockEvents, event);
+
+        leave();
+    }
+
+    /** Audio thread: keeps a copy of this block's input, if audio is being
+        captured and the ring has room. Returns the samples kept per channel,
+        for recordBlock(). */
+    int captureInput (const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (! enter())
+            return 0;
+
+        int kept = 0;
+
+        // Only with room for the block event too: audio without its event
+        // would shift every later block's audio in the file.
+        if (captureAudio && audioRing.getFreeSpace() >= numSamples && blockRing.getFreeSpace() >= 1)
+        {
+            const auto scope = audioRing.write (numSamples);
+
+            for (int ch = 0; ch < juce::jmin (numChannels, audio.getNumChannels()); ++ch)
+            {
+                audio.copyFrom (ch, scope.startIndex1, channels[ch], scope.blockSize1);
+                audio.copyFrom (ch, scope.startIndex2, channels[ch] + scope.blockSize1, scope.blockSize2);
+            }
+
+            kept = numSamples;
+        }
+        else if (captureAudio)
+        {
+            droppedAudioBlocks.fetch_add (1);
+        }
+
+        leave();
+        return kept;
+    }
+
+    /** Audio thread, as processBlock returns. */
+    void recordBlock (juce::int64 startTicks, int numSamples, int numChannels, int inputLevel, int outputLevel,
+                      uint8_t flags, int audioSamples) noexcept
+    {
+        if (! enter())
+            return;
+
+        Event event;
+        event.type         = EventType::block;
+        event.flags        = flags;
+        event.numChannels  = audioSamples > 0 ? juce::jmin (numChannels, audio.getNumChannels()) : 0;
+        event.numSamples   = numSamples;
+        event.startTicks   = startTicks;
+        event.endTicks     = juce::Time::getHighResolutionTicks();
+        event.inputLevel   = inputLevel;
+        event.outputLevel  = outputLevel;
+        event.audioSamples = audioSamples;
+        push (blockRing, blockEvents, event);
+
+        leave();
+    }
+
+    /** Inference thread, after each Run (or bypassed hop). */
+    void recordRun (juce::int64 startTicks, juce::int64 endTicks, int numFrames, int quality,
+                    int inputLevel, int outputLevel) noexcept
+    {
+        if (! enter())
+            return;
+
+        Event event;
+        event.type        = EventType::run;
+        event.flags       = (uint8_t) quality;
+        event.numSamples  = numFrames;
+        event.startTicks  = startTicks;
+        event.endTicks    = endTicks;
+        event.inputLevel  = inputLevel;
+        event.outputLevel = outputLevel;
+        push (runRing, runEvents, event);
+
+        leave();
+    }
+
+    //==============================================================================
+    /** A trace read back from disk. */
+    struct Contents
+    {
+        juce::int64        ticksPerSecond     = 1;
+        bool               withAudio          = false;
+        std::vector<Event> timeline;               // prepare and block events, as they happened
+        std::vector<Event> runs;                   // inference Runs, as they happened
+        std::vector<float> audio;                  // each captured block's channels back to back
+        juce::int64        droppedEvents      = 0;
+        juce::int64        droppedAudioBlocks = 0;
+        bool               complete           = false;   // the trailer was there: the capture was stopped
+
+        double toSeconds (juce::int64 ticks) const noexcept { return (double) ticks / (double) ticksPerSecond; }
+    };
+
+    static bool read (const juce::File& file, Contents& contents, juce::String& error)
+    {
+        juce::FileInputStream fileStream (file);
+        if (! fileStream.openedOk())
+        {
+            error = "cannot open " + file.getFullPathName();
+            return false;
+        }
+
+        juce::BufferedInputStream in (fileStream, 1 << 16);
+
+        char magic[sizeof (kMagic)] {};
+        if (in.read (magic, (int) sizeof (magic)) != (int) sizeof (magic)
+            || ! std::equal (std::begin (magic), std::end (magic), std::begin (kMagic)))
+        {
+            error = file.getFileName() + " is not a session trace";
+            return false;
+        }
+
+        if (const int version = in.readInt(); version != kVersion)
+        {
+            error = "unsupported trace version " + juce::String (version);
+            return false;
+        }
+
+        contents = {};
+        contents.ticksPerSecond = juce::jmax ((juce::int64) 1, in.readInt64());
+        contents.withAudio      = (in.readInt() & 1) != 0;
+
+        while (! in.isExhausted())
+        {
+            const auto type = (uint8_t) in.readByte();
+
+            if (type == kTrailer)
+            {
+                contents.droppedEvents      = in.readInt64();
+                contents.droppedAudioBlocks = in.readInt64();
+                contents.complete           = true;
+                break;
+            }
+
+            if (in.getNumBytesRemaining() < kEventBytes)
+                break;   // cut off mid-event
+
+            auto event = readEvent (in, type);
+
+            if (event.type == EventType::run)
+            {
+                contents.runs.push_back (event);
+                continue;
+            }
+
+            if (event.type == EventType::block && event.audioSamples > 0)
+            {
+                const auto numFloats = (size_t) (event.numChannels * event.audioSamples);
+
+                if (in.getNumBytesRemaining() < (juce::int64) (numFloats * sizeof (float)))
+                    break;   // cut off mid-block: keep what came before
+
+                event.audioOffset = contents.audio.size();
+                contents.audio.resize (event.audioOffset + numFloats);
+
+                for (auto i = event.audioOffset; i < contents.audio.size(); ++i)
+                    contents.audio[i] = in.readFloat();
+            }
+
+            contents.timeline.push_back (event);
+        }
+
+        return true;
+    }
+
+private:
+    static constexpr char    kMagic[8] = { 'M', 'O', 'J', 'O', 'T', 'R', 'C', '1' };
+    static constexpr int     kVersion  = 1;
+    static constexpr uint8_t kTrailer  = 0xff;
+
+    // An event on disk after its type byte: see writeEvent().
+    static constexpr juce::int64 kEventBytes = 1 + 4 * 2 + 8 * 2 + 4 * 3 + 8;
+
+    // A writer counts itself in before touching the rings, so stop() can
+    // wait for the last one to leave; the check before counting keeps the
+    // idle cost to one relaxed load.
+    bool enter() noexcept
+    {
+        if (! capturing.load (std::memory_order_relaxed))
+            return false;
+
+        activeWriters.fetch_add (1);
+
+        if (capturing.load())
+            return true;
+
+        activeWriters.fetch_sub (1);
+        return false;
+    }
+
+    void leave() noexcept { activeWriters.fetch_sub (1); }
+
+    void push (SpscFifo& ring, std::vector<Event>& events, const Event& event) noexcept
+    {
+        if (ring.getFreeSpace() < 1)
+        {
+            droppedEvents.fetch_add (1);
+            return;
+        }
+
+        const auto scope = ring.write (1);
+        events[(size_t) scope.startIndex1] = event;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (10);
+            drain();
+        }
+    }
+
+    // Writer thread, or stop() once it has finished.
+    void drain()
+    {
+        for (auto* ring : { &blockRing, &runRing })
+        {
+            auto& events = ring == &blockRing ? blockEvents : runEvents;
+
+            for (int ready = ring->getNumReady(); ready > 0; --ready)
+            {
+                const auto scope = ring->read (1);
+                const auto& event = events[(size_t) scope.startIndex1];
+
+                writeEvent (*stream, event);
+
+                if (event.type == EventType::block && event.audioSamples > 0)
+                    writeAudio (event);
+            }
+        }
+
+        stream->flush();
+    }
+
+    // The block's audio, which captureInput() queued just before its event.
+    void writeAudio (const Event& event)
+    {
+        const auto scope = audioRing.read (event.audioSamples);
+
+        for (int ch = 0; ch < event.numChannels; ++ch)
+        {
+            const float* const samples = audio.getReadPointer (ch);
+
+            for (int i = 0; i < scope.blockSize1; ++i)
+                stream->writeFloat (samples[scope.startIndex1 + i]);
+
+            for (int i = 0; i < scope.blockSize2; ++i)
+                stream->writeFloat (samples[scope.startIndex2 + i]);
+        }
+    }
+
+    static void writeEvent (juce::OutputStream& out, const Event& event)
+    {
+        out.writeByte ((char) event.type);
+        out.writeByte ((char) event.flags);
+        out.writeInt (event.numChannels);
+        out.writeInt (event.numSamples);
+        out.writeInt64 (event.startTicks);
+        out.writeInt64 (event.endTicks);
+        out.writeInt (event.inputLevel);
+        out.writeInt (event.outputLevel);
+        out.writeInt (event.audioSamples);
+        out.writeDouble (event.sampleRate);
+    }
+
+    static Event readEvent (juce::InputStream& in, uint8_t type)
+    {
+        Event event;
+        event.type         = (EventType) type;
+        event.flags        = (uint8_t) in.readByte();
+        event.numChannels  = in.readInt();
+        event.numSamples   = in.readInt();
+        event.startTicks   = in.readInt64();
+        event.endTicks     = in.readInt64();
+        event.inputLevel   = in.readInt();
+        event.outputLevel  = in.readInt();
+        event.audioSamples = in.readInt();
+        event.sampleRate   = in.readDouble();
+        return event;
+    }
+
+    std::atomic<bool> capturing     { false };
+    std::atomic<int>  activeWriters { 0 };
+    bool              captureAudio  { false };
+
+    // One ring per producing thread: block and prepare events from the
+    // audio side, run events from the inference thread.
+    SpscFifo           blockRing { 1 }, runRing { 1 };
+    std::vector<Event> blockEvents, runEvents;
+
+    // Captured input, planar, indexed by audioRing.
+    SpscFifo                 audioRing { 1 };
+    juce::AudioBuffer<float> audio;
+
+    std::atomic<juce::int64> droppedEvents      { 0 };
+    std::atomic<juce::int64> droppedAudioBlocks { 0 };
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    JUCE_DECLARE_NON_COPYABLE (SessionTrace)
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * The STFT stage around a spectral-domain model: turns the engine's windowed
+ * time-domain frames into the magnitude/phase rows the model reads, and the
+ * rows it writes back into time-domain frames for the overlap-add.
+ *
+ * A row is one [2, bins] slice of the model's [batch, 2, bins] tensors:
+ * fftSize / 2 + 1 magnitudes followed by as many phases, in radians.
+ *
+ * The engine multiplies each frame by getAnalysisWindow() (periodic Hann,
+ * as torch.stft and librosa use) before analyse(), and overlap-adds what
+ * synthesise() returns with a synthesis window normalised against it (see
+ * makeWindows()), so a model that returns its input gives back the input
+ * exactly. The latency this adds is the usual (fftSize - hop) of the
+ * overlap-add.
+ *
+ * prepare() allocates; analyse() and synthesise() do not, and belong to the
+ * inference thread.
+ */
+class SpectralFrames
+{
+public:
+    /** Sizes the transform for frames of fftSize samples (a power of two). */
+    void prepare (int newFftSize)
+    {
+        jassert (juce::isPowerOfTwo (newFftSize) && newFftSize >= 2);
+
+        if (fft != nullptr && newFftSize == fftSize)
+            return;
+
+        fftSize = newFftSize;
+        fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 ((double) fftSize)));
+        scratch.assign ((size_t) (2 * fftSize), 0.0f);
+    }
+
+    int getFftSize() const noexcept   { return fftSize; }
+    int getNumBins() const noexcept   { return fftSize / 2 + 1; }
+
+    /** Floats per row: the magnitudes, then the phases. */
+    int getRowLength() const noexcept { return 2 * getNumBins(); }
+
+    /** Transforms one already windowed frame of fftSize samples into a row. */
+    void analyse (const float* frame, float* row) noexcept
+    {
+        std::copy_n (frame, fftSize, scratch.begin());
+        std::fill (scratch.begin() + fftSize, scratch.end(), 0.0f);
+
+        fft->performRealOnlyForwardTransform (scratch.data(), true);
+
+        const int bins = getNumBins();
+        float* const magnitude = row;
+        float* const phase     = row + bins;
+
+        for (int k = 0; k < bins; ++k)
+        {
+            const float re = scratch[(size_t) (2 * k)];
+            const float im = scratch[(size_t) (2 * k + 1)];
+
+            magnitude[k] = std::sqrt (re * re + im * im);
+            phase[k]     = std::atan2 (im, re);
+        }
+    }
+
+    /** Transforms a row back into fftSize time-domain samples. */
+    void synthesise (const float* row, float* frame) noexcept
+    {
+        const int bins = getNumBins();
+        const float* const magnitude = row;
+        const float* const phase     = row + bins;
+
+        for (int k = 0; k < bins; ++k)
+        {
+            scratch[(size_t) (2 * k)]     = magnitude[k] * std::cos (phase[k]);
+            scratch[(size_t) (2 * k + 1)] = magnitude[k] * std::sin (phase[k]);
+        }
+
+        // A real signal's negative frequencies mirror its positive ones.
+        for (int k = bins; k < fftSize; ++k)
+        {
+            scratch[(size_t) (2 * k)]     =  scratch[(size_t) (2 * (fftSize - k))];
+            scratch[(size_t) (2 * k + 1)] = -scratch[(size_t) (2 * (fftSize - k) + 1)];
+        }
+
+        fft->performRealOnlyInverseTransform (scratch.data());
+        std::copy_n (scratch.begin(), fftSize, frame);
+    }
+
+    /** Fills analysis with a periodic Hann window of fftSize samples, and
+        synthesis with the window that makes analysis × synthesis overlap-add
+        to exactly one at this hop (weighted overlap-add). The hop must be at
+        most half the FFT size, so every sample is covered by two frames. */
+    static void makeWindows (int fftSize, int hopSize, std::vector<float>& analysis, std::vector<float>& synthesis)
+    {
+        jassert (hopSize > 0 && hopSize <= fftSize / 2 && fftSize % hopSize == 0);
+
+        analysis .resize ((size_t) fftSize);
+        synthesis.resize ((size_t) fftSize);
+
+        for (int i = 0; i < fftSize; ++i)
+            analysis[(size_t) i] = 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi
+                                                         * (float) i / (float) fftSize);
+
+        for (int phase = 0; phase < hopSize; ++phase)
+        {
+            float sum = 0.0f;
+            for (int i = phase; i < fftSize; i += hopSize)
+                sum += analysis[(size_t) i] * analysis[(size_t) i];
+
+            for (int i = phase; i < fftSize; i += hopSize)
+                synthesis[(size_t) i] = analysis[(size_t) i] / sum;
+        }
+    }
+
+private:
+    int fftSize { 0 };
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> scratch;   // [2 * fftSize]: the transform works in place
+};
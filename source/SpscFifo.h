@@ -0,0 +1,150 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * A wait-free single-producer / single-consumer index ring: the parts of
+ * juce::AbstractFifo the audio ↔ inference exchange uses, laid out so the two
+ * threads do not fight over cache lines.
+ *
+ * Like AbstractFifo it only manages positions; the caller owns the storage
+ * (usually a planar multichannel AudioBuffer indexed by one ring). A ring of
+ * size N holds at most N - 1 items.
+ *
+ * The write position shares a cache line with the producer's cached copy of
+ * the read position, and vice versa, so each side normally touches only its
+ * own line and refreshes its view of the other side's position only when the
+ * cached one says the ring is full (producer) or empty (consumer). Every
+ * operation is a bounded number of loads and stores: no locks, no CAS loops.
+ *
+ * Exactly one thread may write and one may read at a time. setTotalSize()
+ * and reset() are only safe while neither is active.
+ */
+class SpscFifo
+{
+public:
+    explicit SpscFifo (int capacity) noexcept   { setTotalSize (capacity); }
+
+    void setTotalSize (int capacity) noexcept
+    {
+        jassert (capacity > 0);
+        size = juce::jmax (1, capacity);
+        reset();
+    }
+
+    int getTotalSize() const noexcept { return size; }
+
+    void reset() noexcept
+    {
+        writePos.store (0, std::memory_order_relaxed);
+        readPos .store (0, std::memory_order_relaxed);
+        cachedReadPos = cachedWritePos = 0;
+    }
+
+    /** Items ready to read. Exact when called by either side. */
+    int getNumReady() const noexcept
+    {
+        return used (writePos.load (std::memory_order_acquire), readPos.load (std::memory_order_acquire));
+    }
+
+    /** Room left to write. Exact when called by either side. */
+    int getFreeSpace() const noexcept { return size - 1 - getNumReady(); }
+
+    //==============================================================================
+    /** Where up to numWanted items go (two regions if it wraps). */
+    struct Region
+    {
+        int startIndex1 = 0, blockSize1 = 0, startIndex2 = 0, blockSize2 = 0;
+    };
+
+    /** Producer: the free region for up to numToWrite items, clamped to the
+        space available. Commit with finishedWrite(). */
+    Region prepareToWrite (int numToWrite) noexcept
+    {
+        const int w = writePos.load (std::memory_order_relaxed);
+
+        if (size - 1 - used (w, cachedReadPos) < numToWrite)
+            cachedReadPos = readPos.load (std::memory_order_acquire);
+
+        return split (w, juce::jmin (numToWrite, size - 1 - used (w, cachedReadPos)));
+    }
+
+    /** Producer: publishes numWritten items to the consumer. */
+    void finishedWrite (int numWritten) noexcept
+    {
+        jassert (numWritten >= 0 && numWritten <= getFreeSpace());
+        writePos.store ((writePos.load (std::memory_order_relaxed) + numWritten) % size, std::memory_order_release);
+    }
+
+    /** Consumer: the ready region for up to numToRead items, clamped to what
+        is available. Release it with finishedRead(). */
+    Region prepareToRead (int numToRead) noexcept
+    {
+        const int r = readPos.load (std::memory_order_relaxed);
+
+        if (used (cachedWritePos, r) < numToRead)
+            cachedWritePos = writePos.load (std::memory_order_acquire);
+
+        return split (r, juce::jmin (numToRead, used (cachedWritePos, r)));
+    }
+
+    /** Consumer: hands numRead slots back to the producer. */
+    void finishedRead (int numRead) noexcept
+    {
+        jassert (numRead >= 0 && numRead <= getNumReady());
+        readPos.store ((readPos.load (std::memory_order_relaxed) + numRead) % size, std::memory_order_release);
+    }
+
+    //==============================================================================
+    /** A region that commits itself when it goes out of scope, like
+        AbstractFifo::ScopedWrite / ScopedRead. */
+    template <bool isWrite>
+    class Scoped : public Region
+    {
+    public:
+        Scoped (SpscFifo& f, int numWanted) noexcept
+            : Region (isWrite ? f.prepareToWrite (numWanted) : f.prepareToRead (numWanted)), fifo (f) {}
+
+        ~Scoped() noexcept
+        {
+            if (isWrite)
+                fifo.finishedWrite (blockSize1 + blockSize2);
+            else
+                fifo.finishedRead (blockSize1 + blockSize2);
+        }
+
+    private:
+        SpscFifo& fifo;
+
+        JUCE_DECLARE_NON_COPYABLE (Scoped)
+    };
+
+    Scoped<true>  write (int numToWrite) noexcept { return { *this, numToWrite }; }
+    Scoped<false> read  (int numToRead)  noexcept { return { *this, numToRead }; }
+
+private:
+    int used (int w, int r) const noexcept { return w >= r ? w - r : size - r + w; }
+
+    Region split (int start, int count) const noexcept
+    {
+        const int first = juce::jmin (count, size - start);
+        return { start, first, 0, count - first };
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    // Written only by setTotalSize(); read by both sides.
+    alignas (kCacheLine) int size = 1;
+
+    // Producer's line.
+    alignas (kCacheLine) std::atomic<int> writePos { 0 };
+    int cachedReadPos = 0;
+
+    // Consumer's line.
+    alignas (kCacheLine) std::atomic<int> readPos { 0 };
+    int cachedWritePos = 0;
+
+    static_assert (std::atomic<int>::is_always_lock_free, "SpscFifo must not fall back to locked atomics");
+
+    JUCE_DECLARE_NON_COPYABLE (SpscFifo)
+};
@@ -0,0 +1,67 @@
+#include "WorkerWakeup.h"
+
+#if JUCE_LINUX || JUCE_ANDROID
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#elif JUCE_WINDOWS
+  #ifndef NOMINMAX
+   #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #pragma comment (lib, "Synchronization.lib")
+#elif JUCE_MAC || JUCE_IOS
+// Not in the SDK headers, but stable since macOS 10.12: libc++ builds
+// std::atomic::wait on the same two calls.
+extern "C" int __ulock_wait (uint32_t operation, void* address, uint64_t value, uint32_t timeoutMicros);
+extern "C" int __ulock_wake (uint32_t operation, void* address, uint64_t wakeValue);
+
+namespace
+{
+    constexpr uint32_t UL_COMPARE_AND_WAIT = 1;
+    constexpr uint32_t ULF_NO_ERRNO        = 0x01000000;
+}
+#endif
+
+namespace
+{
+    uint32_t* addressOf (std::atomic<uint32_t>& word) noexcept
+    {
+        return reinterpret_cast<uint32_t*> (&word);
+    }
+}
+
+//==============================================================================
+void WorkerWakeup::waitWhileEqual (std::atomic<uint32_t>& word, uint32_t expected, double timeoutSeconds) noexcept
+{
+    timeoutSeconds = juce::jmax (0.0, timeoutSeconds);
+
+   #if JUCE_LINUX || JUCE_ANDROID
+    const auto nanos = (long long) (timeoutSeconds * 1.0e9);
+    timespec timeout { (time_t) (nanos / 1000000000), (long) (nanos % 1000000000) };
+    syscall (SYS_futex, addressOf (word), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+   #elif JUCE_WINDOWS
+    WaitOnAddress (addressOf (word), &expected, sizeof (expected), (DWORD) std::ceil (timeoutSeconds * 1000.0));
+   #elif JUCE_MAC || JUCE_IOS
+    // A timeout of 0 means forever, so never round down to it.
+    const auto micros = (uint32_t) juce::jlimit (1.0, 4.0e9, std::ceil (timeoutSeconds * 1.0e6));
+    __ulock_wait (UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, addressOf (word), expected, micros);
+   #else
+    // No wait-on-address here: poll, which wait() turns into 1 ms steps.
+    juce::ignoreUnused (word, expected, timeoutSeconds);
+    juce::Thread::sleep (1);
+   #endif
+}
+
+void WorkerWakeup::wakeOne (std::atomic<uint32_t>& word) noexcept
+{
+   #if JUCE_LINUX || JUCE_ANDROID
+    syscall (SYS_futex, addressOf (word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+   #elif JUCE_WINDOWS
+    WakeByAddressSingle (addressOf (word));
+   #elif JUCE_MAC || JUCE_IOS
+    __ulock_wake (UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, addressOf (word), 0);
+   #else
+    juce::ignoreUnused (word);
+   #endif
+}
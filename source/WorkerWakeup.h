@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Wakes a worker thread from the audio thread without a mutex, and without
+ * a syscall unless the worker is actually asleep.
+ *
+ * After each wakeup the worker spins (yielding its time slice) for at most
+ * kSpinMicros, which catches a notify() that follows closely on the last one
+ * without keeping a core busy between blocks. Past that it flags itself as
+ * parked and blocks on the OS's wait-on-address primitive — a futex on
+ * Linux, WaitOnAddress on Windows, __ulock_wait on macOS — until woken or
+ * timed out, so an idle instance costs nothing.
+ *
+ * notify() is a store and a load; only when it sees the parked flag does it
+ * add the matching wake call, which never blocks and takes no lock. The
+ * flag and the notification are both sequentially consistent, so either
+ * the worker sees the notification before it sleeps or the notifier sees
+ * the flag and wakes it.
+ *
+ * Threads other than the audio thread (shutdown, prepare) call
+ * wakeFromControlThread(), which is the same call under a name that says
+ * where it is safe to make unconditionally.
+ */
+class WorkerWakeup
+{
+public:
+    static constexpr int kSpinMicros = 50;
+
+    /** Audio thread: wait-free, and syscall-free while the worker is awake. */
+    void notify() noexcept
+    {
+        pending.store (true, std::memory_order_seq_cst);
+
+        if (parked.load (std::memory_order_seq_cst))
+        {
+            epoch.fetch_add (1, std::memory_order_release);
+            wakeOne (epoch);
+        }
+    }
+
+    /** Any non-realtime thread: notifies and cuts a park short. */
+    void wakeFromControlThread() noexcept { notify(); }
+
+    /** Worker thread: returns true once notified (consuming the
+        notification), or false after timeoutMillis without one. */
+    bool wait (int timeoutMillis) noexcept
+    {
+        const auto start     = juce::Time::getHighResolutionTicks();
+        const auto deadline  = start + juce::Time::secondsToHighResolutionTicks (timeoutMillis * 0.001);
+        const auto spinUntil = start + juce::Time::secondsToHighResolutionTicks (kSpinMicros * 1.0e-6);
+
+        for (;;)
+        {
+            if (pending.exchange (false, std::memory_order_acquire))
+                return true;
+
+            const auto now = juce::Time::getHighResolutionTicks();
+
+            if (now >= deadline)
+                return false;
+
+            if (now < spinUntil)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Read the epoch before the last look at the notification: a
+            // notify() after that look bumps it, and the park returns at once.
+            parked.store (true, std::memory_order_seq_cst);
+            const auto seen = epoch.load (std::memory_order_acquire);
+
+            if (! pending.load (std::memory_order_seq_cst))
+                waitWhileEqual (epoch, seen, juce::Time::highResolutionTicksToSeconds (deadline - now));
+
+            parked.store (false, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    // Blocks while the word still holds `expected`, for up to timeoutSeconds.
+    // May return early or spuriously; wait() re-checks either way.
+    static void waitWhileEqual (std::atomic<uint32_t>& word, uint32_t expected, double timeoutSeconds) noexcept;
+    static void wakeOne (std::atomic<uint32_t>& word) noexcept;
+
+    alignas (64) std::atomic<bool> pending { false };
+    std::atomic<bool> parked { false };
+    std::atomic<uint32_t> epoch { 0 };
+
+    static_assert (sizeof (std::atomic<uint32_t>) == sizeof (uint32_t)
+                   && std::atomic<uint32_t>::is_always_lock_free,
+                   "the OS waits on the atomic's own address");
+};
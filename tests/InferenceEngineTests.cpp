@@ -0,0 +1,1301 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "InferenceEngine.h"
+#include "ModelVariants.h"
+#include "SessionCache.h"
+
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <thread>
+
+// ── Heap allocation counter ──────────────────────────────────────────────────
+// Replaces the global operator new for this test binary so a test can assert
+// that a section of code performs no heap allocations at all, on any thread.
+
+namespace
+{
+    std::atomic<int64_t> heapAllocations { 0 };
+}
+
+void* operator new (std::size_t size)
+{
+    heapAllocations.fetch_add (1, std::memory_order_relaxed);
+
+    if (auto* ptr = std::malloc (size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* ptr) noexcept                { std::free (ptr); }
+void operator delete (void* ptr, std::size_t) noexcept   { std::free (ptr); }
+
+// ── Helpers ──────────────────────────────────────────────────────────────────
+
+namespace
+{
+    /** Owns the result FIFO an engine writes into, like PluginProcessor does. */
+    struct ResultSink
+    {
+        ResultSink (int numChannels, int capacity)
+            : fifo (capacity + 1), storage (numChannels, capacity + 1)
+        {
+            storage.clear();
+        }
+
+        /** Waits up to timeoutMs for numSamples results, then drains channel 0
+            into dest (and the other channels into extraDest, if given). */
+        bool waitAndRead (float* dest, int numSamples, float* const* extraDest = nullptr,
+                          int timeoutMs = 2000)
+        {
+            for (int waited = 0; fifo.getNumReady() < numSamples && waited < timeoutMs; ++waited)
+                juce::Thread::sleep (1);
+
+            if (fifo.getNumReady() < numSamples)
+                return false;
+
+            const auto scope = fifo.read (numSamples);
+
+            for (int ch = 0; ch < storage.getNumChannels(); ++ch)
+            {
+                float* out = ch == 0 ? dest : (extraDest != nullptr ? extraDest[ch - 1] : nullptr);
+                if (out == nullptr)
+                    continue;
+
+                std::copy_n (storage.getReadPointer (ch, scope.startIndex1), scope.blockSize1, out);
+                std::copy_n (storage.getReadPointer (ch, scope.startIndex2), scope.blockSize2,
+                             out + scope.blockSize1);
+            }
+
+            return true;
+        }
+
+        SpscFifo                 fifo;
+        juce::AudioBuffer<float> storage;
+    };
+
+    void submitMono (InferenceEngine& engine, const float* data, int numSamples)
+    {
+        engine.submitInput (&data, 1, numSamples);
+    }
+}
+
+// ── Inference loop ────────────────────────────────────────────────────────────
+
+TEST_CASE ("InferenceEngine: passthrough returns input in fixed-size frames", "[inference]")
+{
+    InferenceEngine engine;
+    engine.prepare (1, 512);
+    const int frameSize = engine.getHopSize();
+
+    ResultSink sink (1, frameSize * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> input ((size_t) frameSize);
+    for (int i = 0; i < frameSize; ++i)
+        input[(size_t) i] = (float) i;
+
+    // Less than one frame must not produce any output.
+    submitMono (engine, input.data(), frameSize / 2);
+    juce::Thread::sleep (20);
+    REQUIRE (sink.fifo.getNumReady() == 0);
+
+    submitMono (engine, input.data() + frameSize / 2, frameSize - frameSize / 2);
+
+    std::vector<float> output ((size_t) frameSize);
+    REQUIRE (sink.waitAndRead (output.data(), frameSize));
+    REQUIRE (output == input);
+}
+
+TEST_CASE ("InferenceEngine: steady-state inference makes no heap allocations", "[inference][rt-safety]")
+{
+    InferenceEngine engine;
+    engine.setFraming (64, 256); // exercise the overlap-add path too
+    engine.prepare (1, 512);
+    const int frameSize = engine.getHopSize();
+
+    ResultSink sink (1, frameSize * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> input  ((size_t) frameSize, 0.25f);
+    std::vector<float> output ((size_t) frameSize);
+
+    // Warm-up: let the thread and any lazily-initialised state settle.
+    for (int i = 0; i < 4; ++i)
+    {
+        submitMono (engine, input.data(), frameSize);
+        REQUIRE (sink.waitAndRead (output.data(), frameSize));
+    }
+
+    constexpr int kNumFrames = 64;
+    int framesReturned = 0;
+
+    const auto before = heapAllocations.load();
+
+    for (int i = 0; i < kNumFrames; ++i)
+    {
+        submitMono (engine, input.data(), frameSize);
+        framesReturned += sink.waitAndRead (output.data(), frameSize) ? 1 : 0;
+    }
+
+    const auto allocations = heapAllocations.load() - before;
+
+    REQUIRE (framesReturned == kNumFrames);
+    REQUIRE (allocations == 0);
+}
+
+// Needs ONNX Runtime: the bound Session::Run path only exists with it.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: ONNX Runtime inference makes no heap allocations after warm-up", "[inference][rt-safety]")
+{
+    // A stateless model, and a stateful one whose state swaps every hop.
+    const auto modelName = GENERATE (as<std::string>(), "softclip.onnx", "hop_delay.onnx");
+    INFO (modelName);
+
+    InferenceEngine engine;
+    engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR).getChildFile (modelName)));
+    REQUIRE_FALSE (engine.runsInline());
+
+    engine.prepare (1, 512);
+    const int hop = engine.getHopSize();
+
+    ResultSink sink (1, hop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> input  ((size_t) hop, 0.25f);
+    std::vector<float> output ((size_t) hop);
+
+    // Warm-up: ORT sizes its arena and caches its execution plan on the
+    // first Runs.
+    for (int i = 0; i < 8; ++i)
+    {
+        submitMono (engine, input.data(), hop);
+        REQUIRE (sink.waitAndRead (output.data(), hop));
+    }
+
+    constexpr int kNumHops = 64;
+    int hopsReturned = 0;
+    const auto runsBefore = engine.getTelemetry().getSnapshot().runs;
+
+    const auto before = heapAllocations.load();
+
+    for (int i = 0; i < kNumHops; ++i)
+    {
+        submitMono (engine, input.data(), hop);
+        hopsReturned += sink.waitAndRead (output.data(), hop) ? 1 : 0;
+    }
+
+    const auto allocations = heapAllocations.load() - before;
+
+    REQUIRE (hopsReturned == kNumHops);
+    REQUIRE (engine.getTelemetry().getSnapshot().runs - runsBefore == (uint64_t) kNumHops);
+    REQUIRE (allocations == 0);
+}
+#endif
+
+TEST_CASE ("InferenceEngine: stereo channels are carried independently", "[inference][multichannel]")
+{
+    InferenceEngine engine;
+    engine.setFraming (64, 128);
+    engine.prepare (2, 1024);
+
+    REQUIRE (engine.getNumChannels() == 2);
+
+    const int hop = engine.getHopSize();
+    constexpr int kNumSamples = 1024;
+
+    ResultSink sink (2, kNumSamples);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> left (kNumSamples), right (kNumSamples);
+    for (int i = 0; i < kNumSamples; ++i)
+    {
+        left [(size_t) i] = std::sin (0.03f * (float) i);
+        right[(size_t) i] = -0.5f * std::cos (0.07f * (float) i);
+    }
+
+    const float* channels[] = { left.data(), right.data() };
+    engine.submitInput (channels, 2, kNumSamples);
+
+    std::vector<float> outLeft (kNumSamples), outRight (kNumSamples);
+    float* extra[] = { outRight.data() };
+    REQUIRE (sink.waitAndRead (outLeft.data(), kNumSamples, extra));
+
+    const int delay = engine.getWindowSize() - hop;
+    for (int i = delay; i < kNumSamples; ++i)
+    {
+        REQUIRE (outLeft [(size_t) i] == Catch::Approx (left [(size_t) (i - delay)]).margin (1e-5));
+        REQUIRE (outRight[(size_t) i] == Catch::Approx (right[(size_t) (i - delay)]).margin (1e-5));
+    }
+}
+
+// ── Framing and latency ───────────────────────────────────────────────────────
+
+TEST_CASE ("InferenceEngine: overlap-add passthrough reconstructs the input", "[inference][framing]")
+{
+    constexpr int kHop = 64, kWindow = 256, kNumHops = 32;
+
+    InferenceEngine engine;
+    engine.setFraming (kHop, kWindow);
+    engine.prepare (1, kHop * kNumHops);
+
+    REQUIRE (engine.getHopSize() == kHop);
+    REQUIRE (engine.getWindowSize() == kWindow);
+
+    ResultSink sink (1, kHop * kNumHops);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> input ((size_t) (kHop * kNumHops));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin (0.05f * (float) i);
+
+    submitMono (engine, input.data(), (int) input.size());
+
+    std::vector<float> output (input.size());
+    REQUIRE (sink.waitAndRead (output.data(), (int) output.size()));
+
+    // Overlap-add delays the signal by (window - hop) samples.
+    constexpr int kDelay = kWindow - kHop;
+    for (size_t i = kDelay; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (input[i - kDelay]).margin (1e-5));
+}
+
+TEST_CASE ("InferenceEngine: primed output never runs dry for large host blocks", "[inference][framing]")
+{
+    constexpr int kBlockSize = 1024, kNumBlocks = 16;
+
+    InferenceEngine engine;
+    engine.setFraming (96, 384); // hop that does not divide the block size
+    engine.prepare (1, kBlockSize);
+
+    const int latency = engine.getLatencySamples();
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+
+    // Mirror MojoInsectsAudioProcessor::prepareToPlay.
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) (kBlockSize * kNumBlocks));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin (0.01f * (float) i);
+
+    std::vector<float> output (input.size());
+    int dryBlocks = 0;
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        const size_t offset = (size_t) (block * kBlockSize);
+        submitMono (engine, input.data() + offset, kBlockSize);
+
+        // processBlock reads straight after submitting; give the thread the
+        // previous block's worth of time first, as a realtime host would.
+        if (resultFifo.getNumReady() < kBlockSize)
+        {
+            ++dryBlocks;
+            continue;
+        }
+
+        const auto scope = resultFifo.read (kBlockSize);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data() + offset);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + offset + (size_t) scope.blockSize1);
+
+        juce::Thread::sleep (20);
+    }
+
+    REQUIRE (dryBlocks == 0);
+
+    // The wet signal is the input delayed by exactly the reported latency.
+    for (size_t i = (size_t) latency; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (input[i - (size_t) latency]).margin (1e-5));
+}
+
+// ── Stateful models ───────────────────────────────────────────────────────────
+
+// Needs ONNX Runtime: without it the model loads as a passthrough with no state.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: recurrent state carries across hops until reset or re-prepared", "[inference][state]")
+{
+    // Each 64-sample hop comes out as the hop before it, held as the state.
+    constexpr int kHop = 64;
+
+    InferenceEngine engine;
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/hop_delay.onnx")));
+
+    engine.prepare (1, kHop);
+    REQUIRE (engine.getHopSize() == kHop);
+    REQUIRE (engine.getWindowSize() == kHop);
+
+    ResultSink sink (1, kHop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    // Runs one hop of a constant and returns what came out.
+    const auto runHop = [&engine, &sink] (float value)
+    {
+        const std::vector<float> input ((size_t) kHop, value);
+        std::vector<float> output ((size_t) kHop);
+        submitMono (engine, input.data(), kHop);
+        REQUIRE (sink.waitAndRead (output.data(), kHop));
+        REQUIRE (std::all_of (output.begin(), output.end(), [&output] (float x) { return x == output.front(); }));
+        return output.front();
+    };
+
+    REQUIRE (runHop (1.0f) == 0.0f);
+    REQUIRE (runHop (2.0f) == 1.0f);
+    REQUIRE (runHop (3.0f) == 2.0f);
+
+    engine.resetState();
+    REQUIRE (runHop (4.0f) == 0.0f);
+    REQUIRE (runHop (5.0f) == 4.0f);
+
+    engine.prepare (1, kHop);
+    REQUIRE (runHop (6.0f) == 0.0f);
+    REQUIRE (runHop (7.0f) == 6.0f);
+}
+#endif
+
+// ── Offline rendering ─────────────────────────────────────────────────────────
+
+TEST_CASE ("InferenceEngine: offline mode infers synchronously with the realtime latency", "[inference][offline]")
+{
+    constexpr int kBlockSize = 512, kNumBlocks = 8;
+
+    InferenceEngine engine;
+    engine.setFraming (128, 256);
+    engine.setOfflineMode (true);
+    engine.prepare (1, kBlockSize);
+
+    REQUIRE (engine.isOfflineMode());
+
+    const int latency = engine.getLatencySamples();
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) (kBlockSize * kNumBlocks));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin (0.02f * (float) i);
+
+    std::vector<float> output (input.size());
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        const size_t offset = (size_t) (block * kBlockSize);
+        submitMono (engine, input.data() + offset, kBlockSize);
+        engine.processPendingInput();
+
+        // No waiting: the block's results must already be there.
+        REQUIRE (resultFifo.getNumReady() >= kBlockSize);
+
+        const auto scope = resultFifo.read (kBlockSize);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data() + offset);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + offset + (size_t) scope.blockSize1);
+    }
+
+    for (size_t i = (size_t) latency; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (input[i - (size_t) latency]).margin (1e-5));
+
+    // Switching back restores the background-thread path.
+    engine.setOfflineMode (false);
+    engine.prepare (1, kBlockSize);
+    REQUIRE_FALSE (engine.isOfflineMode());
+}
+
+// ── Telemetry ─────────────────────────────────────────────────────────────────
+
+TEST_CASE ("EngineTelemetry: run durations land in log2 buckets", "[telemetry]")
+{
+    EngineTelemetry telemetry;
+
+    REQUIRE (telemetry.getSnapshot().getRunQuantileMicros (0.5) == 0.0);
+
+    for (int i = 0; i < 99; ++i)
+        telemetry.recordRun (40.0);   // [32, 64) us
+    telemetry.recordRun (3000.0);     // [2048, 4096) us
+
+    const auto snapshot = telemetry.getSnapshot();
+    REQUIRE (snapshot.runs == 100);
+    REQUIRE (snapshot.runHistogram[6]  == 99);
+    REQUIRE (snapshot.runHistogram[12] == 1);
+    REQUIRE (snapshot.getRunQuantileMicros (0.50) == 64.0);
+    REQUIRE (snapshot.getRunQuantileMicros (0.99) == 64.0);
+    REQUIRE (snapshot.getRunQuantileMicros (1.00) == 4096.0);
+}
+
+TEST_CASE ("InferenceEngine: telemetry counts runs, drops and FIFO high-water", "[inference][telemetry]")
+{
+    constexpr int kBlockSize = 256;
+
+    InferenceEngine engine;
+    engine.setFraming (kBlockSize, kBlockSize);
+    engine.setOfflineMode (true); // deterministic: nothing runs until asked
+    engine.prepare (1, kBlockSize);
+
+    ResultSink sink (1, engine.getRequiredOutputFifoSize());
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    // Overfill the input FIFO without draining it.
+    std::vector<float> input (4096, 0.5f);
+    submitMono (engine, input.data(), (int) input.size());
+
+    auto snapshot = engine.getTelemetry().getSnapshot();
+    const auto accepted = (uint64_t) snapshot.inputFifoHighWater;
+    REQUIRE (accepted > 0);
+    REQUIRE (snapshot.droppedInputSamples == input.size() - accepted);
+    REQUIRE (snapshot.runs == 0);
+
+    engine.processPendingInput();
+
+    snapshot = engine.getTelemetry().getSnapshot();
+    REQUIRE (snapshot.runs > 0);
+    REQUIRE (snapshot.outputFifoHighWater > 0);
+
+    uint64_t histogramTotal = 0;
+    for (auto count : snapshot.runHistogram)
+        histogramTotal += count;
+    REQUIRE (histogramTotal == snapshot.runs);
+}
+
+// ── Deadline scheduling ───────────────────────────────────────────────────────
+
+namespace
+{
+    /** Runs hops of the given cost until the scheduler changes level, and
+        returns how many ran at the old one. */
+    int hopsUntilLevelChanges (DeadlineScheduler& scheduler, double micros)
+    {
+        const auto start = scheduler.getQuality();
+        int hops = 0;
+
+        while (scheduler.beginHop (1) == start && hops < 100000)
+        {
+            scheduler.endHop (micros);
+            ++hops;
+        }
+
+        return hops;
+    }
+}
+
+TEST_CASE ("DeadlineScheduler: degrades before the hop budget is spent and recovers with headroom", "[inference][deadline]")
+{
+    using Quality = DeadlineScheduler::Quality;
+
+    DeadlineScheduler scheduler;
+    scheduler.prepare (48000.0, 480, 2, true);   // 10 ms per hop
+    REQUIRE (scheduler.getBudgetMicros() == Catch::Approx (10000.0));
+
+    // Comfortably inside the budget: full quality throughout.
+    for (int i = 0; i < 1000; ++i)
+    {
+        REQUIRE (scheduler.beginHop (1) == Quality::full);
+        scheduler.endHop (4000.0);
+    }
+
+    // Past three quarters of the hop for a few hops running: the fallback
+    // model takes over. A slow fallback is still better than dry, so only
+    // a backlog bypasses it.
+    REQUIRE (hopsUntilLevelChanges (scheduler, 8000.0) == DeadlineScheduler::kDegradeAfterHops);
+    REQUIRE (scheduler.getQuality() == Quality::reduced);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        REQUIRE (scheduler.beginHop (1) == Quality::reduced);
+        scheduler.endHop (9000.0);
+    }
+
+    REQUIRE (scheduler.beginHop (4) == Quality::bypassed);
+
+    // Headroom brings it back one level at a time.
+    REQUIRE (hopsUntilLevelChanges (scheduler, 0.0) == DeadlineScheduler::kRecoverAfterHops - 1);
+    REQUIRE (scheduler.getQuality() == Quality::reduced);
+
+    scheduler.endHop (3000.0);
+    REQUIRE (hopsUntilLevelChanges (scheduler, 3000.0) == DeadlineScheduler::kRecoverAfterHops - 1);
+    REQUIRE (scheduler.getQuality() == Quality::full);
+
+    // A probe that cannot hold doubles the wait before the next one.
+    for (int i = 0; i < DeadlineScheduler::kDegradeAfterHops; ++i)
+    {
+        REQUIRE (scheduler.beginHop (1) == Quality::full);
+        scheduler.endHop (8000.0);
+    }
+
+    REQUIRE (scheduler.getQuality() == Quality::reduced);
+    REQUIRE (hopsUntilLevelChanges (scheduler, 3000.0) == 2 * DeadlineScheduler::kRecoverAfterHops - 1);
+    REQUIRE (scheduler.getQuality() == Quality::full);
+}
+
+TEST_CASE ("DeadlineScheduler: a lone slow Run is absorbed, and without a fallback only a backlog bypasses", "[inference][deadline]")
+{
+    using Quality = DeadlineScheduler::Quality;
+
+    for (const bool hasFallback : { true, false })
+    {
+        DeadlineScheduler scheduler;
+        scheduler.prepare (48000.0, 480, 2, hasFallback);   // 10 ms per hop
+
+        // One Run blows the whole budget every so often; the ones between
+        // are fine, and nothing changes level.
+        for (int i = 0; i < 1000; ++i)
+        {
+            REQUIRE (scheduler.beginHop (1) == Quality::full);
+            scheduler.endHop (i % 16 == 0 ? 20000.0 : 4000.0);
+        }
+
+        REQUIRE (scheduler.getNumTransitions() == 0);
+    }
+
+    // With nothing lighter to run, the model keeps running under sustained
+    // pressure: its output is still wet and the FIFO's priming covers it.
+    DeadlineScheduler scheduler;
+    scheduler.prepare (48000.0, 480, 2, false);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        REQUIRE (scheduler.beginHop (1) == Quality::full);
+        scheduler.endHop (9000.0);
+    }
+
+    REQUIRE (scheduler.beginHop (4) == Quality::bypassed);
+    REQUIRE (scheduler.getNumTransitions() == 1);
+}
+
+TEST_CASE ("DeadlineScheduler: a backlog bypasses at once, and no sample rate means no deadline", "[inference][deadline]")
+{
+    using Quality = DeadlineScheduler::Quality;
+
+    DeadlineScheduler scheduler;
+    scheduler.prepare (48000.0, 128, 4, false);
+
+    REQUIRE (scheduler.beginHop (5) == Quality::full);    // one block's worth plus a partial hop
+    REQUIRE (scheduler.beginHop (6) == Quality::bypassed);
+    REQUIRE (scheduler.getNumTransitions() == 1);
+
+    scheduler.prepare (0.0, 128, 4, true);
+    REQUIRE_FALSE (scheduler.isEnabled());
+    REQUIRE (scheduler.beginHop (100) == Quality::full);
+    scheduler.endHop (1.0e9);
+    REQUIRE (scheduler.getQuality() == Quality::full);
+}
+
+TEST_CASE ("InferenceEngine: bypassed hops stay aligned to the reported latency", "[inference][deadline]")
+{
+    constexpr int kBlockSize = 1024, kHop = 128, kBurst = 2048;
+
+    InferenceEngine engine;
+    engine.setFraming (kHop, 2 * kHop);
+    engine.prepare (1, kBlockSize, 48000.0);
+
+    const int latency = engine.getLatencySamples();
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) kBurst);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin (0.03f * (float) i);
+
+    // Twice the largest block at once looks like a stalled inference thread.
+    submitMono (engine, input.data(), kBurst);
+
+    const int expected = engine.getPrimingSamples() + kBurst;
+    for (int waited = 0; resultFifo.getNumReady() < expected && waited < 2000; ++waited)
+        juce::Thread::sleep (1);
+
+    REQUIRE (resultFifo.getNumReady() == expected);
+    REQUIRE (engine.getQuality() == DeadlineScheduler::Quality::bypassed);
+
+    const auto snapshot = engine.getTelemetry().getSnapshot();
+    REQUIRE (snapshot.bypassedHops > 0);
+    REQUIRE (snapshot.reducedHops == 0);
+
+    std::vector<float> output ((size_t) expected);
+    {
+        const auto scope = resultFifo.read (expected);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data());
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + scope.blockSize1);
+    }
+
+    // Bypassed or not, every sample comes out exactly `latency` late.
+    for (size_t i = (size_t) latency; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (input[i - (size_t) latency]).margin (1e-5));
+}
+
+// ── Quantized variants ───────────────────────────────────────────────────────
+
+TEST_CASE ("ModelVariants: variants sit next to the float model and fall back to it", "[inference][variants]")
+{
+    using Precision = ModelVariants::Precision;
+
+    const juce::File amp ("/models/amp.onnx");
+    REQUIRE (ModelVariants::getFile (amp, Precision::int8).getFullPathName() == "/models/amp.int8.onnx");
+    REQUIRE (ModelVariants::getFile (amp, Precision::fp16).getFullPathName() == "/models/amp.fp16.onnx");
+    REQUIRE (ModelVariants::getFile (amp, Precision::float32) == amp);
+
+    const juce::File softclip (MOJO_TEST_MODEL_DIR "/softclip.onnx");
+    juce::String note;
+
+    REQUIRE (ModelVariants::select (softclip, Precision::float32, note) == softclip);
+    REQUIRE (note.isEmpty());
+
+    REQUIRE (ModelVariants::select (softclip, Precision::fp16, note).getFileName() == "softclip.fp16.onnx");
+
+    REQUIRE (ModelVariants::select (softclip, Precision::int8, note) == softclip);
+    REQUIRE (note.contains ("no int8"));
+}
+
+TEST_CASE ("ModelVariants: error is measured as SNR and peak difference", "[inference][variants]")
+{
+    juce::AudioBuffer<float> reference (2, 1000), test (2, 1000);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < 1000; ++i)
+            reference.setSample (ch, i, 0.5f * std::sin (0.05f * (float) (i + ch)));
+
+    test.makeCopyOf (reference);
+    auto error = ModelVariants::measureError (reference, test);
+    REQUIRE (std::isinf (error.snrDb));
+    REQUIRE (error.maxAbs == 0.0);
+
+    // A 1 % gain error is 40 dB down, peaking at 1 % of the peak.
+    test.applyGain (0.99f);
+    error = ModelVariants::measureError (reference, test);
+    REQUIRE (error.snrDb == Catch::Approx (40.0).margin (0.01));
+    REQUIRE (error.maxAbs == Catch::Approx (0.005).margin (1.0e-5));
+}
+
+TEST_CASE ("ModelVariants: verify accepts a faithful variant and refuses one outside tolerance", "[inference][variants]")
+{
+    using Precision = ModelVariants::Precision;
+
+    const juce::File softclip (MOJO_TEST_MODEL_DIR "/softclip.onnx");
+    const auto reference = ModelVariants::makeReferenceSignal (1, 48000.0, 0.5);
+
+    REQUIRE (reference.getNumSamples() == 24000);
+    REQUIRE (reference.getMagnitude (0, reference.getNumSamples()) <= 1.0f);
+
+    // The bundled fp16 variant stores its weight exactly, so nothing moves.
+    const auto report = ModelVariants::verify (softclip, Precision::fp16, reference);
+    REQUIRE (report.found);
+    REQUIRE (report.accepted);
+    REQUIRE (report.error.snrDb >= 100.0);
+    REQUIRE (report.speedup > 0.0);
+    REQUIRE (report.reason.isEmpty());
+
+    ModelVariants::Tolerance strict;
+    strict.maxAbsError = -1.0;   // nothing can meet it
+    const auto refused = ModelVariants::verify (softclip, Precision::fp16, reference, strict);
+    REQUIRE (refused.found);
+    REQUIRE_FALSE (refused.accepted);
+    REQUIRE (refused.reason.contains ("fp16"));
+
+    const auto missing = ModelVariants::verify (softclip, Precision::int8, reference);
+    REQUIRE_FALSE (missing.found);
+    REQUIRE_FALSE (missing.accepted);
+    REQUIRE (missing.reason.isNotEmpty());
+
+    // Automatic takes the verified fp16 variant, since there is no int8 one.
+    juce::String note;
+    REQUIRE (ModelVariants::select (softclip, Precision::automatic, note).getFileName() == "softclip.fp16.onnx");
+    REQUIRE (note.contains ("verified"));
+}
+
+// ── Session sharing ───────────────────────────────────────────────────────────
+
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("SessionCache: engines loading the same model share one session until the last lets go", "[inference][sessions]")
+{
+    // The engines share this cache, which lives as long as any of them.
+    juce::SharedResourcePointer<SessionCache> cache;
+    const juce::File modelFile (MOJO_TEST_MODEL_DIR "/gain_48k.onnx");
+
+    {
+        auto first  = cache->acquire (modelFile, {});
+        auto second = cache->acquire (modelFile, {});
+        REQUIRE (first != nullptr);
+        REQUIRE (first == second);
+        REQUIRE (cache->getNumLiveSessions() == 1);
+    }
+
+    REQUIRE (cache->getNumLiveSessions() == 0);
+
+    // Loads racing for the same model build it once and share the result.
+    {
+        std::vector<std::shared_ptr<Ort::Session>> racing (4);
+        std::vector<std::thread> loaders;
+
+        for (auto& session : racing)
+            loaders.emplace_back ([&cache, &modelFile, &session] { session = cache->acquire (modelFile, {}); });
+
+        for (auto& loader : loaders)
+            loader.join();
+
+        REQUIRE (racing.front() != nullptr);
+        REQUIRE (std::all_of (racing.begin(), racing.end(), [&racing] (const auto& s) { return s == racing.front(); }));
+        REQUIRE (cache->getNumLiveSessions() == 1);
+    }
+
+    REQUIRE (cache->getNumLiveSessions() == 0);
+
+    auto first  = std::make_unique<InferenceEngine>();
+    auto second = std::make_unique<InferenceEngine>();
+    REQUIRE (first->loadModel (modelFile));
+    REQUIRE (second->loadModel (modelFile));
+    REQUIRE (cache->getNumLiveSessions() == 1);
+
+    first.reset();
+    REQUIRE (cache->getNumLiveSessions() == 1);
+
+    second.reset();
+    REQUIRE (cache->getNumLiveSessions() == 0);
+}
+#endif
+
+// ── Thread scheduling ─────────────────────────────────────────────────────────
+
+TEST_CASE ("EngineThreading: settings survive the plugin state, and missing ones keep their defaults", "[inference][threading]")
+{
+    EngineThreading threading;
+    threading.priority          = EngineThreading::Priority::realtime;
+    threading.realtimePriority  = 9;
+    threading.affinityMask      = 0xc;
+    threading.intraOpThreads    = 2;
+    threading.interOpThreads    = 3;
+    threading.allowSpinning     = false;
+    threading.parallelExecution = true;
+
+    const auto xml = threading.toValueTree().toXmlString();
+    REQUIRE (EngineThreading::fromValueTree (juce::ValueTree::fromXml (xml)) == threading);
+
+    REQUIRE (EngineThreading::fromValueTree ({}) == EngineThreading {});
+
+    // Sessions with different ORT options are never shared.
+    REQUIRE (threading.getSessionKey() != EngineThreading {}.getSessionKey());
+}
+
+TEST_CASE ("InferenceEngine: new thread scheduling restarts the worker, which keeps inferring", "[inference][threading]")
+{
+    InferenceEngine engine;
+    engine.prepare (1, 512);
+    const int hop = engine.getHopSize();
+
+    ResultSink sink (1, hop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    EngineThreading threading;
+    threading.priority     = EngineThreading::Priority::normal;
+    threading.affinityMask = 1;   // CPU 0 exists everywhere
+    REQUIRE (engine.setThreading (threading));
+    REQUIRE (engine.getThreading() == threading);
+
+    std::vector<float> input ((size_t) hop, 0.25f), output ((size_t) hop);
+    submitMono (engine, input.data(), hop);
+    REQUIRE (sink.waitAndRead (output.data(), hop));
+    REQUIRE (output == input);
+
+    // Without permission a realtime class is refused, but the thread still runs.
+    threading.priority = EngineThreading::Priority::realtime;
+    engine.setThreading (threading);
+
+    submitMono (engine, input.data(), hop);
+    REQUIRE (sink.waitAndRead (output.data(), hop));
+    REQUIRE (output == input);
+}
+
+// ── Conditioning controls ─────────────────────────────────────────────────────
+
+TEST_CASE ("ModelControls: parses names, ranges and defaults from metadata", "[inference][controls]")
+{
+    const auto controls = ModelControls::parse ("drive=0.5:8:2, tone=-1:1, =bad:range:3", 4, true);
+
+    REQUIRE (controls.size() == 4);
+    REQUIRE (controls.perSample);
+
+    const auto& drive = controls.controls[0];
+    REQUIRE (drive.name == "drive");
+    REQUIRE (drive.minimum == 0.5f);
+    REQUIRE (drive.maximum == 8.0f);
+    REQUIRE (drive.defaultValue == 2.0f);
+    REQUIRE (drive.fromNormalised (1.0f) == 8.0f);
+    REQUIRE (drive.toNormalised (drive.fromNormalised (0.25f)) == Catch::Approx (0.25f));
+
+    // Without a default a control starts at its minimum.
+    REQUIRE (controls.controls[1].name == "tone");
+    REQUIRE (controls.controls[1].defaultValue == -1.0f);
+
+    // Malformed and missing entries fall back to "Control n" over 0..1.
+    REQUIRE (controls.controls[2].name == "Control 3");
+    REQUIRE (controls.controls[2].maximum == 1.0f);
+    REQUIRE (controls.controls[2].defaultValue == 1.0f);
+    REQUIRE (controls.controls[3].name == "Control 4");
+
+    REQUIRE (ModelControls::parse ({}, 20, false).size() == ModelControls::kMaxControls);
+}
+
+// Needs ONNX Runtime: without it the model loads as a passthrough with no controls.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: feeds controls to a conditioned model as a second input", "[inference][controls]")
+{
+    // output = tanh (drive * input), with drive a per-frame control.
+    InferenceEngine engine;
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip_drive.onnx")));
+    REQUIRE_FALSE (engine.runsInline());
+
+    const auto controls = engine.getControls();
+    REQUIRE (controls.size() == 1);
+    REQUIRE (controls.controls[0].name == "drive");
+    REQUIRE_FALSE (controls.perSample);
+
+    engine.prepare (1, 512);
+    const int hop = engine.getHopSize();
+
+    ResultSink sink (1, hop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    std::vector<float> input ((size_t) hop, 0.25f), output ((size_t) hop);
+
+    // Until told otherwise the model runs at its declared default.
+    submitMono (engine, input.data(), hop);
+    REQUIRE (sink.waitAndRead (output.data(), hop));
+    REQUIRE (output.back() == Catch::Approx (std::tanh (2.0f * 0.25f)).margin (1.0e-5));
+
+    // Fully up is the top of the declared range, reached within the hop.
+    const float fullyUp = 1.0f;
+    engine.setControls (&fullyUp, 1);
+
+    for (int repeat = 0; repeat < 2; ++repeat)
+    {
+        submitMono (engine, input.data(), hop);
+        REQUIRE (sink.waitAndRead (output.data(), hop));
+        REQUIRE (output.back() == Catch::Approx (std::tanh (8.0f * 0.25f)).margin (1.0e-5));
+    }
+
+    // Unconditioned models declare nothing.
+    engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx")));
+    REQUIRE (engine.getControls().isEmpty());
+}
+#endif
+
+// ── Spectral models ───────────────────────────────────────────────────────────
+
+TEST_CASE ("SpectralFrames: a row transforms back into its frame, and the windows add up to one", "[inference][spectral]")
+{
+    constexpr int kFftSize = 64, kHop = 16;
+
+    SpectralFrames stft;
+    stft.prepare (kFftSize);
+    REQUIRE (stft.getRowLength() == 2 * (kFftSize / 2 + 1));
+
+    std::vector<float> frame (kFftSize), row ((size_t) stft.getRowLength()), back (kFftSize);
+    for (int i = 0; i < kFftSize; ++i)
+        frame[(size_t) i] = std::sin (0.3f * (float) i) + 0.25f;
+
+    stft.analyse (frame.data(), row.data());
+
+    // Bin 0 is the frame's (positive) sum, with no phase.
+    REQUIRE (row[0] == Catch::Approx (std::accumulate (frame.begin(), frame.end(), 0.0f)).margin (1.0e-3));
+    REQUIRE (row[kFftSize / 2 + 1] == Catch::Approx (0.0f).margin (1.0e-5));
+
+    stft.synthesise (row.data(), back.data());
+    for (int i = 0; i < kFftSize; ++i)
+        REQUIRE (back[(size_t) i] == Catch::Approx (frame[(size_t) i]).margin (1.0e-5));
+
+    std::vector<float> analysis, synthesis;
+    SpectralFrames::makeWindows (kFftSize, kHop, analysis, synthesis);
+
+    for (int phase = 0; phase < kHop; ++phase)
+    {
+        float sum = 0.0f;
+        for (int i = phase; i < kFftSize; i += kHop)
+            sum += analysis[(size_t) i] * synthesis[(size_t) i];
+
+        REQUIRE (sum == Catch::Approx (1.0f));
+    }
+}
+
+// Needs ONNX Runtime: without it the model loads as a passthrough, with no STFT framing.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: a spectral model runs on batched STFT frames with the framing it declares", "[inference][spectral]")
+{
+    // Halves every magnitude of 256-point frames taken every 64 samples.
+    constexpr int kBlockSize = 512, kNumBlocks = 8;
+
+    InferenceEngine engine;
+    engine.setFraming (256);   // overridden by the model's mojo.hop
+    engine.setOfflineMode (true);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/spectral_gain.onnx")));
+    REQUIRE_FALSE (engine.runsInline());
+
+    engine.prepare (1, kBlockSize);
+    REQUIRE (engine.getWindowSize() == 256);
+    REQUIRE (engine.getHopSize() == 64);
+
+    // The overlap-add's (FFT size - hop) is part of the reported latency.
+    const int latency = engine.getLatencySamples();
+    REQUIRE (latency == (kBlockSize + 64 - 1) + (256 - 64));
+
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) (kBlockSize * kNumBlocks));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = 0.8f * std::sin (0.02f * (float) i);
+
+    std::vector<float> output (input.size());
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        const size_t offset = (size_t) (block * kBlockSize);
+        submitMono (engine, input.data() + offset, kBlockSize);
+        engine.processPendingInput();
+
+        REQUIRE (resultFifo.getNumReady() >= kBlockSize);
+
+        const auto scope = resultFifo.read (kBlockSize);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data() + offset);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + offset + (size_t) scope.blockSize1);
+    }
+
+    for (size_t i = (size_t) latency; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (0.5f * input[i - (size_t) latency]).margin (1.0e-4));
+
+    // Each block's eight hops went through in one batched Run, not one each.
+    REQUIRE (engine.getTelemetry().getSnapshot().runs == (uint64_t) kNumBlocks);
+}
+#endif
+
+// ── Model chains ──────────────────────────────────────────────────────────────
+
+// Needs ONNX Runtime: passthrough stages neither scale the signal nor declare a hop.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: a model chain runs each stage on the one before's output, with their latencies summed", "[inference][chain]")
+{
+    // Two spectral gains in series quarter the input.
+    constexpr int kBlockSize = 512, kNumBlocks = 8;
+    const juce::File model (MOJO_TEST_MODEL_DIR "/spectral_gain.onnx");
+
+    InferenceEngine engine;
+    engine.setOfflineMode (true);
+    REQUIRE (engine.loadModelChain ({ model, model }));
+    REQUIRE (engine.getNumChainStages() == 2);
+
+    engine.prepare (1, kBlockSize);
+
+    const int stageLatency = (kBlockSize + 64 - 1) + (256 - 64);
+    REQUIRE (engine.getChainStage (1).getLatencySamples() == stageLatency);
+
+    const int latency = engine.getLatencySamples();
+    REQUIRE (latency == 2 * stageLatency);
+    REQUIRE (engine.getPrimingSamples() == 2 * (kBlockSize + 64 - 1));
+
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) (kBlockSize * kNumBlocks));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = 0.8f * std::sin (0.02f * (float) i);
+
+    std::vector<float> output (input.size());
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        const size_t offset = (size_t) (block * kBlockSize);
+        submitMono (engine, input.data() + offset, kBlockSize);
+        engine.processPendingInput();
+
+        REQUIRE (resultFifo.getNumReady() >= kBlockSize);
+
+        const auto scope = resultFifo.read (kBlockSize);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data() + offset);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + offset + (size_t) scope.blockSize1);
+    }
+
+    for (size_t i = (size_t) latency; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (0.25f * input[i - (size_t) latency]).margin (1.0e-4));
+
+    // Each stage ran its own batches, and neither dropped a sample.
+    for (int stage = 0; stage < engine.getNumChainStages(); ++stage)
+    {
+        const auto snapshot = engine.getChainStage (stage).getTelemetry().getSnapshot();
+        REQUIRE (snapshot.runs > 0);
+        REQUIRE (snapshot.droppedInputSamples == 0);
+        REQUIRE (snapshot.droppedOutputSamples == 0);
+    }
+}
+#endif
+
+// ── Sample-rate conversion ────────────────────────────────────────────────────
+
+TEST_CASE ("PolyphaseResampler: converts 44.1 to 48 kHz by the exact ratio, delayed by its latency", "[inference][resampling]")
+{
+    constexpr int kInputRate = 44100, kOutputRate = 48000, kBlockSize = 441, kNumBlocks = 20;
+    const double omega = juce::MathConstants<double>::twoPi * 1000.0 / kInputRate;
+
+    PolyphaseResampler resampler;
+    REQUIRE (resampler.prepare (kInputRate, kOutputRate, 1, 128));   // blocks are split into chunks
+    REQUIRE (resampler.getUpFactor() == 160);
+    REQUIRE (resampler.getDownFactor() == 147);
+
+    std::vector<float> input (kBlockSize), output ((size_t) resampler.getMaxOutputSamples (kBlockSize));
+    std::vector<float> converted;
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        for (int i = 0; i < kBlockSize; ++i)
+            input[(size_t) i] = (float) (0.8 * std::sin (omega * (block * kBlockSize + i)));
+
+        const float* in = input.data();
+        float* out = output.data();
+        const int produced = resampler.process (&in, kBlockSize, &out);
+
+        REQUIRE (produced <= resampler.getMaxOutputSamples (kBlockSize));
+        converted.insert (converted.end(), output.begin(), output.begin() + produced);
+    }
+
+    // 200 ms in, 200 ms out.
+    REQUIRE (converted.size() == (size_t) (kOutputRate / 5));
+
+    // Output k is the input at k × 44100 / 48000, less the filter's delay.
+    const double delay = resampler.getLatencyInInputSamples();
+
+    for (size_t k = 128; k < converted.size(); ++k)
+    {
+        const double t = (double) k * kInputRate / kOutputRate - delay;
+        REQUIRE (converted[k] == Catch::Approx (0.8 * std::sin (omega * t)).margin (1.0e-4));
+    }
+}
+
+// Needs ONNX Runtime: only its model loader reads the declared sample rate.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: a model declaring its sample rate runs at it, converted within the reported latency", "[inference][resampling]")
+{
+    // Halves its input, at 48 kHz only.
+    constexpr int kBlockSize = 512, kNumBlocks = 16;
+
+    InferenceEngine engine;
+    engine.setOfflineMode (true);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/gain_48k.onnx")));
+    REQUIRE_FALSE (engine.runsInline());
+    REQUIRE (engine.getModelSampleRate() == 48000);
+
+    // At its own rate nothing is converted, and the latency is the usual one.
+    engine.prepare (1, kBlockSize, 48000.0);
+    REQUIRE_FALSE (engine.isResampling());
+    REQUIRE (engine.getLatencySamples() == kBlockSize + InferenceEngine::kDefaultWindowSize - 1);
+
+    // At 96 kHz each 256-sample hop covers 512 session samples, and the
+    // conversion filters add their delay.
+    engine.prepare (1, kBlockSize, 96000.0);
+    REQUIRE (engine.isResampling());
+    REQUIRE (engine.getHopSize() == InferenceEngine::kDefaultWindowSize);
+
+    const int latency = engine.getLatencySamples();
+    REQUIRE (latency > engine.getPrimingSamples());
+    REQUIRE (engine.getPrimingSamples() >= kBlockSize + 2 * InferenceEngine::kDefaultWindowSize - 1);
+
+    const int fifoSize = engine.getRequiredOutputFifoSize();
+    SpscFifo resultFifo (fifoSize);
+    juce::AudioBuffer<float> resultStorage (1, fifoSize);
+    resultStorage.clear();
+    resultFifo.finishedWrite (engine.getPrimingSamples());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    std::vector<float> input ((size_t) (kBlockSize * kNumBlocks));
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = 0.8f * std::sin (0.02f * (float) i);
+
+    std::vector<float> output (input.size());
+
+    for (int block = 0; block < kNumBlocks; ++block)
+    {
+        const size_t offset = (size_t) (block * kBlockSize);
+        submitMono (engine, input.data() + offset, kBlockSize);
+        engine.processPendingInput();
+
+        REQUIRE (resultFifo.getNumReady() >= kBlockSize);
+
+        const auto scope = resultFifo.read (kBlockSize);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex1), scope.blockSize1, output.data() + offset);
+        std::copy_n (resultStorage.getReadPointer (0, scope.startIndex2), scope.blockSize2,
+                     output.data() + offset + (size_t) scope.blockSize1);
+    }
+
+    // Past the filters' start-up, the halved input arrives exactly the
+    // reported latency later.
+    for (size_t i = (size_t) latency + 128; i < output.size(); ++i)
+        REQUIRE (output[i] == Catch::Approx (0.5f * input[i - (size_t) latency]).margin (1.0e-4));
+
+    const auto snapshot = engine.getTelemetry().getSnapshot();
+    REQUIRE (snapshot.droppedInputSamples == 0);
+    REQUIRE (snapshot.droppedOutputSamples == 0);
+}
+#endif
+
+// ── Model loading ─────────────────────────────────────────────────────────────
+
+TEST_CASE ("InferenceEngine: a failed background load is reported and leaves playback running", "[inference][loading]")
+{
+    InferenceEngine engine;
+    engine.prepare (1, 512);
+    const int hop = engine.getHopSize();
+
+    ResultSink sink (1, hop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    engine.loadModelAsync (juce::File::getSpecialLocation (juce::File::tempDirectory)
+                               .getChildFile ("mojo-insects-missing-model.onnx"));
+
+    for (int waited = 0; engine.getLoadStatus().state != InferenceEngine::LoadState::failed && waited < 2000; ++waited)
+        juce::Thread::sleep (1);
+
+    const auto status = engine.getLoadStatus();
+    REQUIRE (status.state == InferenceEngine::LoadState::failed);
+    REQUIRE (status.message.isNotEmpty());
+
+    // The engine keeps passing audio through.
+    std::vector<float> input ((size_t) hop, 0.5f), output ((size_t) hop);
+    submitMono (engine, input.data(), hop);
+    REQUIRE (sink.waitAndRead (output.data(), hop));
+    REQUIRE (output == input);
+}
+
+// Needs ONNX Runtime: without it both models load as the same passthrough.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: a compatible model is swapped in during playback with a crossfade", "[inference][loading]")
+{
+    // Hops of a constant 0.5: tanh (2 * 0.5) from the soft clipper, then
+    // 0.5 * 0.5 from the new model, with a ramp between and no gap.
+    constexpr int kHop = 64;
+    const float oldLevel = std::tanh (1.0f), newLevel = 0.25f;
+
+    juce::SharedResourcePointer<SessionCache> cache;
+
+    InferenceEngine engine;
+    engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+    engine.setFraming (kHop);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx")));
+
+    engine.prepare (1, kHop);
+    REQUIRE (engine.getHopSize() == kHop);
+    REQUIRE (engine.getWindowSize() == kHop);
+
+    ResultSink sink (1, kHop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    const std::vector<float> input ((size_t) kHop, 0.5f);
+    std::vector<float> output;
+
+    const auto streamHop = [&]
+    {
+        std::vector<float> hop ((size_t) kHop);
+        submitMono (engine, input.data(), kHop);
+        REQUIRE (sink.waitAndRead (hop.data(), kHop));
+        output.insert (output.end(), hop.begin(), hop.end());
+    };
+
+    for (int i = 0; i < 8; ++i)
+        streamHop();
+
+    REQUIRE (cache->getNumLiveSessions() == 1);
+
+    engine.loadModelAsync (juce::File (MOJO_TEST_MODEL_DIR "/half_gain.onnx"));
+
+    // Keep playing until the swap is done and the old model has been freed.
+    for (int i = 0; i < 4000 && (engine.getLoadStatus().state != InferenceEngine::LoadState::ready
+                                   || cache->getNumLiveSessions() > 1); ++i)
+        streamHop();
+
+    REQUIRE (engine.getLoadStatus().state == InferenceEngine::LoadState::ready);
+    REQUIRE (cache->getNumLiveSessions() == 1);
+
+    for (int i = 0; i < 8; ++i)
+        streamHop();
+
+    // From the old level down to the new one, never stepping back up, and
+    // through a ramp rather than in one jump.
+    REQUIRE (output.front() == Catch::Approx (oldLevel).margin (1.0e-5));
+    REQUIRE (output.back()  == Catch::Approx (newLevel).margin (1.0e-5));
+
+    int between = 0;
+
+    for (size_t i = 1; i < output.size(); ++i)
+    {
+        REQUIRE (output[i] <= output[i - 1] + 1.0e-5f);
+        between += output[i] < oldLevel - 1.0e-3f && output[i] > newLevel + 1.0e-3f ? 1 : 0;
+    }
+
+    REQUIRE (between >= InferenceEngine::kCrossfadeSamples / 2);
+}
+#endif
+
+// Needs ONNX Runtime: without it the model loads as a passthrough, with no framing of its own.
+#if MOJO_ONNX_ENABLED
+TEST_CASE ("InferenceEngine: a model needing other framing waits for the next prepare or release", "[inference][loading]")
+{
+    const bool releaseInstead = GENERATE (false, true);
+
+    InferenceEngine engine;
+    std::atomic<int> reprepares { 0 };
+    engine.onReprepareNeeded = [&reprepares] { ++reprepares; };
+
+    engine.prepare (1, 512);
+    const int hop = engine.getHopSize();
+    REQUIRE (hop != 64);
+
+    ResultSink sink (1, hop * 4);
+    engine.setOutputFifo (&sink.fifo, &sink.storage);
+
+    engine.loadModelAsync (juce::File (MOJO_TEST_MODEL_DIR "/spectral_gain.onnx"));
+
+    for (int waited = 0; reprepares.load() == 0 && waited < 5000; ++waited)
+        juce::Thread::sleep (1);
+
+    REQUIRE (reprepares.load() == 1);
+    REQUIRE (engine.getLoadStatus().state == InferenceEngine::LoadState::ready);
+
+    // Playback keeps its framing until the owner re-prepares or stops.
+    REQUIRE (engine.getHopSize() == hop);
+
+    if (releaseInstead)
+    {
+        engine.release();
+        REQUIRE_FALSE (engine.isPrepared());
+    }
+    else
+    {
+        engine.prepare (1, 512);
+    }
+
+    REQUIRE (engine.getWindowSize() == 256);
+    REQUIRE (engine.getHopSize() == 64);
+}
+#endif
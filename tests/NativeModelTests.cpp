@@ -0,0 +1,465 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "InferenceEngine.h"
+#include "NativeModel.h"
+
+// ── Helpers ──────────────────────────────────────────────────────────────────
+
+namespace
+{
+    OnnxGraph::Tensor tensor (std::vector<int64_t> dims, std::vector<float> data)
+    {
+        OnnxGraph::Tensor t;
+        t.dims     = std::move (dims);
+        t.data     = std::move (data);
+        t.dataType = OnnxGraph::kFloatType;
+        return t;
+    }
+
+    OnnxGraph::Node node (std::string opType, std::vector<std::string> inputs, std::vector<std::string> outputs)
+    {
+        OnnxGraph::Node n;
+        n.opType  = std::move (opType);
+        n.inputs  = std::move (inputs);
+        n.outputs = std::move (outputs);
+        return n;
+    }
+
+    /** A graph from "input" (one feature) to "output", to be filled in. */
+    OnnxGraph makeGraph()
+    {
+        OnnxGraph graph;
+        graph.inputs.push_back ({ "input", { 1, 1 } });
+        graph.outputs.push_back ({ "output", { 1, 1 } });
+        return graph;
+    }
+
+    std::vector<float> randomValues (juce::Random& random, size_t count)
+    {
+        std::vector<float> values (count);
+        for (auto& v : values)
+            v = random.nextFloat() - 0.5f;
+
+        return values;
+    }
+
+    float sigmoid (float x) { return 1.0f / (1.0f + std::exp (-x)); }
+
+    /** Runs a model over a deterministic test signal and checks every sample
+        against a scalar reference. */
+    template <typename Reference>
+    void requireMatches (NativeModel& model, Reference&& reference, int numSamples = 64)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = 0.8f * std::sin (0.37f * (float) i);
+            REQUIRE (model.processSample (x) == Catch::Approx (reference (x)).margin (1.0e-5));
+        }
+    }
+}
+
+// ── Layers ───────────────────────────────────────────────────────────────────
+
+TEST_CASE ("NativeModel: dense layers match a scalar reference", "[native]")
+{
+    constexpr int hidden = 5;   // deliberately not a multiple of the SIMD width
+
+    juce::Random random (1);
+    const auto w1 = randomValues (random, hidden), b1 = randomValues (random, hidden);
+    const auto w2 = randomValues (random, hidden);
+    const auto b2 = randomValues (random, 1);
+
+    auto graph = makeGraph();
+    graph.initializers["w1"] = tensor ({ hidden, 1 }, w1);   // transposed, [out, in]
+    graph.initializers["b1"] = tensor ({ hidden }, b1);
+    graph.initializers["w2"] = tensor ({ hidden, 1 }, w2);   // [in, out]
+    graph.initializers["b2"] = tensor ({ 1 }, b2);
+
+    auto gemm = node ("Gemm", { "input", "w1", "b1" }, { "h" });
+    gemm.attributes["transB"].i = 1;
+    graph.nodes.push_back (gemm);
+    graph.nodes.push_back (node ("Tanh", { "h" }, { "a" }));
+    graph.nodes.push_back (node ("MatMul", { "a", "w2" }, { "y" }));
+    graph.nodes.push_back (node ("Add", { "y", "b2" }, { "output" }));
+
+    juce::String error;
+    auto model = NativeModel::fromGraph (graph, error);
+    INFO (error);
+    REQUIRE (model != nullptr);
+    REQUIRE (model->getNumLayers() == 3);   // the Add is folded into the MatMul
+
+    requireMatches (*model, [&] (float x)
+    {
+        float y = b2[0];
+        for (int i = 0; i < hidden; ++i)
+            y += w2[(size_t) i] * std::tanh (w1[(size_t) i] * x + b1[(size_t) i]);
+
+        return y;
+    });
+}
+
+TEST_CASE ("NativeModel: a GRU carries its state from sample to sample", "[native]")
+{
+    constexpr int hidden = 3;
+    const bool linearBeforeReset = GENERATE (false, true);
+
+    juce::Random random (2);
+    const auto w = randomValues (random, 3 * hidden);
+    const auto r = randomValues (random, 3 * hidden * hidden);
+    const auto b = randomValues (random, 6 * hidden);
+    const auto readout = randomValues (random, hidden);
+
+    auto graph = makeGraph();
+    graph.initializers["W"] = tensor ({ 1, 3 * hidden, 1 }, w);
+    graph.initializers["R"] = tensor ({ 1, 3 * hidden, hidden }, r);
+    graph.initializers["B"] = tensor ({ 1, 6 * hidden }, b);
+    graph.initializers["readout"] = tensor ({ hidden, 1 }, readout);
+
+    auto gru = node ("GRU", { "input", "W", "R", "B" }, { "y", "y_h" });
+    gru.attributes["hidden_size"].i = hidden;
+    gru.attributes["linear_before_reset"].i = linearBeforeReset ? 1 : 0;
+    graph.nodes.push_back (gru);
+    graph.nodes.push_back (node ("Squeeze", { "y_h" }, { "h" }));
+    graph.nodes.push_back (node ("MatMul", { "h", "readout" }, { "output" }));
+
+    juce::String error;
+    auto model = NativeModel::fromGraph (graph, error);
+    INFO (error);
+    REQUIRE (model != nullptr);
+
+    // ONNX GRU, gates z, r, h.
+    std::vector<float> h (hidden, 0.0f);
+
+    requireMatches (*model, [&] (float x)
+    {
+        const auto gate = [&] (int g, int o, const std::vector<float>& state)
+        {
+            float sum = w[(size_t) (g * hidden + o)] * x + b[(size_t) (g * hidden + o)];
+            for (int i = 0; i < hidden; ++i)
+                sum += r[(size_t) ((g * hidden + o) * hidden + i)] * state[(size_t) i];
+
+            return sum + b[(size_t) (3 * hidden + g * hidden + o)];
+        };
+
+        std::vector<float> z (hidden), reset (hidden), next (hidden);
+        for (int o = 0; o < hidden; ++o)
+        {
+            z[(size_t) o]     = sigmoid (gate (0, o, h));
+            reset[(size_t) o] = sigmoid (gate (1, o, h));
+        }
+
+        for (int o = 0; o < hidden; ++o)
+        {
+            float n = w[(size_t) (2 * hidden + o)] * x + b[(size_t) (2 * hidden + o)];
+            float recurrent = b[(size_t) (5 * hidden + o)];
+
+            for (int i = 0; i < hidden; ++i)
+            {
+                const auto weight = r[(size_t) ((2 * hidden + o) * hidden + i)];
+                recurrent += weight * (linearBeforeReset ? h[(size_t) i] : reset[(size_t) i] * h[(size_t) i]);
+            }
+
+            n = std::tanh (n + (linearBeforeReset ? reset[(size_t) o] * recurrent : recurrent));
+            next[(size_t) o] = (1.0f - z[(size_t) o]) * n + z[(size_t) o] * h[(size_t) o];
+        }
+
+        h = next;
+
+        float y = 0.0f;
+        for (int i = 0; i < hidden; ++i)
+            y += readout[(size_t) i] * h[(size_t) i];
+
+        return y;
+    });
+
+    // reset() starts over from a zero state, like a fresh clone.
+    auto fresh = model->clone();
+    model->reset();
+
+    for (int i = 0; i < 8; ++i)
+        REQUIRE (model->processSample (0.3f) == fresh->processSample (0.3f));
+}
+
+TEST_CASE ("NativeModel: an LSTM matches a scalar reference", "[native]")
+{
+    constexpr int hidden = 2;
+
+    juce::Random random (3);
+    const auto w = randomValues (random, 4 * hidden);
+    const auto r = randomValues (random, 4 * hidden * hidden);
+    const auto b = randomValues (random, 8 * hidden);
+
+    auto graph = makeGraph();
+    graph.initializers["W"] = tensor ({ 1, 4 * hidden, 1 }, w);
+    graph.initializers["R"] = tensor ({ 1, 4 * hidden, hidden }, r);
+    graph.initializers["B"] = tensor ({ 1, 8 * hidden }, b);
+    graph.initializers["readout"] = tensor ({ 1, hidden }, { 1.0f, -1.0f });
+
+    auto lstm = node ("LSTM", { "input", "W", "R", "B" }, { "y", "y_h", "y_c" });
+    lstm.attributes["hidden_size"].i = hidden;
+    graph.nodes.push_back (lstm);
+
+    auto readout = node ("Gemm", { "y", "readout" }, { "output" });
+    readout.attributes["transB"].i = 1;
+    graph.nodes.push_back (readout);
+
+    juce::String error;
+    auto model = NativeModel::fromGraph (graph, error);
+    INFO (error);
+    REQUIRE (model != nullptr);
+
+    // ONNX LSTM, gates i, o, f, c.
+    std::vector<float> h (hidden, 0.0f), c (hidden, 0.0f);
+
+    requireMatches (*model, [&] (float x)
+    {
+        const auto gate = [&] (int g, int o)
+        {
+            float sum = w[(size_t) (g * hidden + o)] * x
+                      + b[(size_t) (g * hidden + o)] + b[(size_t) (4 * hidden + g * hidden + o)];
+            for (int i = 0; i < hidden; ++i)
+                sum += r[(size_t) ((g * hidden + o) * hidden + i)] * h[(size_t) i];
+
+            return sum;
+        };
+
+        std::vector<float> next (hidden);
+        for (int o = 0; o < hidden; ++o)
+        {
+            const auto input  = sigmoid (gate (0, o));
+            const auto output = sigmoid (gate (1, o));
+            const auto forget = sigmoid (gate (2, o));
+            const auto cell   = std::tanh (gate (3, o));
+
+            c[(size_t) o] = forget * c[(size_t) o] + input * cell;
+            next[(size_t) o] = output * std::tanh (c[(size_t) o]);
+        }
+
+        h = next;
+        return h[0] - h[1];
+    });
+}
+
+TEST_CASE ("NativeModel: a dilated conv1d runs causally", "[native]")
+{
+    constexpr int channels = 2, kernelSize = 3, dilation = 2;
+
+    juce::Random random (4);
+    const auto w = randomValues (random, channels * kernelSize);
+    const auto bias = randomValues (random, channels);
+
+    auto graph = makeGraph();
+    graph.initializers["W"] = tensor ({ channels, 1, kernelSize }, w);
+    graph.initializers["B"] = tensor ({ channels }, bias);
+    graph.initializers["mix"] = tensor ({ channels, 1 }, { 0.5f, 0.25f });
+
+    auto conv = node ("Conv", { "input", "W", "B" }, { "features" });
+    conv.attributes["dilations"].ints = { dilation };
+    conv.attributes["pads"].ints = { (kernelSize - 1) * dilation, 0 };
+    graph.nodes.push_back (conv);
+    graph.nodes.push_back (node ("Relu", { "features" }, { "active" }));
+    graph.nodes.push_back (node ("MatMul", { "active", "mix" }, { "output" }));
+
+    juce::String error;
+    auto model = NativeModel::fromGraph (graph, error);
+    INFO (error);
+    REQUIRE (model != nullptr);
+
+    std::vector<float> past;
+
+    requireMatches (*model, [&] (float x)
+    {
+        past.push_back (x);
+        const auto t = (int) past.size() - 1;
+
+        float y = 0.0f;
+        for (int o = 0; o < channels; ++o)
+        {
+            float sum = bias[(size_t) o];
+            for (int k = 0; k < kernelSize; ++k)
+            {
+                const auto at = t - (kernelSize - 1 - k) * dilation;
+                sum += w[(size_t) (o * kernelSize + k)] * (at >= 0 ? past[(size_t) at] : 0.0f);
+            }
+
+            y += (o == 0 ? 0.5f : 0.25f) * juce::jmax (0.0f, sum);
+        }
+
+        return y;
+    });
+}
+
+TEST_CASE ("NativeModel: graphs it cannot run are rejected with a reason", "[native]")
+{
+    auto graph = makeGraph();
+    graph.nodes.push_back (node ("Softmax", { "input" }, { "output" }));
+
+    juce::String error;
+    REQUIRE (NativeModel::fromGraph (graph, error) == nullptr);
+    REQUIRE (error.contains ("Softmax"));
+
+    // A chain that never reaches the output.
+    auto dangling = makeGraph();
+    dangling.nodes.push_back (node ("Tanh", { "input" }, { "somewhere" }));
+
+    REQUIRE (NativeModel::fromGraph (dangling, error) == nullptr);
+    REQUIRE (error.isNotEmpty());
+
+    // A weight matrix shorter than its dims, which would be read past its end.
+    auto truncated = makeGraph();
+    truncated.initializers["W"] = tensor ({ 1, 4 }, { 1.0f, 2.0f });
+    truncated.nodes.push_back (node ("MatMul", { "input", "W" }, { "output" }));
+
+    REQUIRE (NativeModel::fromGraph (truncated, error) == nullptr);
+    REQUIRE (error.contains ("W"));
+
+    // A "same"-padded conv looks ahead, so it cannot run streaming.
+    for (const auto& [autoPad, pads] : { std::pair<std::string, std::vector<int64_t>> { "NOTSET", { 1, 1 } },
+                                         std::pair<std::string, std::vector<int64_t>> { "SAME_UPPER", {} } })
+    {
+        auto padded = makeGraph();
+        padded.initializers["W"] = tensor ({ 1, 1, 3 }, { 0.25f, 0.5f, 0.25f });
+
+        auto conv = node ("Conv", { "input", "W" }, { "output" });
+        conv.attributes["pads"].ints = pads;
+        conv.attributes["auto_pad"].s = autoPad;
+        padded.nodes.push_back (conv);
+
+        REQUIRE (NativeModel::fromGraph (padded, error) == nullptr);
+        REQUIRE (error.contains ("padded"));
+    }
+}
+
+// ── ONNX files and the engine ────────────────────────────────────────────────
+
+TEST_CASE ("NativeModel: loads the bundled softclip model from its ONNX file", "[native]")
+{
+    const juce::File modelFile (MOJO_TEST_MODEL_DIR "/softclip.onnx");
+    REQUIRE (modelFile.existsAsFile());
+
+    juce::String error;
+    auto model = NativeModel::fromFile (modelFile, error);
+    INFO (error);
+    REQUIRE (model != nullptr);
+
+    requireMatches (*model, [] (float x) { return std::tanh (2.0f * x); });
+}
+
+TEST_CASE ("InferenceEngine: the native backend runs in place with no latency", "[inference][native]")
+{
+    InferenceEngine engine;
+    engine.setBackend (InferenceEngine::Backend::native);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx")));
+
+    engine.prepare (2, 64);
+    REQUIRE (engine.runsInline());
+    REQUIRE (engine.getLatencySamples() == 0);
+    REQUIRE (engine.getPrimingSamples() == 0);
+
+    juce::AudioBuffer<float> buffer (2, 64);
+    for (int i = 0; i < 64; ++i)
+    {
+        buffer.setSample (0, i, 0.01f * (float) i);
+        buffer.setSample (1, i, -0.01f * (float) i);
+    }
+
+    engine.processInline (buffer.getArrayOfWritePointers(), 2, 64);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        REQUIRE (buffer.getSample (0, i) == Catch::Approx (std::tanh (0.02f * (float) i)).margin (1.0e-6));
+        REQUIRE (buffer.getSample (1, i) == Catch::Approx (std::tanh (-0.02f * (float) i)).margin (1.0e-6));
+    }
+
+    REQUIRE (engine.getTelemetry().getSnapshot().runs == 1);
+
+    // Forcing ONNX Runtime goes back to the framed pipeline.
+    engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx")));
+    engine.prepare (2, 64);
+    REQUIRE_FALSE (engine.runsInline());
+    REQUIRE (engine.getLatencySamples() > 0);
+}
+
+TEST_CASE ("InferenceEngine: a backend change during playback waits for the next prepare or release", "[inference][native]")
+{
+    const bool releaseInstead = GENERATE (false, true);
+
+    InferenceEngine engine;
+    std::atomic<int> reprepares { 0 };
+    engine.onReprepareNeeded = [&reprepares] { ++reprepares; };
+
+    engine.setBackend (InferenceEngine::Backend::onnxRuntime);
+    REQUIRE (engine.loadModel (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx")));
+    engine.setBackend (InferenceEngine::Backend::automatic);
+
+    engine.prepare (1, 64);
+    REQUIRE_FALSE (engine.runsInline());
+
+    SpscFifo resultFifo (engine.getRequiredOutputFifoSize());
+    juce::AudioBuffer<float> resultStorage (1, engine.getRequiredOutputFifoSize());
+    engine.setOutputFifo (&resultFifo, &resultStorage);
+
+    // Running in place changes the latency, so playback keeps the pipeline
+    // until the owner re-prepares or stops.
+    engine.loadModelAsync (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx"));
+
+    for (int waited = 0; reprepares.load() == 0 && waited < 2000; ++waited)
+        juce::Thread::sleep (1);
+
+    REQUIRE (reprepares.load() == 1);
+    REQUIRE (engine.getLoadStatus().state == InferenceEngine::LoadState::ready);
+    REQUIRE_FALSE (engine.runsInline());
+
+    if (releaseInstead)
+        engine.release();
+    else
+        engine.prepare (1, 64);
+
+    REQUIRE (engine.runsInline());
+    REQUIRE (engine.getLatencySamples() == 0);
+}
+
+TEST_CASE ("InferenceEngine: loads a model embedded in memory", "[inference][native]")
+{
+    // Stands in for a BinaryData resource: the engine must not need a file.
+    juce::MemoryBlock embedded;
+    REQUIRE (juce::File (MOJO_TEST_MODEL_DIR "/softclip.onnx").loadFileAsData (embedded));
+
+    InferenceEngine engine;
+    REQUIRE (engine.loadModel (embedded.getData(), embedded.getSize(), "softclip"));
+    REQUIRE (engine.getLoadStatus().message == "Loaded softclip (native)");
+
+    engine.prepare (1, 32);
+    REQUIRE (engine.runsInline());
+
+    juce::AudioBuffer<float> buffer (1, 32);
+    for (int i = 0; i < 32; ++i)
+        buffer.setSample (0, i, 0.03f * (float) i);
+
+    engine.processInline (buffer.getArrayOfWritePointers(), 1, 32);
+
+    for (int i = 0; i < 32; ++i)
+        REQUIRE (buffer.getSample (0, i) == Catch::Approx (std::tanh (0.06f * (float) i)).margin (1.0e-6));
+
+    REQUIRE_FALSE (engine.loadModel (nullptr, 0, "nothing"));
+    REQUIRE (engine.getLoadStatus().state == InferenceEngine::LoadState::failed);
+}
+
+TEST_CASE ("InferenceEngine: a graph the native backend cannot run fails when native is forced", "[inference][native]")
+{
+    const auto file = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                          .getChildFile ("mojo-insects-not-a-model.onnx");
+    file.replaceWithText ("definitely not protobuf");
+
+    InferenceEngine engine;
+    engine.setBackend (InferenceEngine::Backend::native);
+
+    REQUIRE_FALSE (engine.loadModel (file));
+    REQUIRE (engine.getLoadStatus().state == InferenceEngine::LoadState::failed);
+    REQUIRE_FALSE (engine.runsInline());
+
+    file.deleteFile();
+}
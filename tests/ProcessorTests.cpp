@@ -3,6 +3,13 @@
 
 #include <juce_audio_basics/juce_audio_basics.h>
 
+#include "GainMix.h"
+#include "SessionTrace.h"
+#include "SpscFifo.h"
+#include "WorkerWakeup.h"
+
+#include <thread>
+
 // ── Helpers ──────────────────────────────────────────────────────────────────
 
 static juce::AudioBuffer<float> makeSineBuffer (int numChannels, int numSamples,
@@ -45,6 +52,82 @@ TEST_CASE ("Gain: applying -6 dB halves the amplitude", "[dsp][gain]")
     REQUIRE (after == Catch::Approx (before * gainLinear).epsilon (1e-4));
 }
 
+TEST_CASE ("GainMix: gain changes ramp instead of stepping", "[dsp][gain]")
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 64;
+    const int rampSamples = (int) (sampleRate * GainMix::kRampSeconds);
+
+    GainMix gainMix;
+    gainMix.prepare (sampleRate, 1, blockSize, 0, 1.0f, 1.0f, 1.0f);
+    gainMix.setTargets (1.0f, 1.0f, 0.25f);
+
+    juce::AudioBuffer<float> buffer (1, blockSize);
+    float previous = 1.0f, largestStep = 0.0f;
+
+    for (int done = 0; done < rampSamples + blockSize; done += blockSize)
+    {
+        for (int i = 0; i < blockSize; ++i)
+            buffer.setSample (0, i, 1.0f);
+
+        gainMix.processInput (buffer.getArrayOfWritePointers(), 1, blockSize);
+        gainMix.processOutput (buffer.getArrayOfWritePointers(), 1, buffer, 0, blockSize, 0, 0);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            largestStep = juce::jmax (largestStep, previous - buffer.getSample (0, i));
+            previous = buffer.getSample (0, i);
+        }
+    }
+
+    // Roughly one linear ramp increment per sample (rounding makes the last
+    // one a little larger), never a jump.
+    REQUIRE (previous == Catch::Approx (0.25f));
+    REQUIRE (largestStep < 2.0f * 0.75f / (float) rampSamples);
+}
+
+TEST_CASE ("GainMix: the dry signal is delayed to meet the wet one", "[dsp][gain]")
+{
+    constexpr int blockSize = 32, latency = 45, ringSize = 128;
+
+    GainMix gainMix;
+    gainMix.prepare (48000.0, 1, blockSize, latency, 0.5f, 0.3f, 1.0f);
+
+    // The "engine" returns the (input-gained) signal `latency` samples late,
+    // through a ring that wraps, like the processor's result FIFO. Equal dry
+    // and wet at any mix must then give back the delayed signal unchanged.
+    std::vector<float> submitted;
+    juce::AudioBuffer<float> buffer (1, blockSize), ring (1, ringSize);
+    int ringPos = 0;
+
+    for (int block = 0; block < 20; ++block)
+    {
+        const int start = block * blockSize;
+
+        for (int i = 0; i < blockSize; ++i)
+            buffer.setSample (0, i, (float) (start + i));
+
+        gainMix.processInput (buffer.getArrayOfWritePointers(), 1, blockSize);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            submitted.push_back (buffer.getSample (0, i));
+            const int delayed = start + i - latency;
+            ring.setSample (0, (ringPos + i) % ringSize, delayed >= 0 ? submitted[(size_t) delayed] : 0.0f);
+        }
+
+        const int first = juce::jmin (blockSize, ringSize - ringPos);
+        gainMix.processOutput (buffer.getArrayOfWritePointers(), 1, ring, ringPos, first, 0, blockSize - first);
+        ringPos = (ringPos + blockSize) % ringSize;
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            const int delayed = start + i - latency;
+            REQUIRE (buffer.getSample (0, i) == Catch::Approx (delayed >= 0 ? 0.5f * (float) delayed : 0.0f));
+        }
+    }
+}
+
 // ── AbstractFifo / lock-free exchange ─────────────────────────────────────────
 
 TEST_CASE ("AbstractFifo: write then read returns same values", "[fifo]")
@@ -85,6 +168,205 @@ TEST_CASE ("AbstractFifo: write then read returns same values", "[fifo]")
     REQUIRE (fifo.getNumReady() == 0);
 }
 
+TEST_CASE ("SpscFifo: regions wrap around and capacity is size - 1", "[fifo]")
+{
+    SpscFifo fifo (8);
+    REQUIRE (fifo.getFreeSpace() == 7);
+
+    {
+        const auto scope = fifo.write (5);
+        REQUIRE (scope.blockSize1 == 5);
+    }
+
+    REQUIRE (fifo.getNumReady() == 5);
+    { const auto scope = fifo.read (5); }
+
+    // Positions now start at 5: the next write splits across the end.
+    const auto scope = fifo.prepareToWrite (6);
+    REQUIRE (scope.startIndex1 == 5);
+    REQUIRE (scope.blockSize1  == 3);
+    REQUIRE (scope.startIndex2 == 0);
+    REQUIRE (scope.blockSize2  == 3);
+    fifo.finishedWrite (6);
+
+    // Only one more slot free, and a write is clamped to it.
+    REQUIRE (fifo.getFreeSpace() == 1);
+    const auto clamped = fifo.prepareToWrite (4);
+    REQUIRE (clamped.blockSize1 + clamped.blockSize2 == 1);
+}
+
+TEST_CASE ("SpscFifo: a producer and a consumer thread pass every value in order", "[fifo][rt-safety]")
+{
+    constexpr int kSize = 64, kTotal = 200000;
+
+    SpscFifo fifo (kSize);
+    std::array<int, kSize> storage {};
+
+    std::thread producer ([&]
+    {
+        for (int next = 0; next < kTotal;)
+        {
+            const auto scope = fifo.write (juce::jmin (7, kTotal - next));
+
+            for (int i = 0; i < scope.blockSize1; ++i) storage[(size_t) (scope.startIndex1 + i)] = next++;
+            for (int i = 0; i < scope.blockSize2; ++i) storage[(size_t) (scope.startIndex2 + i)] = next++;
+
+            if (scope.blockSize1 == 0)
+                std::this_thread::yield();   // full: let the consumer run on small machines
+        }
+    });
+
+    int expected = 0;
+    bool inOrder = true;
+
+    while (expected < kTotal)
+    {
+        const auto scope = fifo.read (5);
+
+        for (int i = 0; i < scope.blockSize1; ++i) inOrder &= storage[(size_t) (scope.startIndex1 + i)] == expected++;
+        for (int i = 0; i < scope.blockSize2; ++i) inOrder &= storage[(size_t) (scope.startIndex2 + i)] == expected++;
+
+        if (scope.blockSize1 == 0)
+            std::this_thread::yield();
+    }
+
+    producer.join();
+
+    REQUIRE (inOrder);
+    REQUIRE (fifo.getNumReady() == 0);
+}
+
+TEST_CASE ("WorkerWakeup: notify is seen by a waiting worker, and wait times out without one", "[rt-safety]")
+{
+    WorkerWakeup wakeup;
+
+    REQUIRE_FALSE (wakeup.wait (5));
+
+    std::thread audio ([&wakeup]
+    {
+        juce::Thread::sleep (20);   // long enough for the worker to park
+        wakeup.notify();
+    });
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    REQUIRE (wakeup.wait (2000));
+    const auto waited = juce::Time::getMillisecondCounterHiRes() - start;
+    audio.join();
+
+    // Woken from the park by the notify itself, not by the timeout.
+    REQUIRE (waited < 20 + 50);
+
+    // The notification was consumed.
+    REQUIRE_FALSE (wakeup.wait (5));
+}
+
+TEST_CASE ("WorkerWakeup: no notify is lost between the worker's last check and its park", "[rt-safety]")
+{
+    WorkerWakeup toWorker, toAudio;
+    constexpr int kRounds = 2000;
+    std::atomic<int> missed { 0 };
+
+    // Ping-pong, so every notify lands somewhere in the other side's
+    // spin-check-park sequence; a lost one shows up as a timed-out wait.
+    std::thread worker ([&]
+    {
+        for (int i = 0; i < kRounds; ++i)
+        {
+            if (! toWorker.wait (2000))
+                ++missed;
+
+            toAudio.notify();
+        }
+    });
+
+    for (int i = 0; i < kRounds; ++i)
+    {
+        toWorker.notify();
+
+        if (! toAudio.wait (2000))
+            ++missed;
+
+        // Now and then, let the worker get all the way into its park.
+        if (i % 100 == 0)
+            juce::Thread::sleep (1);
+    }
+
+    worker.join();
+    REQUIRE (missed == 0);
+}
+
+// ── Session traces ────────────────────────────────────────────────────────────
+
+TEST_CASE ("SessionTrace: events and captured audio read back as they were recorded", "[trace]")
+{
+    constexpr int blockSize = 64;
+    const juce::TemporaryFile file (".trace");
+
+    SessionTrace::Event prepared;
+    prepared.type        = SessionTrace::EventType::prepare;
+    prepared.numChannels = 2;
+    prepared.numSamples  = blockSize;
+    prepared.sampleRate  = 48000.0;
+
+    SessionTrace trace;
+    REQUIRE (trace.start (file.getFile(), true, 2, 1024, prepared));
+
+    auto input = makeSineBuffer (2, blockSize, 440.0f, 48000.0f);
+    input.applyGain (1, 0, blockSize, 0.5f);   // tell the channels apart
+
+    for (int block = 0; block < 4; ++block)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        const int kept = trace.captureInput (input.getArrayOfReadPointers(), 2, blockSize);
+        REQUIRE (kept == blockSize);
+
+        trace.recordBlock (start, blockSize, 2, 10 * block, 128, block == 2 ? SessionTrace::wentDry : 0, kept);
+    }
+
+    trace.recordRun (100, 250, 3, 1, 7, 9);
+    trace.stop();
+
+    // Nothing is recorded once stopped.
+    trace.recordRun (0, 1, 1, 0, 0, 0);
+
+    SessionTrace::Contents contents;
+    juce::String error;
+    REQUIRE (SessionTrace::read (file.getFile(), contents, error));
+    REQUIRE (contents.complete);
+    REQUIRE (contents.withAudio);
+    REQUIRE (contents.droppedEvents == 0);
+    REQUIRE (contents.droppedAudioBlocks == 0);
+
+    REQUIRE (contents.timeline.size() == 5);
+    REQUIRE (contents.timeline[0].type == SessionTrace::EventType::prepare);
+    REQUIRE (contents.timeline[0].sampleRate == 48000.0);
+    REQUIRE (contents.timeline[0].numSamples == blockSize);
+
+    for (int block = 0; block < 4; ++block)
+    {
+        const auto& event = contents.timeline[(size_t) block + 1];
+        REQUIRE (event.type == SessionTrace::EventType::block);
+        REQUIRE (event.numSamples == blockSize);
+        REQUIRE (event.inputLevel == 10 * block);
+        REQUIRE (event.outputLevel == 128);
+        REQUIRE (event.endTicks >= event.startTicks);
+        REQUIRE (((event.flags & SessionTrace::wentDry) != 0) == (block == 2));
+
+        REQUIRE (event.numChannels == 2);
+        REQUIRE (event.audioSamples == blockSize);
+
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                REQUIRE (contents.audio[event.audioOffset + (size_t) (ch * blockSize + i)] == input.getSample (ch, i));
+    }
+
+    REQUIRE (contents.runs.size() == 1);
+    REQUIRE (contents.runs[0].startTicks == 100);
+    REQUIRE (contents.runs[0].endTicks == 250);
+    REQUIRE (contents.runs[0].numSamples == 3);
+    REQUIRE (contents.runs[0].flags == 1);
+}
+
 // ── Denormals ─────────────────────────────────────────────────────────────────
 
 TEST_CASE ("ScopedNoDenormals: compiles and constructs without error", "[rt-safety]")
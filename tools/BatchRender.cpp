@@ -0,0 +1,307 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <iostream>
+
+// Renders every audio file in a folder through the plugin's processing chain
+// (input gain → InferenceEngine → output gain) without a host.
+//
+// Files are spread across a pool of workers. Each worker owns its own
+// MojoInsectsAudioProcessor and renders in offline mode: inference runs
+// synchronously in large batched chunks on a multi-threaded session, exactly
+// like a DAW bounce. The workers share one ONNX Runtime environment and one
+// session per model through SessionCache, so the weights are loaded once and
+// each worker keeps only its own I/O bindings.
+//
+//   MojoInsectsBatchRender --model <file.onnx>[,<file.onnx>...] --input <dir> --output <dir>
+//                          [--jobs N] [--chunk samples]
+//                          [--input-gain dB] [--output-gain dB]
+//
+// A comma-separated list of models renders through them in series, as a
+// pipelined chain (InferenceEngine::loadModelChain()).
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::Array<juce::File> models;   // more than one: a chain, in order
+        juce::File outputDir;
+        int   chunkSize    = 8192;
+        float inputGainDb  = 0.0f;
+        float outputGainDb = 0.0f;
+    };
+
+    struct FileResult
+    {
+        bool         ok           = false;
+        double       audioSeconds = 0.0;
+        double       wallSeconds  = 0.0;
+        juce::String error;
+    };
+
+    void setParameter (MojoInsectsAudioProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* param = processor.apvts.getParameter (id))
+            param->setValueNotifyingHost (param->convertTo0to1 (value));
+    }
+
+    /** Streams one file through the processor in fixed chunks, trimming the
+        reported latency from the head and flushing it out at the tail so the
+        result lines up sample-for-sample with the source. */
+    FileResult renderFile (MojoInsectsAudioProcessor& processor,
+                           juce::AudioFormatManager& formats,
+                           const juce::File& source,
+                           const RenderSettings& settings)
+    {
+        FileResult result;
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (source));
+        if (reader == nullptr)
+        {
+            result.error = "unreadable audio file";
+            return result;
+        }
+
+        // The plugin runs mono or stereo; of anything wider, only the first
+        // two channels are rendered and the rest are dropped.
+        const int    numChannels = reader->numChannels == 1 ? 1 : 2;
+        const double sampleRate  = reader->sampleRate;
+        const auto   length      = reader->lengthInSamples;
+        const int    chunkSize   = settings.chunkSize;
+
+        const auto destination = settings.outputDir.getChildFile (source.getFileNameWithoutExtension() + ".wav");
+        destination.deleteFile();
+
+        std::unique_ptr<juce::OutputStream> stream (destination.createOutputStream());
+        if (stream == nullptr)
+        {
+            result.error = "cannot write " + destination.getFullPathName();
+            return result;
+        }
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wav.createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels, 24, {}, 0));
+        if (writer == nullptr)
+        {
+            result.error = "cannot create WAV writer";
+            return result;
+        }
+        stream.release(); // now owned by the writer
+
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        processor.setPlayConfigDetails (numChannels, numChannels, sampleRate, chunkSize);
+        processor.prepareToPlay (sampleRate, chunkSize);
+
+        const auto latency = (juce::int64) processor.getLatencySamples();
+        juce::AudioBuffer<float> buffer (numChannels, chunkSize);
+        juce::MidiBuffer midi;
+
+        // Reads past the end of the file return silence, which flushes the tail.
+        for (juce::int64 position = 0; position < length + latency; position += chunkSize)
+        {
+            const int numSamples = (int) juce::jmin ((juce::int64) chunkSize, length + latency - position);
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+            reader->read (&buffer, 0, numSamples, position, true, numChannels > 1);
+            processor.processBlock (buffer, midi);
+
+            // Output sample (position + i) corresponds to input (position + i - latency).
+            const auto firstValid = juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position);
+            if (firstValid < numSamples)
+                writer->writeFromAudioSampleBuffer (buffer, (int) firstValid, numSamples - (int) firstValid);
+        }
+
+        processor.releaseResources();
+
+        result.ok           = true;
+        result.audioSeconds = (double) length / sampleRate;
+        result.wallSeconds  = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+        return result;
+    }
+
+    //==============================================================================
+    /** One pool worker: owns a processor (sharing the model's ORT session
+        with the other workers) and pulls files off the shared queue until it
+        is empty. */
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker (int index,
+                      const RenderSettings& s,
+                      const juce::Array<juce::File>& f,
+                      std::atomic<int>& next,
+                      std::vector<FileResult>& r,
+                      juce::CriticalSection& lock)
+            : juce::Thread ("RenderWorker " + juce::String (index)),
+              settings (s), files (f), nextFile (next), results (r), consoleLock (lock)
+        {
+            formats.registerBasicFormats();
+
+            setParameter (processor, "inputGain",  settings.inputGainDb);
+            setParameter (processor, "outputGain", settings.outputGainDb);
+            processor.setNonRealtime (true);
+        }
+
+        void run() override
+        {
+            if (! processor.loadModelChain (settings.models))
+            {
+                loadError = processor.getModelLoadStatus().message;
+
+                const juce::ScopedLock sl (consoleLock);
+                std::cerr << "Failed to load model: " << loadError << std::endl;
+                return;
+            }
+
+            for (int i = nextFile++; i < files.size() && ! threadShouldExit(); i = nextFile++)
+            {
+                const auto& file = files.getReference (i);
+                auto& result = results[(size_t) i] = renderFile (processor, formats, file, settings);
+
+                const juce::ScopedLock sl (consoleLock);
+                if (result.ok)
+                    std::cout << file.getFileName()
+                              << "  " << juce::String (result.audioSeconds, 2) << " s audio"
+                              << "  " << juce::String (result.wallSeconds, 2)  << " s wall"
+                              << "  " << juce::String (result.audioSeconds / juce::jmax (result.wallSeconds, 1.0e-9), 1)
+                              << "x realtime" << std::endl;
+                else
+                    std::cerr << file.getFileName() << "  FAILED: " << result.error << std::endl;
+            }
+        }
+
+        /** Why the models failed to load, or empty if they loaded. Read it
+            once the thread has exited. */
+        const juce::String& getLoadError() const noexcept { return loadError; }
+
+    private:
+        const RenderSettings&          settings;
+        const juce::Array<juce::File>& files;
+        std::atomic<int>&              nextFile;
+        std::vector<FileResult>&       results;
+        juce::CriticalSection&         consoleLock;
+
+        juce::AudioFormatManager  formats;
+        MojoInsectsAudioProcessor processor;
+        juce::String              loadError;
+    };
+
+    int printUsage()
+    {
+        std::cerr << "Usage: MojoInsectsBatchRender --model <file.onnx>[,<file.onnx>...] --input <dir> --output <dir>\n"
+                     "                              [--jobs N] [--chunk samples]\n"
+                     "                              [--input-gain dB] [--output-gain dB]" << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS starts a timer, which needs a MessageManager to exist.
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--model") || ! args.containsOption ("--input")
+        || ! args.containsOption ("--output"))
+        return printUsage();
+
+    RenderSettings settings;
+    settings.outputDir  = args.getFileForOption ("--output");
+    const auto inputDir = args.getFileForOption ("--input");
+
+    for (const auto& path : juce::StringArray::fromTokens (args.getValueForOption ("--model"), ",", {}))
+        settings.models.add (juce::File::getCurrentWorkingDirectory().getChildFile (path.trim().unquoted()));
+
+    for (const auto& model : settings.models)
+        if (! model.existsAsFile())
+            return printUsage();
+
+    if (settings.models.isEmpty() || ! inputDir.isDirectory())
+        return printUsage();
+
+    if (args.containsOption ("--chunk"))
+        settings.chunkSize = juce::jmax (64, args.getValueForOption ("--chunk").getIntValue());
+    if (args.containsOption ("--input-gain"))
+        settings.inputGainDb = args.getValueForOption ("--input-gain").getFloatValue();
+    if (args.containsOption ("--output-gain"))
+        settings.outputGainDb = args.getValueForOption ("--output-gain").getFloatValue();
+
+    // The shared offline session already spreads each Run across cores, so
+    // default to a few workers rather than one per core.
+    int numJobs = juce::jmax (1, juce::SystemStats::getNumPhysicalCpus() / 2);
+    if (args.containsOption ("--jobs"))
+        numJobs = juce::jmax (1, args.getValueForOption ("--jobs").getIntValue());
+
+    if (! settings.outputDir.createDirectory())
+    {
+        std::cerr << "Cannot create " << settings.outputDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto files = inputDir.findChildFiles (juce::File::findFiles, false, "*.wav;*.aif;*.aiff;*.flac");
+    if (files.isEmpty())
+    {
+        std::cerr << "No audio files in " << inputDir.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    numJobs = juce::jmin (numJobs, files.size());
+
+    std::vector<FileResult> results ((size_t) files.size());
+    std::atomic<int> nextFile { 0 };
+    juce::CriticalSection consoleLock;
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+    for (int i = 0; i < numJobs; ++i)
+        workers.push_back (std::make_unique<RenderWorker> (i, settings, files, nextFile, results, consoleLock));
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit (-1);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+    // Files left over because every worker failed to load the models.
+    juce::String loadError;
+    for (const auto& worker : workers)
+        if (worker->getLoadError().isNotEmpty())
+            loadError = worker->getLoadError();
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        auto& result = results[(size_t) i];
+
+        if (! result.ok && result.error.isEmpty())
+        {
+            result.error = "not rendered, the models failed to load: " + loadError;
+            std::cerr << files.getReference (i).getFileName() << "  FAILED: " << result.error << std::endl;
+        }
+    }
+
+    double audioSeconds = 0.0, busySeconds = 0.0;
+    int failures = 0;
+
+    for (const auto& result : results)
+    {
+        audioSeconds += result.audioSeconds;
+        busySeconds  += result.wallSeconds;
+        failures     += result.ok ? 0 : 1;
+    }
+
+    std::cout << "\n" << (files.size() - failures) << "/" << files.size() << " files, "
+              << juce::String (audioSeconds, 1) << " s audio in " << juce::String (wallSeconds, 1)
+              << " s on " << numJobs << " workers\n"
+              << "aggregate: " << juce::String (audioSeconds / juce::jmax (wallSeconds, 1.0e-9), 1)
+              << "x realtime, per worker: "
+              << juce::String (audioSeconds / juce::jmax (busySeconds, 1.0e-9), 1) << "x realtime" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
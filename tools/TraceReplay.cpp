@@ -0,0 +1,314 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "SessionTrace.h"
+
+#include <iostream>
+
+// Replays a session trace (see SessionTrace) through this build of the
+// plugin, with the block sizes, sample-rate changes and pacing the recorded
+// host used, and compares the timing against the recording.
+//
+// Each block is submitted at its original offset from the start of the
+// trace (scaled by --speed), carrying the captured input when the trace has
+// audio and noise otherwise. The replay is itself traced, so both sides are
+// measured the same way: processBlock time, dry-fallback blocks, and the
+// duration of every inference Run. The slowest replayed Runs are listed
+// next to the slowest original Run around the same point in the session,
+// which shows where the tail latency of one build regressed against
+// another, or against the customer's machine.
+//
+//   MojoInsectsTraceReplay --trace <session.trace> [--model <file.onnx>]
+//                          [--speed factor] [--worst N]
+//                          [--capture <replay.trace>] [--json report.json]
+//
+// --capture keeps the replay's own trace, to be replayed or compared again.
+
+namespace
+{
+    int printUsage()
+    {
+        std::cerr << "Usage: MojoInsectsTraceReplay --trace <session.trace> [--model <file.onnx>]\n"
+                     "                              [--speed factor] [--worst N]\n"
+                     "                              [--capture <replay.trace>] [--json report.json]" << std::endl;
+        return 1;
+    }
+
+    /** Timing figures of one trace. */
+    struct Summary
+    {
+        int blocks = 0, dryBlocks = 0, runs = 0, reducedHops = 0, bypassedHops = 0;
+        std::vector<double> blockMicros, runMicros;   // sorted
+        juce::int64 droppedEvents = 0;
+    };
+
+    double percentile (const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        return sorted[(size_t) juce::jlimit (0.0, (double) sorted.size() - 1.0,
+                                             std::ceil (p * (double) sorted.size()) - 1.0)];
+    }
+
+    Summary summarise (const SessionTrace::Contents& trace)
+    {
+        using Quality = DeadlineScheduler::Quality;
+        Summary s;
+
+        for (const auto& event : trace.timeline)
+        {
+            if (event.type != SessionTrace::EventType::block)
+                continue;
+
+            ++s.blocks;
+            s.dryBlocks += (event.flags & SessionTrace::wentDry) != 0 ? 1 : 0;
+            s.blockMicros.push_back (trace.toSeconds (event.endTicks - event.startTicks) * 1.0e6);
+        }
+
+        for (const auto& run : trace.runs)
+        {
+            ++s.runs;
+            s.reducedHops  += run.flags == (uint8_t) Quality::reduced  ? 1 : 0;
+            s.bypassedHops += run.flags == (uint8_t) Quality::bypassed ? 1 : 0;
+            s.runMicros.push_back (trace.toSeconds (run.endTicks - run.startTicks) * 1.0e6);
+        }
+
+        std::sort (s.blockMicros.begin(), s.blockMicros.end());
+        std::sort (s.runMicros.begin(), s.runMicros.end());
+        s.droppedEvents = trace.droppedEvents;
+        return s;
+    }
+
+    void print (const juce::String& name, const Summary& s)
+    {
+        std::cout << name.paddedRight (' ', 10)
+                  << juce::String (s.blocks).paddedLeft (' ', 8) << " blocks  "
+                  << juce::String (s.dryBlocks).paddedLeft (' ', 5) << " dry   "
+                  << "processBlock p50 " << juce::String (percentile (s.blockMicros, 0.5), 1)
+                  << " p99 " << juce::String (percentile (s.blockMicros, 0.99), 1)
+                  << " max " << juce::String (s.blockMicros.empty() ? 0.0 : s.blockMicros.back(), 1) << " us   "
+                  << juce::String (s.runs) << " Runs p50 " << juce::String (percentile (s.runMicros, 0.5), 1)
+                  << " p99 " << juce::String (percentile (s.runMicros, 0.99), 1)
+                  << " p99.9 " << juce::String (percentile (s.runMicros, 0.999), 1)
+                  << " max " << juce::String (s.runMicros.empty() ? 0.0 : s.runMicros.back(), 1) << " us   "
+                  << s.reducedHops << " reduced, " << s.bypassedHops << " bypassed";
+
+        if (s.droppedEvents > 0)
+            std::cout << "   (" << s.droppedEvents << " events lost while capturing)";
+
+        std::cout << std::endl;
+    }
+
+    juce::var toJson (const Summary& s)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty ("blocks",         s.blocks);
+        object->setProperty ("dryBlocks",      s.dryBlocks);
+        object->setProperty ("blockP50Us",     percentile (s.blockMicros, 0.5));
+        object->setProperty ("blockP99Us",     percentile (s.blockMicros, 0.99));
+        object->setProperty ("blockMaxUs",     s.blockMicros.empty() ? 0.0 : s.blockMicros.back());
+        object->setProperty ("runs",           s.runs);
+        object->setProperty ("runP50Us",       percentile (s.runMicros, 0.5));
+        object->setProperty ("runP99Us",       percentile (s.runMicros, 0.99));
+        object->setProperty ("runP999Us",      percentile (s.runMicros, 0.999));
+        object->setProperty ("runMaxUs",       s.runMicros.empty() ? 0.0 : s.runMicros.back());
+        object->setProperty ("reducedHops",    s.reducedHops);
+        object->setProperty ("bypassedHops",   s.bypassedHops);
+        object->setProperty ("droppedEvents",  s.droppedEvents);
+        return juce::var (object);
+    }
+
+    /** Seconds into the session: from the trace's first event, and for the
+        replay scaled back to the original's clock. */
+    struct SessionClock
+    {
+        const SessionTrace::Contents& trace;
+        juce::int64 origin;
+        double speed;
+
+        double operator() (juce::int64 ticks) const noexcept { return trace.toSeconds (ticks - origin) * speed; }
+    };
+
+    /** Feeds every prepare and block event of original through processor at
+        the original pacing. */
+    void replay (MojoInsectsAudioProcessor& processor, const SessionTrace::Contents& original, double speed)
+    {
+        const auto origin = original.timeline.front().startTicks;
+        const auto replayStart = juce::Time::getHighResolutionTicks();
+
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        juce::Random random (5);
+        int numChannels = 0;
+
+        for (const auto& event : original.timeline)
+        {
+            const auto due = replayStart + juce::Time::secondsToHighResolutionTicks (
+                                               original.toSeconds (event.startTicks - origin) / speed);
+
+            while (juce::Time::getHighResolutionTicks() < due)
+            {
+                if (juce::Time::highResolutionTicksToSeconds (due - juce::Time::getHighResolutionTicks()) > 0.002)
+                    juce::Thread::sleep (1);
+                else
+                    juce::Thread::yield();
+            }
+
+            if (event.type == SessionTrace::EventType::prepare)
+            {
+                numChannels = juce::jlimit (1, 2, event.numChannels);
+                processor.setNonRealtime ((event.flags & SessionTrace::offline) != 0);
+                processor.setPlayConfigDetails (numChannels, numChannels, event.sampleRate, event.numSamples);
+                processor.prepareToPlay (event.sampleRate, event.numSamples);
+                buffer.setSize (numChannels, event.numSamples);
+                continue;
+            }
+
+            if (numChannels == 0)
+                continue;   // traced before the first prepare
+
+            // Hosts may hand over more than they promised; the buffer grows
+            // here, outside processBlock, rather than dropping the block.
+            buffer.setSize (numChannels, event.numSamples, false, false, true);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* const samples = buffer.getWritePointer (ch);
+
+                if (ch < event.numChannels && event.audioSamples == event.numSamples)
+                    std::copy_n (original.audio.data() + event.audioOffset + (size_t) (ch * event.audioSamples),
+                                 event.numSamples, samples);
+                else
+                    for (int i = 0; i < event.numSamples; ++i)
+                        samples[i] = random.nextFloat() * 0.5f - 0.25f;
+            }
+
+            processor.processBlock (buffer, midi);
+        }
+
+        processor.releaseResources();
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // APVTS starts a timer, which needs a MessageManager to exist.
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--trace"))
+        return printUsage();
+
+    juce::String error;
+    SessionTrace::Contents original;
+
+    if (! SessionTrace::read (args.getFileForOption ("--trace"), original, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const auto firstPrepare = std::find_if (original.timeline.begin(), original.timeline.end(),
+                                            [] (const auto& e) { return e.type == SessionTrace::EventType::prepare; });
+    if (firstPrepare == original.timeline.end())
+    {
+        std::cerr << "The trace never saw prepareToPlay, so there is nothing to replay" << std::endl;
+        return 1;
+    }
+
+    const double speed = args.containsOption ("--speed")
+                             ? juce::jmax (0.01, args.getValueForOption ("--speed").getDoubleValue()) : 1.0;
+    const int worst = args.containsOption ("--worst") ? juce::jmax (0, args.getValueForOption ("--worst").getIntValue()) : 10;
+
+    MojoInsectsAudioProcessor processor;
+
+    if (args.containsOption ("--model") && ! processor.loadModel (args.getFileForOption ("--model")))
+    {
+        std::cerr << "Failed to load model: " << processor.getModelLoadStatus().message << std::endl;
+        return 1;
+    }
+
+    const juce::TemporaryFile temporaryCapture (".trace");
+    const auto captureFile = args.containsOption ("--capture") ? args.getFileForOption ("--capture")
+                                                               : temporaryCapture.getFile();
+
+    if (! processor.startTrace (captureFile, false))
+    {
+        std::cerr << "Cannot write " << captureFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Replaying " << original.timeline.size() << " events ("
+              << juce::String (original.toSeconds (original.timeline.back().endTicks - original.timeline.front().startTicks), 1)
+              << " s" << (original.withAudio ? ", with audio" : ", noise for audio")
+              << ") at " << speed << "x" << std::endl;
+
+    replay (processor, original, speed);
+    processor.stopTrace();
+
+    SessionTrace::Contents replayed;
+    if (! SessionTrace::read (captureFile, replayed, error) || replayed.timeline.empty())
+    {
+        std::cerr << "Cannot read the replay's trace back: " << error << std::endl;
+        return 1;
+    }
+
+    const auto originalSummary = summarise (original);
+    const auto replaySummary   = summarise (replayed);
+
+    std::cout << std::endl;
+    print ("original", originalSummary);
+    print ("replay",   replaySummary);
+
+    // Where the replay's tail is: its slowest Runs, each against the slowest
+    // original Run within 10 ms of the same point in the session.
+    const SessionClock originalClock { original, original.timeline.front().startTicks, 1.0 };
+    const SessionClock replayClock   { replayed, replayed.timeline.front().startTicks, speed };
+
+    auto slowest = replayed.runs;
+    std::sort (slowest.begin(), slowest.end(), [] (const auto& a, const auto& b)
+               { return a.endTicks - a.startTicks > b.endTicks - b.startTicks; });
+    slowest.resize (juce::jmin (slowest.size(), (size_t) worst));
+
+    if (! slowest.empty())
+        std::cout << "\nSlowest replayed Runs:\n    at (s)   replay (us)   original nearby (us)" << std::endl;
+
+    juce::Array<juce::var> worstRows;
+
+    for (const auto& run : slowest)
+    {
+        const double at = replayClock (run.startTicks);
+        double nearby = 0.0;
+
+        for (const auto& candidate : original.runs)
+            if (std::abs (originalClock (candidate.startTicks) - at) <= 0.01)
+                nearby = juce::jmax (nearby, original.toSeconds (candidate.endTicks - candidate.startTicks) * 1.0e6);
+
+        const double micros = replayed.toSeconds (run.endTicks - run.startTicks) * 1.0e6;
+        std::cout << juce::String (at, 3).paddedLeft (' ', 10) << juce::String (micros, 1).paddedLeft (' ', 14)
+                  << juce::String (nearby, 1).paddedLeft (' ', 23) << std::endl;
+
+        auto* row = new juce::DynamicObject();
+        row->setProperty ("seconds",          at);
+        row->setProperty ("replayUs",         micros);
+        row->setProperty ("originalNearbyUs", nearby);
+        worstRows.add (juce::var (row));
+    }
+
+    if (args.containsOption ("--json"))
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("trace",     args.getFileForOption ("--trace").getFileName());
+        root->setProperty ("timestamp", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("cpu",       juce::SystemStats::getCpuModel());
+        root->setProperty ("speed",     speed);
+        root->setProperty ("original",  toJson (originalSummary));
+        root->setProperty ("replay",    toJson (replaySummary));
+        root->setProperty ("slowestRuns", worstRows);
+        args.getFileForOption ("--json").replaceWithText (juce::JSON::toString (juce::var (root)));
+    }
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <JuceHeader.h>
+#include "ModelVariants.h"
+
+#include <iostream>
+
+// Checks the quantized variants of a model against the float original before
+// they ship: renders reference audio through the float model and each
+// variant found next to it (amp.fp16.onnx, amp.int8.onnx), and reports the
+// per-Run speedup and the error against the float output. A variant outside
+// the tolerance is refused, and the exit code says so, so this can gate a
+// model export in CI.
+//
+//   MojoInsectsVerifyVariants --model <file.onnx> [--audio <file>]
+//                             [--min-snr dB] [--max-abs x] [--json report.json]
+//
+// Without --audio a built-in sweep/noise signal is used. Exit code 0 when
+// every variant found is accepted, 2 when any is refused.
+
+namespace
+{
+    int printUsage()
+    {
+        std::cerr << "Usage: MojoInsectsVerifyVariants --model <file.onnx> [--audio <file>]\n"
+                     "                                 [--min-snr dB] [--max-abs x] [--json report.json]" << std::endl;
+        return 1;
+    }
+
+    /** The whole file, folded to at most two channels like the plugin does. */
+    bool readAudio (const juce::File& file, juce::AudioBuffer<float>& buffer)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+        if (reader == nullptr || reader->lengthInSamples <= 0)
+            return false;
+
+        const int numChannels = reader->numChannels == 1 ? 1 : 2;
+        buffer.setSize (numChannels, (int) reader->lengthInSamples);
+        return reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, numChannels > 1);
+    }
+
+    juce::String formatSnr (double snrDb)
+    {
+        return std::isinf (snrDb) ? juce::String (snrDb > 0.0 ? "identical" : "-inf dB")
+                                  : juce::String (snrDb, 1) + " dB";
+    }
+
+    juce::var toJson (const ModelVariants::Report& report)
+    {
+        auto* row = new juce::DynamicObject();
+        row->setProperty ("precision",    ModelVariants::getName (report.precision));
+        row->setProperty ("found",        report.found);
+        row->setProperty ("accepted",     report.accepted);
+        row->setProperty ("floatRunUs",   report.floatRunMicros);
+        row->setProperty ("variantRunUs", report.variantRunMicros);
+        row->setProperty ("speedup",      report.speedup);
+        row->setProperty ("snrDb",        std::isinf (report.error.snrDb) ? juce::var() : juce::var (report.error.snrDb));
+        row->setProperty ("maxAbsError",  report.error.maxAbs);
+        row->setProperty ("reason",       report.reason);
+        return juce::var (row);
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const juce::ArgumentList args (argc, argv);
+
+    if (! args.containsOption ("--model"))
+        return printUsage();
+
+    const auto model = args.getFileForOption ("--model");
+    if (! model.existsAsFile())
+        return printUsage();
+
+    ModelVariants::Tolerance tolerance;
+    if (args.containsOption ("--min-snr"))
+        tolerance.minSnrDb = args.getValueForOption ("--min-snr").getDoubleValue();
+    if (args.containsOption ("--max-abs"))
+        tolerance.maxAbsError = args.getValueForOption ("--max-abs").getDoubleValue();
+
+    juce::AudioBuffer<float> reference;
+
+    if (args.containsOption ("--audio"))
+    {
+        if (! readAudio (args.getFileForOption ("--audio"), reference))
+        {
+            std::cerr << "Cannot read " << args.getValueForOption ("--audio") << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        reference = ModelVariants::makeReferenceSignal (2, 48000.0, 4.0);
+    }
+
+    juce::Array<juce::var> rows;
+    bool anyRefused = false, anyFound = false;
+
+    for (auto precision : { ModelVariants::Precision::fp16, ModelVariants::Precision::int8 })
+    {
+        const auto report = ModelVariants::verify (model, precision, reference, tolerance);
+        const auto name = ModelVariants::getName (precision).paddedRight (' ', 6);
+
+        rows.add (toJson (report));
+
+        if (! report.found)
+        {
+            std::cout << name << "  not found" << std::endl;
+            continue;
+        }
+
+        anyFound = true;
+        anyRefused = anyRefused || ! report.accepted;
+
+        std::cout << name
+                  << "  run " << juce::String (report.variantRunMicros, 1) << " us"
+                  << " vs " << juce::String (report.floatRunMicros, 1) << " us"
+                  << "  speedup " << juce::String (report.speedup, 2) << "x"
+                  << "  SNR " << formatSnr (report.error.snrDb)
+                  << "  max error " << juce::String (report.error.maxAbs, 6)
+                  << "  " << (report.accepted ? "ACCEPTED" : "REFUSED: " + report.reason) << std::endl;
+    }
+
+    if (! anyFound)
+        std::cerr << "No fp16 or int8 variant next to " << model.getFullPathName() << std::endl;
+
+    if (args.containsOption ("--json"))
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("model",       model.getFullPathName());
+        root->setProperty ("minSnrDb",    tolerance.minSnrDb);
+        root->setProperty ("maxAbsError", tolerance.maxAbsError);
+        root->setProperty ("cpu",         juce::SystemStats::getCpuModel());
+        root->setProperty ("variants",    rows);
+        args.getFileForOption ("--json").replaceWithText (juce::JSON::toString (juce::var (root)));
+    }
+
+    return anyRefused ? 2 : 0;
+}